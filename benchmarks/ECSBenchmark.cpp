@@ -0,0 +1,239 @@
+#include "../src/ecs/ECS.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Headless ECS benchmarks, results are written as JSON to the standard output or to the file given as argument
+
+#define BENCHMARK_REPETITIONS 7
+
+struct BenchPosition {
+	float x;
+	float y;
+	float z;
+};
+
+struct BenchVelocity {
+	float x;
+	float y;
+	float z;
+};
+
+struct BenchHealth {
+	int32_t value;
+};
+
+struct BenchSystem : public System {
+};
+
+struct BenchmarkResult {
+	std::string name;
+	std::string storage;
+	uint32_t entities;
+	uint64_t operations;
+	double medianNanoseconds;
+	double minNanoseconds;
+};
+
+// Keeps the compiler from removing the benchmarked reads
+volatile float sink;
+
+std::unique_ptr<ECS> createECS(ComponentStorage storage, std::shared_ptr<BenchSystem>* system) {
+	std::unique_ptr<ECS> ecs = std::make_unique<ECS>();
+	ecs->init(storage);
+	ecs->registerComponent<BenchPosition>();
+	ecs->registerComponent<BenchVelocity>();
+	ecs->registerComponent<BenchHealth>();
+
+	*system = ecs->registerSystem<BenchSystem>();
+	ComponentMask systemMask;
+	systemMask.set(ecs->getComponentId<BenchPosition>());
+	systemMask.set(ecs->getComponentId<BenchVelocity>());
+	ecs->setSystemComponents<BenchSystem>(systemMask);
+
+	return ecs;
+}
+
+std::vector<Entity> populate(ECS* ecs, uint32_t count) {
+	std::vector<Entity> entities = ecs->createEntities(count);
+	for (uint32_t i = 0; i < count; i++) {
+		ecs->addComponent(entities[i], BenchPosition{ static_cast<float>(i), 0.0f, 0.0f });
+		ecs->addComponent(entities[i], BenchVelocity{ 1.0f, 0.0f, 0.0f });
+	}
+
+	return entities;
+}
+
+// setup prepares a fresh state outside of the measure, run returns the number of operations done
+BenchmarkResult measure(const std::string& name, ComponentStorage storage, uint32_t count, const std::function<void()>& setup, const std::function<uint64_t()>& run) {
+	std::vector<double> nanosecondsPerOperation;
+	uint64_t operations = 0;
+	for (uint32_t repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		setup();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		operations = run();
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		nanosecondsPerOperation.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(std::max<uint64_t>(operations, 1)));
+	}
+	std::sort(nanosecondsPerOperation.begin(), nanosecondsPerOperation.end());
+
+	BenchmarkResult result;
+	result.name = name;
+	result.storage = (storage == ComponentStorage::ARCHETYPES) ? "archetypes" : "arrays";
+	result.entities = count;
+	result.operations = operations;
+	result.medianNanoseconds = nanosecondsPerOperation[nanosecondsPerOperation.size() / 2];
+	result.minNanoseconds = nanosecondsPerOperation.front();
+
+	std::cerr << result.name << " (" << result.storage << ", " << count << "): " << result.medianNanoseconds << " ns/op" << std::endl;
+
+	return result;
+}
+
+void runBenchmarks(ComponentStorage storage, uint32_t count, std::vector<BenchmarkResult>& results) {
+	std::unique_ptr<ECS> ecs;
+	std::shared_ptr<BenchSystem> system;
+	std::vector<Entity> entities;
+	std::mt19937 rng(count);
+
+	auto freshECS = [&]() {
+		ecs = createECS(storage, &system);
+		entities.clear();
+	};
+	auto populatedECS = [&]() {
+		ecs = createECS(storage, &system);
+		entities = populate(ecs.get(), count);
+	};
+
+	// Entities
+	results.push_back(measure("create_entities", storage, count, freshECS, [&]() {
+		for (uint32_t i = 0; i < count; i++) {
+			entities.push_back(ecs->createEntity());
+		}
+
+		return static_cast<uint64_t>(count);
+	}));
+
+	results.push_back(measure("create_destroy_churn", storage, count, populatedECS, [&]() {
+		for (uint32_t i = 0; i < count; i++) {
+			ecs->destroyEntity(entities[i]);
+			entities[i] = ecs->createEntity();
+			ecs->addComponent(entities[i], BenchPosition{ 0.0f, 0.0f, 0.0f });
+		}
+
+		return static_cast<uint64_t>(count);
+	}));
+
+	// Components
+	results.push_back(measure("add_component", storage, count, [&]() {
+		freshECS();
+		entities = ecs->createEntities(count);
+	}, [&]() {
+		for (Entity entity : entities) {
+			ecs->addComponent(entity, BenchPosition{ 0.0f, 0.0f, 0.0f });
+		}
+
+		return static_cast<uint64_t>(count);
+	}));
+
+	results.push_back(measure("add_remove_component", storage, count, populatedECS, [&]() {
+		for (Entity entity : entities) {
+			ecs->addComponent(entity, BenchHealth{ 100 });
+		}
+		for (Entity entity : entities) {
+			ecs->removeComponent<BenchHealth>(entity);
+		}
+
+		return static_cast<uint64_t>(count) * 2;
+	}));
+
+	results.push_back(measure("get_component_sequential", storage, count, populatedECS, [&]() {
+		float sum = 0.0f;
+		for (Entity entity : entities) {
+			sum += ecs->readComponent<BenchPosition>(entity).x;
+		}
+		sink = sum;
+
+		return static_cast<uint64_t>(count);
+	}));
+
+	std::vector<Entity> shuffledEntities;
+	results.push_back(measure("get_component_random", storage, count, [&]() {
+		populatedECS();
+		shuffledEntities = entities;
+		std::shuffle(shuffledEntities.begin(), shuffledEntities.end(), rng);
+	}, [&]() {
+		float sum = 0.0f;
+		for (Entity entity : shuffledEntities) {
+			sum += ecs->readComponent<BenchPosition>(entity).x;
+		}
+		sink = sum;
+
+		return static_cast<uint64_t>(count);
+	}));
+
+	// Systems
+	results.push_back(measure("system_iteration", storage, count, populatedECS, [&]() {
+		for (Entity entity : system->entities) {
+			BenchPosition& position = ecs->getComponent<BenchPosition>(entity);
+			const BenchVelocity& velocity = ecs->readComponent<BenchVelocity>(entity);
+			position.x += velocity.x;
+		}
+
+		return static_cast<uint64_t>(system->entities.size());
+	}));
+
+	results.push_back(measure("view_iteration", storage, count, [&]() {
+		populatedECS();
+		ecs->view<BenchPosition, const BenchVelocity>();
+	}, [&]() {
+		View<BenchPosition, const BenchVelocity>& positions = ecs->view<BenchPosition, const BenchVelocity>();
+		positions.each([](Entity, BenchPosition& position, const BenchVelocity& velocity) {
+			position.x += velocity.x;
+		});
+
+		return static_cast<uint64_t>(positions.size());
+	}));
+}
+
+std::string toJSON(const std::vector<BenchmarkResult>& results) {
+	std::ostringstream json;
+	json << "{\n\t\"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& result = results[i];
+		json << "\t\t{ \"name\": \"" << result.name << "\", \"storage\": \"" << result.storage << "\", \"entities\": " << result.entities << ", \"operations\": " << result.operations << ", \"median_ns_per_op\": " << result.medianNanoseconds << ", \"min_ns_per_op\": " << result.minNanoseconds << " }";
+		json << ((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+	json << "\t]\n}\n";
+
+	return json.str();
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<BenchmarkResult> results;
+	for (ComponentStorage storage : { ComponentStorage::ARRAYS, ComponentStorage::ARCHETYPES }) {
+		for (uint32_t count : { 1000, 10000, 100000 }) {
+			runBenchmarks(storage, count, results);
+		}
+	}
+
+	std::string json = toJSON(results);
+	if (argc > 1) {
+		std::ofstream file(argv[1]);
+		file << json;
+	}
+	else {
+		std::cout << json;
+	}
+
+	return 0;
+}
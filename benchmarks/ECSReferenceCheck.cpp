@@ -0,0 +1,74 @@
+#include "../src/ecs/ECS.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// References to components must stay valid while other entities get the same component, exits with 1 when one moved
+
+#define REFERENCE_CHECK_ENTITIES 5000
+
+struct CheckPosition {
+	float x;
+	float y;
+	float z;
+};
+
+struct CheckName {
+	std::string name;
+};
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+	if (!condition) {
+		std::cerr << "Component reference invalidated: " << message << std::endl;
+		failed = true;
+	}
+}
+
+void checkStorage(ComponentStorage storage, const std::string& storageName) {
+	std::unique_ptr<ECS> ecs = std::make_unique<ECS>();
+	ecs->init(storage);
+	ecs->registerComponent<CheckPosition>();
+	ecs->registerComponent<CheckName>();
+
+	Entity first = ecs->createEntity();
+	ecs->addComponent(first, CheckPosition{ 1.0f, 2.0f, 3.0f });
+	ecs->addComponent(first, CheckName{ "first" });
+	const CheckPosition& position = ecs->readComponent<CheckPosition>(first);
+	const CheckName& name = ecs->readComponent<CheckName>(first);
+
+	// One by one, like the entity command buffers
+	for (uint32_t i = 0; i < REFERENCE_CHECK_ENTITIES; i++) {
+		Entity entity = ecs->createEntity();
+		ecs->addComponent(entity, CheckPosition{ static_cast<float>(i), 0.0f, 0.0f });
+		ecs->addComponent(entity, CheckName{ "entity " + std::to_string(i) });
+	}
+	check(&position == &ecs->readComponent<CheckPosition>(first) && &name == &ecs->readComponent<CheckName>(first), storageName + ", added components");
+
+	// In bulk, like the scene loader
+	ComponentMask mask;
+	mask.set(ecs->getComponentId<CheckPosition>());
+	mask.set(ecs->getComponentId<CheckName>());
+	std::vector<Entity> entities = ecs->createEntities(REFERENCE_CHECK_ENTITIES);
+	ecs->initializeComponents(entities, mask);
+	for (Entity entity : entities) {
+		ecs->emplaceComponent(entity, CheckPosition{ 0.0f, 0.0f, 0.0f });
+		ecs->emplaceComponent(entity, CheckName{ "emplaced" });
+	}
+	check(&position == &ecs->readComponent<CheckPosition>(first) && &name == &ecs->readComponent<CheckName>(first), storageName + ", emplaced components");
+	check(position.x == 1.0f && position.y == 2.0f && position.z == 3.0f && name.name == "first", storageName + ", values changed");
+}
+
+int main() {
+	checkStorage(ComponentStorage::ARRAYS, "arrays");
+	checkStorage(ComponentStorage::ARCHETYPES, "archetypes");
+
+	if (failed) {
+		return 1;
+	}
+
+	std::cout << "Component references stayed valid." << std::endl;
+	return 0;
+}
\ No newline at end of file
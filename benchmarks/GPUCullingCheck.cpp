@@ -0,0 +1,277 @@
+#include "../src/ecs/ECS.h"
+#include "../src/ecs/components/Camera.h"
+#include "../src/graphics/commands/CommandBuffer.h"
+#include "../src/graphics/commands/CommandPool.h"
+#include "../src/graphics/culling/GPUCulling.h"
+#include "../src/graphics/resources/RendererResources.h"
+#include "../src/utils/resources/BufferTools.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Culls a synthetic scene on the GPU without window nor surface, then reads the indirect and visible instances buffers back
+// They must match the frustum tests done on the CPU, exits with 1 on a mismatch, runs from the build directory like the engine
+
+#define CULLING_CHECK_INSTANCES 500
+#define CULLING_CHECK_BATCHES 4
+#define CULLING_CHECK_VIEWS 4
+
+ECS ecs;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+	if (!condition) {
+		std::cerr << "GPU culling mismatch: " << message << std::endl;
+		failed = true;
+	}
+}
+
+// First device with a queue family doing both graphics and compute, software implementations included
+bool initDevice() {
+	VkApplicationInfo applicationInfo = {};
+	applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	applicationInfo.pNext = nullptr;
+	applicationInfo.pApplicationName = "GPU culling check";
+	applicationInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+	applicationInfo.pEngineName = "NeigeEngine";
+	applicationInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+	applicationInfo.apiVersion = VK_API_VERSION_1_0;
+
+	VkInstanceCreateInfo instanceCreateInfo = {};
+	instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceCreateInfo.pNext = nullptr;
+	instanceCreateInfo.flags = 0;
+	instanceCreateInfo.pApplicationInfo = &applicationInfo;
+	instanceCreateInfo.enabledLayerCount = 0;
+	instanceCreateInfo.ppEnabledLayerNames = nullptr;
+	instanceCreateInfo.enabledExtensionCount = 0;
+	instanceCreateInfo.ppEnabledExtensionNames = nullptr;
+	if (vkCreateInstance(&instanceCreateInfo, nullptr, &instance.instance) != VK_SUCCESS) {
+		return false;
+	}
+
+	uint32_t physicalDeviceCount;
+	vkEnumeratePhysicalDevices(instance.instance, &physicalDeviceCount, nullptr);
+	std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+	vkEnumeratePhysicalDevices(instance.instance, &physicalDeviceCount, physicalDevices.data());
+	for (VkPhysicalDevice device : physicalDevices) {
+		uint32_t queueFamilyCount;
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyProperties.data());
+		for (uint32_t queueIndex = 0; queueIndex < queueFamilyCount; queueIndex++) {
+			VkQueueFlags queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+			if (queueFamilyProperties[queueIndex].queueCount > 0 && (queueFamilyProperties[queueIndex].queueFlags & queueFlags) == queueFlags) {
+				physicalDevice.device = device;
+				vkGetPhysicalDeviceProperties(device, &physicalDevice.properties);
+				vkGetPhysicalDeviceFeatures(device, &physicalDevice.features);
+				vkGetPhysicalDeviceMemoryProperties(device, &physicalDevice.memoryProperties);
+				physicalDevice.queueFamilyIndices.graphicsFamily = queueIndex;
+				physicalDevice.queueFamilyIndices.computeFamily = queueIndex;
+				physicalDevice.queueFamilyIndices.presentFamily = queueIndex;
+				std::cout << "Device : " << physicalDevice.properties.deviceName << std::endl;
+
+				logicalDevice.init();
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Same rules as the CPU culling of the renderer
+bool visibleInView(const CullingInstance& instance, const CullingView& view, const Frustum& frustum) {
+	if (!view.culled) {
+		return false;
+	}
+	if ((view.casters == CullingCasters::DYNAMIC && !instance.dynamicCaster) || (view.casters == CullingCasters::STATIC && instance.dynamicCaster)) {
+		return false;
+	}
+	if (instance.alwaysVisible) {
+		return true;
+	}
+	if ((view.minCasterSize > 0.0f) && (glm::length(glm::vec3(instance.extent) * 2.0f) < view.minCasterSize)) {
+		return false;
+	}
+
+	return frustum.intersect(glm::vec3(instance.center), glm::vec3(instance.extent)) != FrustumIntersection::OUTSIDE;
+}
+
+// Boxes too close to a plane could end on either side with a different rounding
+bool nearPlane(const glm::vec4& center, const glm::vec4& extent, const std::vector<Frustum>& frustums) {
+	for (const Frustum& frustum : frustums) {
+		for (size_t p = 0; p < 6; p++) {
+			float distance = frustum.a[p] * center.x + frustum.b[p] * center.y + frustum.c[p] * center.z + frustum.d[p];
+			float radius = std::fabs(frustum.a[p]) * extent.x + std::fabs(frustum.b[p]) * extent.y + std::fabs(frustum.c[p]) * extent.z;
+			if (std::fabs(distance + radius) < 1e-3f) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+int main() {
+	if (!initDevice()) {
+		std::cerr << "No Vulkan device with a graphics and compute queue." << std::endl;
+		return 1;
+	}
+
+	// Camera, shadow map, shadow map cache, then a view that is not culled
+	std::vector<Frustum> frustums(CULLING_CHECK_VIEWS);
+	frustums[0].init(Camera::createPerspectiveProjection(60.0f, 16.0f / 9.0f, 0.1f, 60.0f, false) * Camera::createLookAtView(glm::vec3(0.0f, 2.0f, 10.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	frustums[1].init(Camera::createOrthoProjection(-15.0f, 15.0f, -15.0f, 15.0f, 0.1f, 80.0f) * Camera::createLookAtView(glm::vec3(20.0f, 30.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	frustums[1].removeNearPlane();
+	frustums[2] = frustums[1];
+	frustums[3] = frustums[0];
+
+	std::vector<CullingView> views(CULLING_CHECK_VIEWS);
+	GPUCulling::writeView(&views[0], frustums[0], true, 0.0f, CullingCasters::ALL);
+	GPUCulling::writeView(&views[1], frustums[1], true, 1.5f, CullingCasters::DYNAMIC);
+	GPUCulling::writeView(&views[2], frustums[2], true, 1.5f, CullingCasters::STATIC);
+	GPUCulling::writeView(&views[3], frustums[3], false, 0.0f, CullingCasters::ALL);
+
+	// Instances spread over the batches in order, the last batch is skinned
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> size(0.1f, 2.0f);
+	std::vector<uint32_t> batchFirstInstances(CULLING_CHECK_BATCHES + 1);
+	for (uint32_t i = 0; i <= CULLING_CHECK_BATCHES; i++) {
+		batchFirstInstances[i] = (i * CULLING_CHECK_INSTANCES) / CULLING_CHECK_BATCHES;
+	}
+	std::vector<CullingInstance> instances(CULLING_CHECK_INSTANCES);
+	for (uint32_t i = 0; i < CULLING_CHECK_INSTANCES; i++) {
+		CullingInstance& cullingInstance = instances[i];
+		do {
+			cullingInstance.center = glm::vec4(position(generator), position(generator) * 0.25f, position(generator), 0.0f);
+			cullingInstance.extent = glm::vec4(size(generator), size(generator), size(generator), 0.0f);
+		} while (nearPlane(cullingInstance.center, cullingInstance.extent, frustums));
+		cullingInstance.batch = static_cast<uint32_t>(std::upper_bound(batchFirstInstances.begin(), batchFirstInstances.end(), i) - batchFirstInstances.begin()) - 1;
+		cullingInstance.batchFirstInstance = batchFirstInstances[cullingInstance.batch];
+		cullingInstance.alwaysVisible = (cullingInstance.batch == CULLING_CHECK_BATCHES - 1) ? 1 : 0;
+		cullingInstance.dynamicCaster = (cullingInstance.alwaysVisible || (i % 3) == 0) ? 1 : 0;
+	}
+
+	// One draw command per primitive, the batch b has b + 1 primitives
+	std::vector<CullingDrawCommand> drawCommands;
+	for (uint32_t b = 0; b < CULLING_CHECK_BATCHES; b++) {
+		for (uint32_t p = 0; p <= b; p++) {
+			CullingDrawCommand drawCommand = {};
+			drawCommand.drawCommand.indexCount = 36 * (p + 1);
+			drawCommand.drawCommand.instanceCount = batchFirstInstances[b + 1] - batchFirstInstances[b];
+			drawCommand.drawCommand.firstIndex = 100 * b + 10 * p;
+			drawCommand.drawCommand.vertexOffset = static_cast<int32_t>(50 * b);
+			drawCommand.drawCommand.firstInstance = batchFirstInstances[b];
+			drawCommand.batch = b;
+			drawCommands.push_back(drawCommand);
+		}
+	}
+	uint32_t drawCommandCount = static_cast<uint32_t>(drawCommands.size());
+
+	// Resources of the first frame in flight
+	std::vector<Buffer> visibleInstanceBuffers(MAX_FRAMES_IN_FLIGHT);
+	for (Buffer& buffer : visibleInstanceBuffers) {
+		BufferTools::createStorageBuffer(buffer.buffer, buffer.deviceMemory, sizeof(uint32_t) * static_cast<VkDeviceSize>(CULLING_CHECK_INSTANCES) * CULLING_CHECK_VIEWS);
+		buffer.map(0, VK_WHOLE_SIZE, &buffer.mappedMemory);
+	}
+
+	GPUCulling gpuCulling;
+	gpuCulling.init();
+	gpuCulling.createResources(CULLING_CHECK_INSTANCES, CULLING_CHECK_VIEWS, CULLING_CHECK_BATCHES, drawCommandCount, visibleInstanceBuffers);
+	memcpy(gpuCulling.instanceBuffers[0].mappedMemory, instances.data(), sizeof(CullingInstance) * instances.size());
+	memcpy(gpuCulling.viewBuffers[0].mappedMemory, views.data(), sizeof(CullingView) * views.size());
+	memcpy(gpuCulling.drawCommandBuffers[0].mappedMemory, drawCommands.data(), sizeof(CullingDrawCommand) * drawCommands.size());
+
+	// Indirect commands are copied from device local memory after the culling
+	VkDeviceSize indirectSize = sizeof(VkDrawIndexedIndirectCommand) * static_cast<VkDeviceSize>(drawCommandCount) * CULLING_CHECK_VIEWS;
+	Buffer readbackBuffer;
+	BufferTools::createReadbackBuffer(readbackBuffer.buffer, readbackBuffer.deviceMemory, indirectSize);
+
+	CommandPool commandPool;
+	commandPool.init();
+	CommandBuffer commandBuffer;
+	commandBuffer.init(&commandPool);
+	commandBuffer.begin();
+	gpuCulling.dispatch(&commandBuffer, 0, CULLING_CHECK_INSTANCES, CULLING_CHECK_VIEWS, CULLING_CHECK_BATCHES, drawCommandCount, visibleInstanceBuffers[0].buffer);
+
+	VkMemoryBarrier cullingBarrier = {};
+	cullingBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	cullingBarrier.pNext = nullptr;
+	cullingBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	cullingBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &cullingBarrier, 0, nullptr, 0, nullptr);
+
+	VkBufferCopy bufferCopy = {};
+	bufferCopy.srcOffset = 0;
+	bufferCopy.dstOffset = 0;
+	bufferCopy.size = indirectSize;
+	vkCmdCopyBuffer(commandBuffer.commandBuffer, gpuCulling.indirectBuffers[0].buffer, readbackBuffer.buffer, 1, &bufferCopy);
+
+	VkMemoryBarrier readbackBarrier = {};
+	readbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	readbackBarrier.pNext = nullptr;
+	readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0, nullptr);
+	commandBuffer.endAndSubmit();
+
+	readbackBuffer.map(0, VK_WHOLE_SIZE, &readbackBuffer.mappedMemory);
+	const VkDrawIndexedIndirectCommand* indirectCommands = static_cast<const VkDrawIndexedIndirectCommand*>(readbackBuffer.mappedMemory);
+	const uint32_t* visibleInstances = static_cast<const uint32_t*>(visibleInstanceBuffers[0].mappedMemory);
+
+	size_t visibleCount = 0;
+	for (uint32_t view = 0; view < CULLING_CHECK_VIEWS; view++) {
+		for (uint32_t b = 0; b < CULLING_CHECK_BATCHES; b++) {
+			std::vector<uint32_t> expected;
+			for (uint32_t i = batchFirstInstances[b]; i < batchFirstInstances[b + 1]; i++) {
+				if (visibleInView(instances[i], views[view], frustums[view])) {
+					expected.push_back(i);
+				}
+			}
+			visibleCount += expected.size();
+
+			// The order of the visible instances depends on the GPU
+			std::string batchName = "view " + std::to_string(view) + ", batch " + std::to_string(b);
+			uint32_t viewFirstInstance = (view * CULLING_CHECK_INSTANCES) + batchFirstInstances[b];
+			for (uint32_t c = 0; c < drawCommandCount; c++) {
+				if (drawCommands[c].batch != b) {
+					continue;
+				}
+
+				const VkDrawIndexedIndirectCommand& indirectCommand = indirectCommands[(view * drawCommandCount) + c];
+				const VkDrawIndexedIndirectCommand& drawCommand = drawCommands[c].drawCommand;
+				check(indirectCommand.instanceCount == expected.size(), batchName + " draws " + std::to_string(indirectCommand.instanceCount) + " instances instead of " + std::to_string(expected.size()));
+				check(indirectCommand.firstInstance == viewFirstInstance, batchName + " starts at instance " + std::to_string(indirectCommand.firstInstance) + " instead of " + std::to_string(viewFirstInstance));
+				check(indirectCommand.indexCount == drawCommand.indexCount && indirectCommand.firstIndex == drawCommand.firstIndex && indirectCommand.vertexOffset == drawCommand.vertexOffset, batchName + " has different indices");
+			}
+
+			std::vector<uint32_t> visible(visibleInstances + viewFirstInstance, visibleInstances + viewFirstInstance + expected.size());
+			std::sort(visible.begin(), visible.end());
+			check(visible == expected, batchName + " has different visible instances");
+		}
+	}
+
+	readbackBuffer.destroy();
+	commandPool.destroy();
+	gpuCulling.destroy();
+	for (Buffer& buffer : visibleInstanceBuffers) {
+		buffer.destroy();
+	}
+	memoryAllocator.destroy();
+	logicalDevice.destroy();
+	vkDestroyInstance(instance.instance, nullptr);
+
+	if (failed) {
+		return 1;
+	}
+
+	std::cout << "GPU culling matches the CPU, " << visibleCount << " visible instances over " << CULLING_CHECK_VIEWS << " views." << std::endl;
+	return 0;
+}
\ No newline at end of file
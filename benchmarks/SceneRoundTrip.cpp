@@ -0,0 +1,140 @@
+#include "../src/ecs/ECS.h"
+#include "../src/ecs/components/Camera.h"
+#include "../src/ecs/components/Light.h"
+#include "../src/ecs/components/Renderable.h"
+#include "../src/ecs/components/Rigidbody.h"
+#include "../src/ecs/components/Transform.h"
+#include "../src/utils/resources/SceneLoader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Saves a scene then loads it back, the loaded components and parent links must match the saved ones
+// The scene is written to the file given as argument, exits with 1 on a mismatch
+
+#define SCENE_CHECK_ENTITIES 8
+
+ECS ecs;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+	if (!condition) {
+		std::cerr << "Scene round trip mismatch: " << message << std::endl;
+		failed = true;
+	}
+}
+
+// Every entity has a Transform whose x position is its index, the other components are spread over them
+std::vector<Entity> createScene() {
+	std::vector<Entity> entities = ecs.createEntities(SCENE_CHECK_ENTITIES);
+	for (uint32_t i = 0; i < SCENE_CHECK_ENTITIES; i++) {
+		Transform transform;
+		transform.position = glm::vec3(static_cast<float>(i), 0.5f * i, -0.25f * i);
+		transform.rotation = Transform::eulerToQuaternion(glm::vec3(10.0f * i, 20.0f, -5.0f * i));
+		transform.scale = glm::vec3(1.0f + i, 1.0f, 0.5f);
+		transform.parent = ((i % 3) != 0) ? entities[i - 1] : NO_ENTITY;
+		ecs.addComponent(entities[i], transform);
+	}
+
+	Camera camera;
+	camera.position = glm::vec3(0.0f, 2.0f, 5.0f);
+	camera.to = glm::vec3(0.0f, 0.0f, -1.0f);
+	camera.FOV = 45.0f;
+	camera.nearPlane = 0.1f;
+	camera.farPlane = 500.0f;
+	camera.envmapPath = "../modele/envmap/envmap.hdr";
+	ecs.addComponent(entities[1], camera);
+
+	ecs.addComponent(entities[2], Light{ LightType::SPOT, glm::vec3(1.0f, 4.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(10.0f, 8.0f, 6.0f), glm::vec2(12.5f, 17.5f) });
+	ecs.addComponent(entities[3], Light{ LightType::POINT, glm::vec3(-3.0f, 1.0f, 2.0f), glm::vec3(0.0f), glm::vec3(5.0f, 5.0f, 5.0f), glm::vec2(0.0f) });
+
+	for (uint32_t i = 4; i < 6; i++) {
+		Renderable renderable;
+		renderable.modelPath = "../modele/model" + std::to_string(i) + ".gltf";
+		renderable.vertexShaderPath = "../shaders/pbr.vert";
+		renderable.fragmentShaderPath = "../shaders/pbr.frag";
+		renderable.topology = (i == 4) ? Topology::TRIANGLE_LIST : Topology::WIREFRAME;
+		ecs.addComponent(entities[i], renderable);
+	}
+
+	ecs.addComponent(entities[5], Rigidbody{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), true });
+	ecs.addComponent(entities[6], Rigidbody{ glm::vec3(2.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), false });
+
+	return entities;
+}
+
+void compareEntities(Entity saved, Entity loaded, const std::vector<Entity>& savedEntities, const std::vector<Entity>& loadedEntities) {
+	std::string name = "entity " + std::to_string(static_cast<uint32_t>(ecs.readComponent<Transform>(saved).position.x));
+	check(ecs.getComponents(saved) == ecs.getComponents(loaded), name + " components");
+
+	const Transform& savedTransform = ecs.readComponent<Transform>(saved);
+	const Transform& loadedTransform = ecs.readComponent<Transform>(loaded);
+	check(savedTransform.position == loadedTransform.position && savedTransform.rotation == loadedTransform.rotation && savedTransform.scale == loadedTransform.scale, name + " transform");
+
+	// Parents link to the loaded entity of the saved parent
+	Entity expectedParent = NO_ENTITY;
+	for (size_t i = 0; i < savedEntities.size(); i++) {
+		if (savedEntities[i] == savedTransform.parent) {
+			expectedParent = loadedEntities[i];
+		}
+	}
+	check(loadedTransform.parent == expectedParent, name + " parent");
+
+	ComponentMask components = ecs.getComponents(saved);
+	if (components.test(ecs.getComponentId<Camera>())) {
+		const Camera& savedCamera = ecs.readComponent<Camera>(saved);
+		const Camera& loadedCamera = ecs.readComponent<Camera>(loaded);
+		check(savedCamera.position == loadedCamera.position && savedCamera.to == loadedCamera.to && savedCamera.FOV == loadedCamera.FOV && savedCamera.nearPlane == loadedCamera.nearPlane && savedCamera.farPlane == loadedCamera.farPlane && savedCamera.envmapPath == loadedCamera.envmapPath, name + " camera");
+	}
+	if (components.test(ecs.getComponentId<Light>())) {
+		const Light& savedLight = ecs.readComponent<Light>(saved);
+		const Light& loadedLight = ecs.readComponent<Light>(loaded);
+		check(savedLight.type == loadedLight.type && savedLight.position == loadedLight.position && savedLight.direction == loadedLight.direction && savedLight.color == loadedLight.color && savedLight.cutoffs == loadedLight.cutoffs, name + " light");
+	}
+	if (components.test(ecs.getComponentId<Renderable>())) {
+		const Renderable& savedRenderable = ecs.readComponent<Renderable>(saved);
+		const Renderable& loadedRenderable = ecs.readComponent<Renderable>(loaded);
+		check(savedRenderable.modelPath == loadedRenderable.modelPath && savedRenderable.vertexShaderPath == loadedRenderable.vertexShaderPath && savedRenderable.fragmentShaderPath == loadedRenderable.fragmentShaderPath && savedRenderable.tesselationControlShaderPath == loadedRenderable.tesselationControlShaderPath && savedRenderable.tesselationEvaluationShaderPath == loadedRenderable.tesselationEvaluationShaderPath && savedRenderable.geometryShaderPath == loadedRenderable.geometryShaderPath && savedRenderable.topology == loadedRenderable.topology, name + " renderable");
+	}
+	if (components.test(ecs.getComponentId<Rigidbody>())) {
+		const Rigidbody& savedRigidbody = ecs.readComponent<Rigidbody>(saved);
+		const Rigidbody& loadedRigidbody = ecs.readComponent<Rigidbody>(loaded);
+		check(savedRigidbody.velocity == loadedRigidbody.velocity && savedRigidbody.acceleration == loadedRigidbody.acceleration && savedRigidbody.affectedByGravity == loadedRigidbody.affectedByGravity, name + " rigidbody");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	std::string filePath = (argc > 1) ? argv[1] : "neige_scene_check.scene";
+
+	ecs.init(ComponentStorage::ARCHETYPES);
+	ecs.registerComponent<Transform>();
+	ecs.registerComponent<Camera>();
+	ecs.registerComponent<Renderable>();
+	ecs.registerComponent<Light>();
+	ecs.registerComponent<Rigidbody>();
+
+	std::vector<Entity> savedEntities = createScene();
+	SceneLoader::save(filePath);
+
+	// The saved entities stay alive, the loaded ones are matched to them by their x position
+	std::vector<Entity> loadedEntities = SceneLoader::load(filePath);
+	check(loadedEntities.size() == savedEntities.size(), "entity count " + std::to_string(loadedEntities.size()));
+	std::vector<Entity> orderedEntities(savedEntities.size(), NO_ENTITY);
+	for (Entity loaded : loadedEntities) {
+		uint32_t index = static_cast<uint32_t>(ecs.readComponent<Transform>(loaded).position.x);
+		if (index < orderedEntities.size()) {
+			orderedEntities[index] = loaded;
+		}
+	}
+	for (size_t i = 0; i < savedEntities.size(); i++) {
+		check(orderedEntities[i] != NO_ENTITY, "entity " + std::to_string(i) + " missing");
+		if (orderedEntities[i] != NO_ENTITY) {
+			compareEntities(savedEntities[i], orderedEntities[i], savedEntities, orderedEntities);
+		}
+	}
+
+	std::cerr << "Scene round trip " << (failed ? "failed" : "passed") << " (" << savedEntities.size() << " entities)." << std::endl;
+
+	return failed ? 1 : 0;
+}
\ No newline at end of file
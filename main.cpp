@@ -10,7 +10,7 @@
 ECS ecs;
 
 int main(void) {
-	ecs.init();
+	ecs.init(ComponentStorage::ARCHETYPES);
 
 	Game g;
 
@@ -65,7 +65,7 @@ int main(void) {
 		});
 	ecs.addComponent(skinningTest, Transform{
 		glm::vec3(3.0f, -1.0f, 0.0f),
-		glm::vec3(180.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(180.0f, 0.0f, 0.0f)),
 		glm::vec3(100.0f, 100.0f, 100.0f)
 		});
 
@@ -81,7 +81,7 @@ int main(void) {
 		});
 	ecs.addComponent(entity2, Transform{
 		glm::vec3(5.0f, 1.0f, 2.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(0.0f, 0.0f, 0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f)
 		});
 
@@ -97,7 +97,7 @@ int main(void) {
 		});
 	ecs.addComponent(entity8, Transform{
 		glm::vec3(3.0f, 1.0f, 2.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(0.0f, 0.0f, 0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f)
 		});
 
@@ -113,7 +113,7 @@ int main(void) {
 		});
 	ecs.addComponent(entity3, Transform{
 		glm::vec3(4.0f, 1.0f, -2.0f),
-		glm::vec3(90.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(90.0f, 0.0f, 0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f)
 		});
 
@@ -129,7 +129,7 @@ int main(void) {
 		});
 	ecs.addComponent(entity4, Transform{
 		glm::vec3(5.0f, 1.0f, -4.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(0.0f, 0.0f, 0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f)
 		});
 
@@ -145,7 +145,7 @@ int main(void) {
 		});
 	ecs.addComponent(entity5, Transform{
 		glm::vec3(0.0f, 0.0f, 0.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
+		Transform::eulerToQuaternion(glm::vec3(0.0f, 0.0f, 0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f)
 		});
 
@@ -1,28 +1,56 @@
 #version 450
 
-#define MAX_DIR_LIGHTS 10
-#define MAX_POINT_LIGHTS 10
-#define MAX_SPOT_LIGHTS 10
+#define MAX_SHADOW_MAPS 16
+#define SHADOW_CASCADE_COUNT 4
+
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+#define LIGHT_POINT 1.0
 
 #define MAX_REFLECTION_LOD 4.0
 
+struct Light {
+	vec4 position;
+	vec4 direction;
+	vec4 color;
+	vec4 cutoffs;
+};
+
+struct Cluster {
+	uint lightCount;
+	uint lightIndices[MAX_LIGHTS_PER_CLUSTER];
+};
+
 layout(set = 0, binding = 3) uniform Lighting {
-	vec3 numLights;
-	vec3 dirLightsDirection[MAX_DIR_LIGHTS];
-	vec3 dirLightsColor[MAX_DIR_LIGHTS];
-	vec3 pointLightsPosition[MAX_POINT_LIGHTS];
-	vec3 pointLightsColor[MAX_POINT_LIGHTS];
-	vec3 spotLightsPosition[MAX_SPOT_LIGHTS];
-	vec3 spotLightsDirection[MAX_SPOT_LIGHTS];
-	vec3 spotLightsColor[MAX_SPOT_LIGHTS];
-	vec2 spotLightsCutoffs[MAX_SPOT_LIGHTS];
+	mat4 view;
+	mat4 inverseProjection;
+	vec4 clusterDepth;
+	vec4 screenSize;
+	uvec4 lightCounts;
+} lighting;
+
+layout(set = 0, binding = 2) uniform Shadow {
+	mat4 lightSpaces[MAX_SHADOW_MAPS];
+	vec4 atlasRects[MAX_SHADOW_MAPS];
+	vec4 cascadeSplits;
+} shadow;
+
+layout(set = 0, binding = 10) readonly buffer Lights {
+	Light lights[];
 } lights;
 
+layout(set = 0, binding = 11) readonly buffer Clusters {
+	Cluster clusters[];
+} clusters;
+
 layout(set = 0, binding = 4) uniform samplerCube irradianceMap;
 layout(set = 0, binding = 5) uniform samplerCube prefilterMap;
 layout(set = 0, binding = 6) uniform sampler2D brdfLUT;
 
-layout(set = 0, binding = 7) uniform sampler2DShadow shadowMaps[MAX_DIR_LIGHTS + MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS];
+layout(set = 0, binding = 7) uniform sampler2DShadow shadowAtlas;
 
 layout(set = 1, binding = 0) uniform sampler2D colorMap;
 layout(set = 1, binding = 1) uniform sampler2D normalMap;
@@ -33,9 +61,7 @@ layout(location = 0) in vec2 uv;
 layout(location = 1) in vec3 cameraPos;
 layout(location = 2) in vec3 fragmentPos;
 layout(location = 3) in vec4 weights;
-layout(location = 4) in vec4 dirLightSpaces[MAX_DIR_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + 4) in vec4 spotLightSpaces[MAX_SPOT_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + MAX_SPOT_LIGHTS + 4) in mat3 TBN;
+layout(location = 4) in mat3 TBN;
 
 layout(location = 0) out vec4 outColor;
 
@@ -109,25 +135,75 @@ vec3 shade(vec3 n, vec3 v, vec3 l, vec3 lc, vec3 diffuse, float metallic, float
 	return ret;
 }
 
-float shadowValue(vec4 lightSpace, int shadowMapIndex) {
-	vec3 proj = lightSpace.xyz / lightSpace.w;
-	if (proj.z > 1.0) {
-		return 0.0;
-	}
-	proj = proj * 0.5 + 0.5;
+float filterShadow(int shadowMapIndex, vec3 proj) {
 	float curr = proj.z;
 	
-	float shadow = 0.0;
+	float visibility = 0.0;
 	
-	vec2 texelSize = 1.0 / textureSize(shadowMaps[shadowMapIndex], 0);
+	// Samples stay inside the tile of the shadow map
+	vec4 tile = shadow.atlasRects[shadowMapIndex];
+	vec2 texelSize = 1.0 / textureSize(shadowAtlas, 0);
+	vec2 tileMin = tile.xy + texelSize * 0.5;
+	vec2 tileMax = tile.xy + tile.zw - texelSize * 0.5;
+	vec2 atlasUv = tile.xy + proj.xy * tile.zw;
 	for (int x = -1; x <= 1; x++) {
 		for (int y = -1; y <= 1; y++) {
-			vec3 shadowUvs = vec3(vec2(proj.xy) + vec2(x, y) * texelSize, curr);
-			shadow += texture(shadowMaps[shadowMapIndex], shadowUvs).r;
+			vec3 shadowUvs = vec3(clamp(atlasUv + vec2(x, y) * texelSize, tileMin, tileMax), curr);
+			visibility += texture(shadowAtlas, shadowUvs).r;
 		}
 	}
 	
-	return shadow / 9.0;
+	return visibility / 9.0;
+}
+
+float shadowValue(int shadowMapIndex) {
+	if (shadowMapIndex < 0) {
+		return 1.0;
+	}
+
+	vec4 lightSpace = shadow.lightSpaces[shadowMapIndex] * vec4(fragmentPos, 1.0);
+	vec3 proj = lightSpace.xyz / lightSpace.w;
+	// Nothing is drawn past the far plane, which is at the range of the light
+	if (proj.z > 1.0) {
+		return 1.0;
+	}
+	proj = proj * 0.5 + 0.5;
+	if (any(lessThan(proj.xy, vec2(0.0))) || any(greaterThan(proj.xy, vec2(1.0)))) {
+		return 1.0;
+	}
+
+	return filterShadow(shadowMapIndex, proj);
+}
+
+float cascadedShadowValue(int shadowMapIndex) {
+	if (shadowMapIndex < 0) {
+		return 1.0;
+	}
+
+	// Cascade of the slice of the fragment, or a farther one when a cascade fitted on a previous frame does not hold it
+	float depth = -(lighting.view * vec4(fragmentPos, 1.0)).z;
+	for (int cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++) {
+		if (depth > shadow.cascadeSplits[cascade]) {
+			continue;
+		}
+
+		vec4 lightSpace = shadow.lightSpaces[shadowMapIndex + cascade] * vec4(fragmentPos, 1.0);
+		vec3 proj = (lightSpace.xyz / lightSpace.w) * 0.5 + 0.5;
+		if (all(greaterThanEqual(proj, vec3(0.0))) && all(lessThanEqual(proj, vec3(1.0)))) {
+			return filterShadow(shadowMapIndex + cascade, proj);
+		}
+	}
+
+	return 1.0;
+}
+
+uint clusterIndex() {
+	vec3 viewPos = vec3(lighting.view * vec4(fragmentPos, 1.0));
+	float slice = log(max(-viewPos.z, lighting.clusterDepth.x)) * lighting.clusterDepth.z - lighting.clusterDepth.w;
+	uint z = uint(clamp(slice, 0.0, float(CLUSTER_Z - 1)));
+	uvec2 tile = min(uvec2((gl_FragCoord.xy / lighting.screenSize.xy) * vec2(CLUSTER_X, CLUSTER_Y)), uvec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+
+	return tile.x + (CLUSTER_X * (tile.y + (CLUSTER_Y * z)));
 }
 
 void main() {
@@ -147,42 +223,46 @@ void main() {
 
 	vec3 tmpColor = vec3(0.0);
 	
-	int shadowMapIndex = 0;
-	
-	int numDirLights = int(lights.numLights.x);
-	int numPointLights = int(lights.numLights.y);
-	int numSpotLights = int(lights.numLights.z);
-	
-	float shadow = 0.0;
-	for (int i = 0; i < numDirLights; i++) {
-		l = normalize(-lights.dirLightsDirection[i]);
-		shadow = shadowValue(dirLightSpaces[i], shadowMapIndex);
-		tmpColor += shade(n, v, l, lights.dirLightsColor[i], d, metallicSample, roughnessSample) * shadow;
-		shadowMapIndex++;
+	int dirLightCount = int(lighting.lightCounts.x);
+	for (int i = 0; i < dirLightCount; i++) {
+		Light light = lights.lights[i];
+		l = normalize(-light.direction.xyz);
+		float shadow = cascadedShadowValue(int(light.color.w));
+		tmpColor += shade(n, v, l, light.color.xyz, d, metallicSample, roughnessSample) * shadow;
 	}
 
-	for (int i = 0; i < numPointLights; i++) {
-		l = normalize(lights.pointLightsPosition[i] - fragmentPos);
-		float distance = length(lights.pointLightsPosition[i] - fragmentPos);
-		float attenuation = 1.0 / (distance * distance);
-		vec3 radiance = lights.pointLightsColor[i] * attenuation;
-		tmpColor += shade(n, v, l, radiance, d, metallicSample, roughnessSample);
-	}
+	// Point and spot lights touching the cluster of the fragment
+	uint cluster = clusterIndex();
+	uint clusterLightCount = clusters.clusters[cluster].lightCount;
+	for (uint i = 0; i < clusterLightCount; i++) {
+		Light light = lights.lights[clusters.clusters[cluster].lightIndices[i]];
+		float distance = length(light.position.xyz - fragmentPos);
+		if (distance > light.position.w) {
+			continue;
+		}
+		l = normalize(light.position.xyz - fragmentPos);
+
+		// Inverse square falloff, windowed to reach zero at the range of the light
+		float window = clamp(1.0 - pow(distance / light.position.w, 4.0), 0.0, 1.0);
+		float attenuation = (window * window) / (distance * distance);
+		vec3 radiance = light.color.xyz * attenuation;
 
-	for (int i = 0; i < numSpotLights; i++) {
-		l = normalize(lights.spotLightsPosition[i] - fragmentPos);
-		float theta = dot(l, normalize(-lights.spotLightsDirection[i]));
-		if (theta > lights.spotLightsCutoffs[i].x) {
-			float shadow = shadowValue(spotLightSpaces[i], shadowMapIndex);
-			tmpColor += shade(n, v, l, lights.spotLightsColor[i], d, metallicSample, roughnessSample) * shadow;
+		if (light.direction.w == LIGHT_POINT) {
+			tmpColor += shade(n, v, l, radiance, d, metallicSample, roughnessSample);
 		}
-		else if (theta > lights.spotLightsCutoffs[i].y) {
-			float shadow = shadowValue(spotLightSpaces[i], shadowMapIndex);
-			float epsilon = lights.spotLightsCutoffs[i].x - lights.spotLightsCutoffs[i].y;
-			float intensity = clamp((theta - lights.spotLightsCutoffs[i].y) / epsilon, 0.0, 1.0);
-			tmpColor += shade(n, v, l, lights.spotLightsColor[i] * intensity, d * intensity, metallicSample, roughnessSample) * shadow;
+		else {
+			float theta = dot(l, normalize(-light.direction.xyz));
+			if (theta > light.cutoffs.x) {
+				float shadow = shadowValue(int(light.color.w));
+				tmpColor += shade(n, v, l, radiance, d, metallicSample, roughnessSample) * shadow;
+			}
+			else if (theta > light.cutoffs.y) {
+				float shadow = shadowValue(int(light.color.w));
+				float epsilon = light.cutoffs.x - light.cutoffs.y;
+				float intensity = clamp((theta - light.cutoffs.y) / epsilon, 0.0, 1.0);
+				tmpColor += shade(n, v, l, radiance * intensity, d * intensity, metallicSample, roughnessSample) * shadow;
+			}
 		}
-		shadowMapIndex++;
 	}
 
 	vec3 fRoughness = fresnelRoughness(max(dot(n, v), 0.0), mix(vec3(0.04), d, metallicSample), roughnessSample);
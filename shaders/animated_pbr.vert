@@ -1,13 +1,14 @@
 #version 450
 
-#define MAX_DIR_LIGHTS 10
-#define MAX_POINT_LIGHTS 10
-#define MAX_SPOT_LIGHTS 10
 #define MAX_BONES 256
 
-layout(set = 0, binding = 0) uniform Object {
-	mat4 model;
-} object;
+layout(set = 0, binding = 0) readonly buffer Objects {
+	mat4 models[];
+} objects;
+
+layout(set = 0, binding = 9) readonly buffer VisibleInstances {
+	uint indices[];
+} visibleInstances;
 
 layout(set = 0, binding = 1) uniform Camera {
 	mat4 view;
@@ -15,12 +16,6 @@ layout(set = 0, binding = 1) uniform Camera {
 	vec3 pos;
 } camera;
 
-layout(set = 0, binding = 2) uniform Shadow {
-	vec3 numLights;
-	mat4 dirLightSpaces[MAX_DIR_LIGHTS];
-	mat4 spotLightSpaces[MAX_SPOT_LIGHTS];
-} shadow;
-
 layout(set = 1, binding = 4) uniform Bones {
 	mat4 transformations[MAX_BONES];
 	mat4 inverseBindMatrices[MAX_BONES];
@@ -38,16 +33,15 @@ layout(location = 0) out vec2 outUv;
 layout(location = 1) out vec3 outCameraPos;
 layout(location = 2) out vec3 outFragmentPos;
 layout(location = 3) out vec4 outWeights;
-layout(location = 4) out vec4 outDirLightSpaces[MAX_DIR_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + 4) out vec4 outSpotLightSpaces[MAX_SPOT_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + MAX_SPOT_LIGHTS + 4) out mat3 outTBN;
+layout(location = 4) out mat3 outTBN;
 
 void main() {
+	mat4 model = objects.models[visibleInstances.indices[gl_InstanceIndex]];
 	outUv = uv;
 	vec3 bitangent = normalize(cross(normal, tangent));
-	vec3 T = normalize(vec3(object.model * vec4(tangent, 0.0)));
-	vec3 B = normalize(vec3(object.model * vec4(bitangent, 0.0)));
-	vec3 N = normalize(vec3(object.model * vec4(normal, 0.0)));
+	vec3 T = normalize(vec3(model * vec4(tangent, 0.0)));
+	vec3 B = normalize(vec3(model * vec4(bitangent, 0.0)));
+	vec3 N = normalize(vec3(model * vec4(normal, 0.0)));
 	outTBN = mat3(T, B, N);
 	outCameraPos = camera.pos;
 	outWeights = weights;
@@ -57,19 +51,7 @@ void main() {
 	+ weights.z * bones.transformations[int(joints.z)]
 	+ weights.w * bones.transformations[int(joints.w)];
 	
-	outFragmentPos = vec3(object.model * skinMat * vec4(position, 1.0));
+	outFragmentPos = vec3(model * skinMat * vec4(position, 1.0));
 
-	int numDirLights = int(shadow.numLights.x);
-	int numPointLights = int(shadow.numLights.y);
-	int numSpotLights = int(shadow.numLights.z);
-	
-	for (int i = 0; i < shadow.numLights.x; i++) {
-		outDirLightSpaces[i] = shadow.dirLightSpaces[i] * vec4(outFragmentPos, 1.0);
-	}
-	
-	for (int i = 0; i < shadow.numLights.z; i++) {
-		outSpotLightSpaces[i] = shadow.spotLightSpaces[i] * vec4(outFragmentPos, 1.0);
-	}
-	
 	gl_Position = camera.projection * camera.view * vec4(outFragmentPos, 1.0);
 }
\ No newline at end of file
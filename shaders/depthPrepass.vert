@@ -1,8 +1,12 @@
 #version 450
 
-layout(set = 0, binding = 0) uniform Object {
-	mat4 model;
-} object;
+layout(set = 0, binding = 0) readonly buffer Objects {
+	mat4 models[];
+} objects;
+
+layout(set = 0, binding = 2) readonly buffer VisibleInstances {
+	uint indices[];
+} visibleInstances;
 
 layout(set = 0, binding = 1) uniform Camera {
 	mat4 view;
@@ -11,9 +15,14 @@ layout(set = 0, binding = 1) uniform Camera {
 } camera;
 
 layout(location = 0) in vec3 position;
-layout(location = 1) in vec4 joints;
-layout(location = 2) in vec4 weights;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec4 joints;
+layout(location = 3) in vec4 weights;
+
+layout(location = 0) out vec3 viewNormal;
 
 void main() {
-	gl_Position = camera.projection * camera.view * vec4(vec3(object.model * vec4(position, 1.0)), 1.0);
+	mat4 model = objects.models[visibleInstances.indices[gl_InstanceIndex]];
+	gl_Position = camera.projection * camera.view * vec4(vec3(model * vec4(position, 1.0)), 1.0);
+	viewNormal = mat3(camera.view) * vec3(model * vec4(normal, 0.0));
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
 #version 450
 
-#define MAX_DIR_LIGHTS 10
-#define MAX_POINT_LIGHTS 10
-#define MAX_SPOT_LIGHTS 10
+layout(set = 0, binding = 0) readonly buffer Objects {
+	mat4 models[];
+} objects;
 
-layout(set = 0, binding = 0) uniform Object {
-	mat4 model;
-} object;
+layout(set = 0, binding = 9) readonly buffer VisibleInstances {
+	uint indices[];
+} visibleInstances;
 
 layout(set = 0, binding = 1) uniform Camera {
 	mat4 view;
@@ -14,12 +14,6 @@ layout(set = 0, binding = 1) uniform Camera {
 	vec3 pos;
 } camera;
 
-layout(set = 0, binding = 2) uniform Shadow {
-	vec3 numLights;
-	mat4 dirLightSpaces[MAX_DIR_LIGHTS];
-	mat4 spotLightSpaces[MAX_SPOT_LIGHTS];
-} shadow;
-
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 uv;
@@ -31,31 +25,18 @@ layout(location = 6) in vec4 weights;
 layout(location = 0) out vec2 outUv;
 layout(location = 1) out vec3 outCameraPos;
 layout(location = 2) out vec3 outFragmentPos;
-layout(location = 3) out vec4 outDirLightSpaces[MAX_DIR_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + 3) out vec4 outSpotLightSpaces[MAX_SPOT_LIGHTS];
-layout(location = MAX_DIR_LIGHTS + MAX_SPOT_LIGHTS + 3) out mat3 outTBN;
+layout(location = 3) out mat3 outTBN;
 
 void main() {
+	mat4 model = objects.models[visibleInstances.indices[gl_InstanceIndex]];
 	outUv = uv;
 	vec3 bitangent = cross(normal, tangent);
-	vec3 T = vec3(object.model * vec4(tangent, 0.0));
-	vec3 B = vec3(object.model * vec4(bitangent, 0.0));
-	vec3 N = vec3(object.model * vec4(normal, 0.0));
+	vec3 T = vec3(model * vec4(tangent, 0.0));
+	vec3 B = vec3(model * vec4(bitangent, 0.0));
+	vec3 N = vec3(model * vec4(normal, 0.0));
 	outTBN = mat3(T, B, N);
 	outCameraPos = camera.pos;
-	outFragmentPos = vec3(object.model * vec4(position, 1.0));
+	outFragmentPos = vec3(model * vec4(position, 1.0));
 
-	int numDirLights = int(shadow.numLights.x);
-	int numPointLights = int(shadow.numLights.y);
-	int numSpotLights = int(shadow.numLights.z);
-	
-	for (int i = 0; i < shadow.numLights.x; i++) {
-		outDirLightSpaces[i] = shadow.dirLightSpaces[i] * vec4(outFragmentPos, 1.0);
-	}
-	
-	for (int i = 0; i < shadow.numLights.z; i++) {
-		outSpotLightSpaces[i] = shadow.spotLightSpaces[i] * vec4(outFragmentPos, 1.0);
-	}
-	
 	gl_Position = camera.projection * camera.view * vec4(outFragmentPos, 1.0);
 }
\ No newline at end of file
@@ -1,19 +1,19 @@
 #version 450
 
-#define MAX_DIR_LIGHTS 10
-#define MAX_POINT_LIGHTS 10
-#define MAX_SPOT_LIGHTS 10
+#define MAX_SHADOW_MAPS 16
 
-layout(set = 0, binding = 0) uniform Object {
-	mat4 model;
-} object;
+layout(set = 0, binding = 0) readonly buffer Objects {
+	mat4 models[];
+} objects;
 
 layout(set = 0, binding = 1) uniform Shadow {
-	vec3 numLights;
-	mat4 dirLightSpaces[MAX_DIR_LIGHTS];
-	mat4 spotLightSpaces[MAX_SPOT_LIGHTS];
+	mat4 lightSpaces[MAX_SHADOW_MAPS];
 } shadow;
 
+layout(set = 0, binding = 2) readonly buffer VisibleInstances {
+	uint indices[];
+} visibleInstances;
+
 layout(push_constant) uniform LightIndex {
 	int lightIndex;
 } lightIndex;
@@ -21,13 +21,8 @@ layout(push_constant) uniform LightIndex {
 layout(location = 0) in vec3 position;
 
 void main() {
-	int numDirLights = int(shadow.numLights.x);
-	
-	if (lightIndex.lightIndex < numDirLights) {
-		gl_Position = shadow.dirLightSpaces[lightIndex.lightIndex] * object.model * vec4(position, 1.0);
-	}
-	else if (lightIndex.lightIndex >= numDirLights) {
-		gl_Position = shadow.spotLightSpaces[lightIndex.lightIndex - numDirLights] * object.model * vec4(position, 1.0);
-	}
+	mat4 model = objects.models[visibleInstances.indices[gl_InstanceIndex]];
+
+	gl_Position = shadow.lightSpaces[lightIndex.lightIndex] * model * vec4(position, 1.0);
 	gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "Game.h"
+#include "inputs/Inputs.h"
 
 extern ECS ecs;
 
 void Game::init() {
+	commands.init(&ecs);
+
 	// Register components
 	ecs.registerComponent<Transform>();
 	ecs.registerComponent<Camera>();
@@ -37,6 +40,48 @@ void Game::init() {
 	physicsMask.set(ecs.getComponentId<Transform>());
 	physicsMask.set(ecs.getComponentId<Rigidbody>());
 	ecs.setSystemComponents<Physics>(physicsMask);
+
+	transformSystem = ecs.registerSystem<TransformSystem>();
+	ComponentMask transformMask;
+	transformMask.set(ecs.getComponentId<Transform>());
+	ecs.setSystemComponents<TransformSystem>(transformMask);
+
+	// Views used by the systems, they must exist before the systems run on several threads
+	ecs.view<const Rigidbody, const Transform>();
+	ecs.view<Renderable, const Transform>();
+
+	// Schedule systems, the ones not sharing written components run in parallel
+	uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	scheduler.init(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+	physics->threadPool = &scheduler.threadPool;
+	transformSystem->threadPool = &scheduler.threadPool;
+	renderer->threadPool = &scheduler.threadPool;
+
+	ComponentMask noComponents;
+
+	scheduler.addSystem("CameraControls", noComponents, cameraMask, false, [this](double deltaTime) {
+		cameraControls->update(deltaTime);
+	});
+
+	// Lighting only writes the lights registry, which the renderer reads
+	uint32_t lightingSystem = scheduler.addSystem("Lighting", noComponents, noComponents, false, [this](double) {
+		lighting->update();
+	});
+
+	scheduler.addSystem("Physics", physicsMask, physicsMask, false, [this](double deltaTime) {
+		physics->update(deltaTime);
+	});
+
+	scheduler.addSystem("Transforms", transformMask, transformMask, false, [this](double) {
+		transformSystem->update();
+	});
+
+	// Vulkan submission stays on the main thread
+	ComponentMask rendererReadMask = rendererMask | cameraMask | lightingMask;
+	uint32_t rendererSystem = scheduler.addSystem("Renderer", rendererReadMask, rendererMask, true, [this](double) {
+		renderer->update();
+	});
+	scheduler.addOrder(lightingSystem, rendererSystem);
 }
 
 void Game::launch() {
@@ -50,17 +95,24 @@ void Game::launch() {
 		double currentTime = glfwGetTime();
 		double deltaTime = currentTime - lastFrame;
 
-		cameraControls->update(deltaTime);
+		scheduler.run(deltaTime);
 
-		lighting->update();
+		// Changes made from now on belong to the next frame
+		ecs.advanceVersion();
 
-		physics->update(deltaTime);
+		// Structural changes recorded by the systems are applied once all of them are done
+		commands.playback();
 
-		renderer->update();
+		if (NEIGE_DEBUG) {
+			if (keyboardInputs.tKey == KeyState::PRESSED) {
+				scheduler.printTimings();
+			}
+		}
 
 		lastFrame = currentTime;
 	}
 
+	scheduler.destroy();
 	renderer->destroy();
 	window->destroy();
 }
\ No newline at end of file
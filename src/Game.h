@@ -1,5 +1,7 @@
 #pragma once
 #include "ecs/ECS.h"
+#include "ecs/SystemScheduler.h"
+#include "ecs/EntityCommandBuffer.h"
 #include "ecs/components/Transform.h"
 #include "ecs/components/Camera.h"
 #include "ecs/components/Light.h"
@@ -10,6 +12,7 @@
 #include "ecs/systems/Lighting.h"
 #include "ecs/systems/CameraSystem.h"
 #include "ecs/systems/CameraControls.h"
+#include "ecs/systems/TransformSystem.h"
 
 #include "window/Window.h"
 
@@ -20,6 +23,9 @@ struct Game {
 	std::shared_ptr<CameraSystem> cameraSystem;
 	std::shared_ptr<CameraControls> cameraControls;
 	std::shared_ptr<Physics> physics;
+	std::shared_ptr<TransformSystem> transformSystem;
+	SystemScheduler scheduler;
+	EntityCommandBuffer commands;
 	double lastFrame = 0.0;
 
 	void init();
@@ -1,61 +1,332 @@
 #pragma once
-#include "../utils/NeigeDefines.h"
+#include "../utils/NeigeLogging.h"
 #include <stdexcept>
 #include <bitset>
-#include <queue>
+#include <deque>
 #include <array>
 #include <unordered_map>
 #include <memory>
+#include <tuple>
+#include <utility>
+#include <algorithm>
 #include <set>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <typeinfo>
+#include <atomic>
+#include <type_traits>
 
-#define MAX_ENTITIES 4096
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_INDEX_MASK 0xFFFFF
+#define ENTITY_GENERATION_MASK 0xFFF
+// Last generation, never given to a live entity, marks the entities created by a command buffer
+#define PROVISIONAL_GENERATION ENTITY_GENERATION_MASK
+#define NO_ENTITY UINT32_MAX
+#define MAX_ENTITIES (1 << ENTITY_INDEX_BITS)
+#define ENTITY_PAGE_SIZE 4096
+#define MIN_FREE_ENTITY_INDICES 1024
 #define MAX_COMPONENTS 32
+#define NO_COMPONENT UINT8_MAX
+
+// 16 KB
+#define ARCHETYPE_CHUNK_SIZE 16384
+#define NO_ARCHETYPE UINT32_MAX
+
+#define SPARSE_PAGE_SIZE 1024
+#define COMPONENT_PAGE_SIZE 1024
+#define VIEW_CHUNK_SIZE 1024
+#define NO_INDEX UINT32_MAX
 
 using Entity = uint32_t;
 using Component = uint8_t;
 using ComponentMask = std::bitset<MAX_COMPONENTS>;
 
-class EntityManager {
+enum struct ComponentStorage {
+	ARRAYS,
+	ARCHETYPES
+};
+
+// Sequential index per type, each family (components, systems, views) has its own sequence
+template<typename Family>
+class TypeIndex {
 public:
-	EntityManager() {
-		for (Entity entity = 0; entity < MAX_ENTITIES; entity++) {
-			entities.push(entity);
-		}
+	template<typename T>
+	static uint32_t get() {
+		static const uint32_t index = next();
+		return index;
+	}
+private:
+	static uint32_t next() {
+		static std::atomic<uint32_t> counter{ 0 };
+		return counter.fetch_add(1);
 	}
+};
+
+// Entity handle : 20 bits index, 12 bits generation
+inline uint32_t entityIndex(Entity entity) {
+	return entity & ENTITY_INDEX_MASK;
+}
+
+inline uint32_t entityGeneration(Entity entity) {
+	return (entity >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK;
+}
 
+inline Entity createEntityHandle(uint32_t index, uint32_t generation) {
+	return (generation << ENTITY_INDEX_BITS) | index;
+}
+
+struct EntitySlot {
+	ComponentMask componentMask;
+	uint32_t generation = 0;
+	bool alive = false;
+};
+
+using EntityPage = std::array<EntitySlot, ENTITY_PAGE_SIZE>;
+
+class EntityManager {
+public:
 	Entity createEntity() {
-		NEIGE_ASSERT(numberOfEntities < MAX_ENTITIES, "Too much entities (" + std::to_string(numberOfEntities) + " entities, MAX = " + std::to_string(MAX_ENTITIES) + ").");
+		uint32_t index;
+		// Recycled indices wait in the queue so a generation does not come back too soon
+		if (freeIndices.size() > MIN_FREE_ENTITY_INDICES) {
+			index = freeIndices.front();
+			freeIndices.pop_front();
+		}
+		else {
+			NEIGE_ASSERT(nextIndex < MAX_ENTITIES, "Too much entities (" + std::to_string(numberOfEntities) + " entities, MAX = " + std::to_string(MAX_ENTITIES) + ").");
+
+			index = nextIndex++;
+			if ((index / ENTITY_PAGE_SIZE) == pages.size()) {
+				pages.push_back(std::make_unique<EntityPage>());
+			}
+		}
 
-		Entity id = entities.front();
-		entities.pop();
+		EntitySlot& entitySlot = slot(index);
+		entitySlot.alive = true;
 		numberOfEntities++;
 
-		return id;
+		return createEntityHandle(index, entitySlot.generation);
+	}
+
+	std::vector<Entity> createEntities(uint32_t count) {
+		std::vector<Entity> createdEntities;
+		createdEntities.reserve(count);
+
+		// Fresh indices are handed out in one block, pages are allocated once
+		uint32_t recycledCount = (freeIndices.size() > MIN_FREE_ENTITY_INDICES) ? std::min(count, static_cast<uint32_t>(freeIndices.size() - MIN_FREE_ENTITY_INDICES)) : 0;
+		uint32_t freshCount = count - recycledCount;
+
+		NEIGE_ASSERT(nextIndex + freshCount <= MAX_ENTITIES, "Too much entities (" + std::to_string(numberOfEntities + count) + " entities, MAX = " + std::to_string(MAX_ENTITIES) + ").");
+
+		for (uint32_t i = 0; i < recycledCount; i++) {
+			uint32_t index = freeIndices.front();
+			freeIndices.pop_front();
+
+			EntitySlot& entitySlot = slot(index);
+			entitySlot.alive = true;
+			createdEntities.push_back(createEntityHandle(index, entitySlot.generation));
+		}
+
+		while (pages.size() * ENTITY_PAGE_SIZE < nextIndex + freshCount) {
+			pages.push_back(std::make_unique<EntityPage>());
+		}
+
+		for (uint32_t index = nextIndex; index < nextIndex + freshCount; index++) {
+			EntitySlot& entitySlot = slot(index);
+			entitySlot.alive = true;
+			createdEntities.push_back(createEntityHandle(index, entitySlot.generation));
+		}
+		nextIndex += freshCount;
+		numberOfEntities += count;
+
+		return createdEntities;
 	}
 
 	void destroyEntity(Entity entity) {
-		NEIGE_ASSERT(entity < numberOfEntities, "Entity " + std::to_string(entity) + " is not in range (destroy entity).");
+		NEIGE_ASSERT(isAlive(entity), "Entity " + std::to_string(entity) + " is not alive (destroy entity).");
 
-		componentMasks[entity].reset();
-		entities.push(entity);
+		EntitySlot& entitySlot = slot(entityIndex(entity));
+		entitySlot.componentMask.reset();
+		entitySlot.generation = (entitySlot.generation + 1) % PROVISIONAL_GENERATION;
+		entitySlot.alive = false;
+		freeIndices.push_back(entityIndex(entity));
 		numberOfEntities--;
 	}
 
+	bool isAlive(Entity entity) {
+		uint32_t index = entityIndex(entity);
+		if (index >= nextIndex) {
+			return false;
+		}
+
+		EntitySlot& entitySlot = slot(index);
+		return entitySlot.alive && (entitySlot.generation == entityGeneration(entity));
+	}
+
 	void setComponents(Entity entity, ComponentMask componentMask) {
-		NEIGE_ASSERT(entity < numberOfEntities, "Entity " + std::to_string(entity) + " is not in range (set components).");
+		NEIGE_ASSERT(isAlive(entity), "Entity " + std::to_string(entity) + " is not alive (set components).");
 
-		componentMasks[entity] = componentMask;
+		slot(entityIndex(entity)).componentMask = componentMask;
 	}
 
 	ComponentMask getComponents(Entity entity) {
-		NEIGE_ASSERT(entity < numberOfEntities, "Entity " + std::to_string(entity) + " is not in range (get components).");
+		NEIGE_ASSERT(isAlive(entity), "Entity " + std::to_string(entity) + " is not alive (get components).");
+
+		return slot(entityIndex(entity)).componentMask;
+	}
 
-		return componentMasks[entity];
+	uint32_t getEntityCount() {
+		return numberOfEntities;
 	}
 private:
-	std::queue<Entity> entities;
-	std::array<ComponentMask, MAX_ENTITIES> componentMasks;
+	std::vector<std::unique_ptr<EntityPage>> pages;
+	std::deque<uint32_t> freeIndices;
+	uint32_t nextIndex = 0;
 	uint32_t numberOfEntities = 0;
+
+	EntitySlot& slot(uint32_t index) {
+		return (*pages[index / ENTITY_PAGE_SIZE])[index % ENTITY_PAGE_SIZE];
+	}
+};
+
+// Version of the last write of a component, per entity index
+class ComponentVersions {
+public:
+	// Allocates the page if needed, must not be called from several threads
+	void set(Entity entity, uint32_t version) {
+		uint32_t index = entityIndex(entity);
+		size_t page = index / SPARSE_PAGE_SIZE;
+		if (page >= pages.size()) {
+			pages.resize(page + 1);
+		}
+		if (!pages[page]) {
+			pages[page] = std::make_unique<std::array<uint32_t, SPARSE_PAGE_SIZE>>();
+			pages[page]->fill(0);
+		}
+
+		(*pages[page])[index % SPARSE_PAGE_SIZE] = version;
+	}
+
+	// The page must exist, entities having the component always have one
+	void mark(Entity entity, uint32_t version) {
+		uint32_t index = entityIndex(entity);
+		size_t page = index / SPARSE_PAGE_SIZE;
+		NEIGE_ASSERT((page < pages.size()) && pages[page], "Component of entity \"" + std::to_string(entity) + "\" was never added (mark).");
+
+		(*pages[page])[index % SPARSE_PAGE_SIZE] = version;
+	}
+
+	uint32_t get(Entity entity) const {
+		uint32_t index = entityIndex(entity);
+		size_t page = index / SPARSE_PAGE_SIZE;
+		if ((page >= pages.size()) || !pages[page]) {
+			return 0;
+		}
+
+		return (*pages[page])[index % SPARSE_PAGE_SIZE];
+	}
+private:
+	std::vector<std::unique_ptr<std::array<uint32_t, SPARSE_PAGE_SIZE>>> pages;
+};
+
+// Sparse set of entities: paged entity to index array and packed entity array
+class EntitySet {
+public:
+	bool insert(Entity entity) {
+		if (contains(entity)) {
+			return false;
+		}
+
+		size_t page = entityIndex(entity) / SPARSE_PAGE_SIZE;
+		if (sparse.size() <= page) {
+			sparse.resize(page + 1);
+		}
+		if (!sparse[page]) {
+			sparse[page] = std::make_unique<std::array<uint32_t, SPARSE_PAGE_SIZE>>();
+			sparse[page]->fill(NO_INDEX);
+		}
+
+		(*sparse[page])[entityIndex(entity) % SPARSE_PAGE_SIZE] = static_cast<uint32_t>(dense.size());
+		dense.push_back(entity);
+		modificationCount++;
+
+		return true;
+	}
+
+	// Swaps the last entity into the hole
+	bool erase(Entity entity) {
+		if (!contains(entity)) {
+			return false;
+		}
+
+		uint32_t& entityIndexInDense = sparseIndex(entity);
+		Entity entityLast = dense.back();
+		if (entityLast != entity) {
+			dense[entityIndexInDense] = entityLast;
+			sparseIndex(entityLast) = entityIndexInDense;
+		}
+		entityIndexInDense = NO_INDEX;
+		dense.pop_back();
+		modificationCount++;
+
+		return true;
+	}
+
+	bool contains(Entity entity) const {
+		size_t page = entityIndex(entity) / SPARSE_PAGE_SIZE;
+		if ((page >= sparse.size()) || !sparse[page]) {
+			return false;
+		}
+
+		uint32_t index = (*sparse[page])[entityIndex(entity) % SPARSE_PAGE_SIZE];
+		return (index != NO_INDEX) && (dense[index] == entity);
+	}
+
+	uint32_t index(Entity entity) const {
+		return (*sparse[entityIndex(entity) / SPARSE_PAGE_SIZE])[entityIndex(entity) % SPARSE_PAGE_SIZE];
+	}
+
+	void clear() {
+		for (Entity entity : dense) {
+			sparseIndex(entity) = NO_INDEX;
+		}
+		dense.clear();
+		modificationCount++;
+	}
+
+	// Changes every time an entity is inserted or erased
+	uint32_t getModificationCount() const {
+		return modificationCount;
+	}
+
+	size_t size() const {
+		return dense.size();
+	}
+
+	bool empty() const {
+		return dense.empty();
+	}
+
+	const Entity* data() const {
+		return dense.data();
+	}
+
+	std::vector<Entity>::const_iterator begin() const {
+		return dense.begin();
+	}
+
+	std::vector<Entity>::const_iterator end() const {
+		return dense.end();
+	}
+private:
+	std::vector<std::unique_ptr<std::array<uint32_t, SPARSE_PAGE_SIZE>>> sparse;
+	std::vector<Entity> dense;
+	uint32_t modificationCount = 0;
+
+	uint32_t& sparseIndex(Entity entity) {
+		return (*sparse[entityIndex(entity) / SPARSE_PAGE_SIZE])[entityIndex(entity) % SPARSE_PAGE_SIZE];
+	}
 };
 
 class IComponentArray {
@@ -64,165 +335,797 @@ public:
 	virtual void entityDestroyed(Entity entity) = 0;
 };
 
+// Sparse set of entities with packed components in the same order
+// Components live in fixed-size pages that are never moved nor freed, adding components keeps the references to the others valid
+// Removing a component moves the last one into its slot, which invalidates the references to both
 template<typename T>
 class ComponentArray : public IComponentArray {
 public:
+	~ComponentArray() {
+		for (size_t i = 0; i < entities.size(); i++) {
+			dataAt(i).~T();
+		}
+	}
+
 	void insertData(Entity entity, T component) {
-		NEIGE_ASSERT(entityToIndex.find(entity) == entityToIndex.end(), "Component added to same entity (insert data).");
+		NEIGE_ASSERT(!hasData(entity), "Component added to same entity (insert data).");
 
-		size_t tmp = validSize;
-		entityToIndex[entity] = tmp;
-		indexToEntity[tmp] = entity;
-		components[tmp] = component;
-		validSize++;
+		size_t index = entities.size();
+		if (index == pages.size() * COMPONENT_PAGE_SIZE) {
+			pages.push_back(std::unique_ptr<ComponentPage>(new ComponentPage));
+		}
+		new (slot(index)) T(std::move(component));
+		entities.insert(entity);
 	}
 
 	void removeData(Entity entity) {
-		NEIGE_ASSERT(entityToIndex.find(entity) != entityToIndex.end(), "Component \"" + std::to_string(entity) + "\" does not exist (remove data).");
+		NEIGE_ASSERT(hasData(entity), "Component \"" + std::to_string(entity) + "\" does not exist (remove data).");
 
-		size_t tmp = entityToIndex[entity];
-		components[tmp] = components[validSize - 1];
-		Entity entityLast = indexToEntity[validSize - 1];
-		entityToIndex[entityLast] = tmp;
-		indexToEntity[tmp] = entityLast;
-		entityToIndex.erase(entity);
-		indexToEntity.erase(validSize - 1);
-		validSize--;
+		uint32_t index = entities.index(entity);
+		size_t last = entities.size() - 1;
+		if (index != last) {
+			dataAt(index) = std::move(dataAt(last));
+		}
+		dataAt(last).~T();
+		entities.erase(entity);
 	}
 
 	T& getData(Entity entity) {
-		NEIGE_ASSERT(entityToIndex.find(entity) != entityToIndex.end(), "Component \"" + std::to_string(entity) + "\" does not exist (get data).");
+		NEIGE_ASSERT(hasData(entity), "Component \"" + std::to_string(entity) + "\" does not exist (get data).");
 
-		return components[entityToIndex[entity]];
+		return dataAt(entities.index(entity));
+	}
+
+	bool hasData(Entity entity) {
+		return entities.contains(entity);
 	}
 
 	void entityDestroyed(Entity entity) override {
-		if (entityToIndex.find(entity) == entityToIndex.end()) {
+		if (hasData(entity)) {
 			removeData(entity);
 		}
 	}
+
+	// Dense arrays, dataAt(i) belongs to entitiesData()[i]
+	size_t size() {
+		return entities.size();
+	}
+
+	T& dataAt(size_t index) {
+		return *std::launder(static_cast<T*>(slot(index)));
+	}
+
+	const Entity* entitiesData() {
+		return entities.data();
+	}
+private:
+	// Raw storage, the components are constructed in place
+	struct ComponentPage {
+		alignas(T) unsigned char data[sizeof(T) * COMPONENT_PAGE_SIZE];
+	};
+
+	EntitySet entities;
+	std::vector<std::unique_ptr<ComponentPage>> pages;
+
+	void* slot(size_t index) {
+		return pages[index / COMPONENT_PAGE_SIZE]->data + (sizeof(T) * (index % COMPONENT_PAGE_SIZE));
+	}
+};
+
+struct ComponentInfo {
+	size_t size;
+	size_t alignment;
+	void (*moveConstruct)(void* destination, void* source);
+	void (*destroy)(void* component);
+
+	template<typename T>
+	static ComponentInfo create() {
+		ComponentInfo componentInfo;
+		componentInfo.size = sizeof(T);
+		componentInfo.alignment = alignof(T);
+		componentInfo.moveConstruct = [](void* destination, void* source) {
+			new (destination) T(std::move(*static_cast<T*>(source)));
+		};
+		componentInfo.destroy = [](void* component) {
+			static_cast<T*>(component)->~T();
+		};
+
+		return componentInfo;
+	}
+};
+
+struct EntityLocation {
+	uint32_t archetype = NO_ARCHETYPE;
+	uint32_t chunk;
+	uint32_t row;
+};
+
+struct ArchetypeChunk {
+	std::unique_ptr<std::max_align_t[]> data;
+	std::vector<Entity> entities;
+	uint32_t count = 0;
+};
+
+// Entities sharing the same component mask, stored as SoA columns in fixed-size chunks
+struct Archetype {
+	ComponentMask mask;
+	std::array<int32_t, MAX_COMPONENTS> columns;
+	std::vector<ComponentInfo> columnInfos;
+	std::vector<size_t> columnOffsets;
+	size_t chunkSize = 0;
+	uint32_t chunkCapacity = 0;
+	std::vector<ArchetypeChunk> chunks;
+
+	~Archetype() {
+		for (uint32_t chunk = 0; chunk < chunks.size(); chunk++) {
+			for (uint32_t row = 0; row < chunks[chunk].count; row++) {
+				for (int32_t column = 0; column < static_cast<int32_t>(columnInfos.size()); column++) {
+					columnInfos[column].destroy(getComponent(chunk, row, column));
+				}
+			}
+		}
+	}
+
+	void init(ComponentMask archetypeMask, const std::vector<ComponentInfo>& componentInfos) {
+		mask = archetypeMask;
+		columns.fill(-1);
+
+		size_t rowSize = 0;
+		for (Component component = 0; component < componentInfos.size(); component++) {
+			if (mask.test(component)) {
+				columns[component] = static_cast<int32_t>(columnInfos.size());
+				columnInfos.push_back(componentInfos[component]);
+				rowSize += componentInfos[component].size;
+			}
+		}
+
+		chunkCapacity = std::max(static_cast<uint32_t>(ARCHETYPE_CHUNK_SIZE / std::max(rowSize, static_cast<size_t>(1))), 1u);
+
+		for (const ComponentInfo& columnInfo : columnInfos) {
+			chunkSize = (chunkSize + columnInfo.alignment - 1) & ~(columnInfo.alignment - 1);
+			columnOffsets.push_back(chunkSize);
+			chunkSize += columnInfo.size * chunkCapacity;
+		}
+	}
+
+	void* getComponent(uint32_t chunk, uint32_t row, int32_t column) {
+		return reinterpret_cast<uint8_t*>(chunks[chunk].data.get()) + columnOffsets[column] + (columnInfos[column].size * row);
+	}
+
+	EntityLocation allocate(Entity entity, uint32_t archetypeIndex) {
+		// Only the last chunk can have free rows
+		if (chunks.empty() || chunks.back().count == chunkCapacity) {
+			ArchetypeChunk chunk;
+			chunk.data = std::make_unique<std::max_align_t[]>((chunkSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+			chunk.entities.resize(chunkCapacity);
+			chunks.push_back(std::move(chunk));
+		}
+
+		EntityLocation location;
+		location.archetype = archetypeIndex;
+		location.chunk = static_cast<uint32_t>(chunks.size() - 1);
+		location.row = chunks.back().count;
+		chunks.back().entities[location.row] = entity;
+		chunks.back().count++;
+
+		return location;
+	}
+
+	// Destroys the components at this location and fills the hole with the last row, returns the entity that moved
+	Entity remove(EntityLocation location, bool* moved) {
+		for (int32_t column = 0; column < static_cast<int32_t>(columnInfos.size()); column++) {
+			columnInfos[column].destroy(getComponent(location.chunk, location.row, column));
+		}
+
+		uint32_t lastChunk = static_cast<uint32_t>(chunks.size() - 1);
+		uint32_t lastRow = chunks[lastChunk].count - 1;
+		Entity lastEntity = chunks[lastChunk].entities[lastRow];
+		*moved = (location.chunk != lastChunk) || (location.row != lastRow);
+
+		if (*moved) {
+			for (int32_t column = 0; column < static_cast<int32_t>(columnInfos.size()); column++) {
+				void* lastComponent = getComponent(lastChunk, lastRow, column);
+				columnInfos[column].moveConstruct(getComponent(location.chunk, location.row, column), lastComponent);
+				columnInfos[column].destroy(lastComponent);
+			}
+			chunks[location.chunk].entities[location.row] = lastEntity;
+		}
+
+		chunks[lastChunk].count--;
+		if (chunks[lastChunk].count == 0) {
+			chunks.pop_back();
+		}
+
+		return lastEntity;
+	}
+};
+
+class ArchetypeStorage {
+public:
+	template<typename T>
+	void registerComponent(Component component) {
+		if (componentInfos.size() <= component) {
+			componentInfos.resize(static_cast<size_t>(component) + 1);
+		}
+		componentInfos[component] = ComponentInfo::create<T>();
+	}
+
+	template<typename T>
+	void insertData(Entity entity, Component component, T data) {
+		uint32_t index = entityIndex(entity);
+		if (locations.size() <= index) {
+			locations.resize(static_cast<size_t>(index) + 1);
+		}
+
+		ComponentMask mask = (locations[index].archetype != NO_ARCHETYPE) ? archetypes[locations[index].archetype]->mask : ComponentMask();
+
+		NEIGE_ASSERT(!mask.test(component), "Component added to same entity (insert data).");
+
+		mask.set(component);
+		EntityLocation location = moveEntity(entity, mask);
+
+		Archetype* archetype = archetypes[location.archetype].get();
+		new (archetype->getComponent(location.chunk, location.row, archetype->columns[component])) T(std::move(data));
+	}
+
+	// Moves the entity once to the archetype of the mask, components that are not kept are left to construct with emplaceData
+	void changeMask(Entity entity, ComponentMask mask, ComponentMask kept) {
+		uint32_t index = entityIndex(entity);
+		if (locations.size() <= index) {
+			locations.resize(static_cast<size_t>(index) + 1);
+		}
+
+		moveEntity(entity, mask, kept);
+	}
+
+	template<typename T>
+	void emplaceData(Entity entity, Component component, T data) {
+		EntityLocation location = locations[entityIndex(entity)];
+		Archetype* archetype = archetypes[location.archetype].get();
+		new (archetype->getComponent(location.chunk, location.row, archetype->columns[component])) T(std::move(data));
+	}
+
+	void removeData(Entity entity, Component component) {
+		NEIGE_ASSERT(hasData(entity, component), "Component \"" + std::to_string(entity) + "\" does not exist (remove data).");
+
+		ComponentMask mask = archetypes[locations[entityIndex(entity)].archetype]->mask;
+		mask.reset(component);
+		moveEntity(entity, mask);
+	}
+
+	template<typename T>
+	T& getData(Entity entity, Component component) {
+		NEIGE_ASSERT(hasData(entity, component), "Component \"" + std::to_string(entity) + "\" does not exist (get data).");
+
+		EntityLocation location = locations[entityIndex(entity)];
+		Archetype* archetype = archetypes[location.archetype].get();
+		return *static_cast<T*>(archetype->getComponent(location.chunk, location.row, archetype->columns[component]));
+	}
+
+	bool hasData(Entity entity, Component component) {
+		uint32_t index = entityIndex(entity);
+		if ((index >= locations.size()) || (locations[index].archetype == NO_ARCHETYPE)) {
+			return false;
+		}
+
+		EntityLocation location = locations[index];
+		Archetype* archetype = archetypes[location.archetype].get();
+		return archetype->mask.test(component) && (archetype->chunks[location.chunk].entities[location.row] == entity);
+	}
+
+	void entityDestroyed(Entity entity) {
+		uint32_t index = entityIndex(entity);
+		if ((index < locations.size()) && (locations[index].archetype != NO_ARCHETYPE)) {
+			removeFromArchetype(entity);
+			locations[index].archetype = NO_ARCHETYPE;
+		}
+	}
+
+	// Calls function(entity, components...) for every entity having at least the required components, chunk by chunk
+	template<typename... Ts, typename F>
+	void forEach(ComponentMask required, const std::array<Component, sizeof...(Ts)>& components, F&& function) {
+		for (uint32_t archetype = 0; archetype < archetypes.size(); archetype++) {
+			if ((archetypes[archetype]->mask & required) == required) {
+				forEachInArchetype<Ts...>(archetype, components, function);
+			}
+		}
+	}
+
+	template<typename... Ts, typename F>
+	void forEachInArchetype(uint32_t archetype, const std::array<Component, sizeof...(Ts)>& components, F&& function) {
+		for (uint32_t chunk = 0; chunk < archetypes[archetype]->chunks.size(); chunk++) {
+			forEachInChunk<Ts...>(archetypes[archetype].get(), chunk, components, function, std::index_sequence_for<Ts...>{});
+		}
+	}
+
+	template<typename... Ts, typename F>
+	void forEachInArchetypeChunk(uint32_t archetype, uint32_t chunk, const std::array<Component, sizeof...(Ts)>& components, F&& function) {
+		forEachInChunk<Ts...>(archetypes[archetype].get(), chunk, components, function, std::index_sequence_for<Ts...>{});
+	}
+
+	uint32_t getArchetypeChunkCount(uint32_t archetype) {
+		return static_cast<uint32_t>(archetypes[archetype]->chunks.size());
+	}
+
+	uint32_t getArchetypeCount() {
+		return static_cast<uint32_t>(archetypes.size());
+	}
+
+	ComponentMask getArchetypeMask(uint32_t archetype) {
+		return archetypes[archetype]->mask;
+	}
 private:
-	std::array<T, MAX_ENTITIES> components;
-	std::unordered_map<Entity, size_t> entityToIndex;
-	std::unordered_map<size_t, Entity> indexToEntity;
-	size_t validSize;
+	std::vector<ComponentInfo> componentInfos;
+	std::vector<std::unique_ptr<Archetype>> archetypes;
+	std::unordered_map<ComponentMask, uint32_t> archetypeIndices;
+	std::vector<EntityLocation> locations;
+
+	uint32_t getArchetype(ComponentMask mask) {
+		std::unordered_map<ComponentMask, uint32_t>::iterator it = archetypeIndices.find(mask);
+		if (it != archetypeIndices.end()) {
+			return it->second;
+		}
+
+		std::unique_ptr<Archetype> archetype = std::make_unique<Archetype>();
+		archetype->init(mask, componentInfos);
+		archetypes.push_back(std::move(archetype));
+
+		uint32_t archetypeIndex = static_cast<uint32_t>(archetypes.size() - 1);
+		archetypeIndices.emplace(mask, archetypeIndex);
+		return archetypeIndex;
+	}
+
+	// Moves the entity and its shared kept components to the archetype matching the mask
+	EntityLocation moveEntity(Entity entity, ComponentMask mask, ComponentMask kept = ComponentMask().set()) {
+		uint32_t index = entityIndex(entity);
+		EntityLocation oldLocation = locations[index];
+
+		if (mask.none()) {
+			if (oldLocation.archetype != NO_ARCHETYPE) {
+				removeFromArchetype(entity);
+			}
+			locations[index].archetype = NO_ARCHETYPE;
+
+			return locations[index];
+		}
+
+		uint32_t archetypeIndex = getArchetype(mask);
+		Archetype* archetype = archetypes[archetypeIndex].get();
+
+		// Same archetype, the components that are not kept are destroyed in place
+		if (oldLocation.archetype == archetypeIndex) {
+			for (Component component = 0; component < componentInfos.size(); component++) {
+				if (mask.test(component) && !kept.test(component)) {
+					archetype->columnInfos[archetype->columns[component]].destroy(archetype->getComponent(oldLocation.chunk, oldLocation.row, archetype->columns[component]));
+				}
+			}
+
+			return oldLocation;
+		}
+
+		EntityLocation newLocation = archetype->allocate(entity, archetypeIndex);
+
+		if (oldLocation.archetype != NO_ARCHETYPE) {
+			Archetype* oldArchetype = archetypes[oldLocation.archetype].get();
+			for (Component component = 0; component < componentInfos.size(); component++) {
+				if (oldArchetype->mask.test(component) && mask.test(component) && kept.test(component)) {
+					archetype->columnInfos[archetype->columns[component]].moveConstruct(archetype->getComponent(newLocation.chunk, newLocation.row, archetype->columns[component]), oldArchetype->getComponent(oldLocation.chunk, oldLocation.row, oldArchetype->columns[component]));
+				}
+			}
+			removeFromArchetype(entity);
+		}
+		locations[index] = newLocation;
+
+		return newLocation;
+	}
+
+	void removeFromArchetype(Entity entity) {
+		EntityLocation location = locations[entityIndex(entity)];
+
+		bool moved;
+		Entity movedEntity = archetypes[location.archetype]->remove(location, &moved);
+		if (moved) {
+			locations[entityIndex(movedEntity)] = location;
+		}
+	}
+
+	template<typename... Ts, typename F, size_t... Is>
+	void forEachInChunk(Archetype* archetype, uint32_t chunk, const std::array<Component, sizeof...(Ts)>& components, F& function, std::index_sequence<Is...>) {
+		std::tuple<Ts*...> columns = std::make_tuple(static_cast<Ts*>(archetype->getComponent(chunk, 0, archetype->columns[components[Is]]))...);
+		ArchetypeChunk& archetypeChunk = archetype->chunks[chunk];
+		for (uint32_t row = 0; row < archetypeChunk.count; row++) {
+			function(archetypeChunk.entities[row], std::get<Is>(columns)[row]...);
+		}
+	}
 };
 
 class ComponentManager {
 public:
+	ComponentManager(ComponentStorage componentStorage) : storage(componentStorage) {}
+
 	template<typename T>
 	void registerComponent() {
-		const char* typeName = typeid(T).name();
-		
-		NEIGE_ASSERT(componentTypes.find(typeName) == componentTypes.end(), "Component \"" + std::string(typeName) + "\" is already registered (register component).");
+		uint32_t typeIndex = TypeIndex<IComponentArray>::get<T>();
+		if (typeIndex >= componentTypes.size()) {
+			componentTypes.resize(typeIndex + 1, NO_COMPONENT);
+		}
 
-		componentTypes.insert({ typeName, nextComponent });
-		componentArrays.insert({ typeName, std::make_shared<ComponentArray<T>>() });
+		NEIGE_ASSERT(componentTypes[typeIndex] == NO_COMPONENT, "Component \"" + std::string(typeid(T).name()) + "\" is already registered (register component).");
+		NEIGE_ASSERT(nextComponent < MAX_COMPONENTS, "Too many components registered (register component).");
+
+		componentTypes[typeIndex] = nextComponent;
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.registerComponent<T>(nextComponent);
+		}
+		else {
+			componentArrays.push_back(std::make_unique<ComponentArray<T>>());
+		}
 		nextComponent++;
 	}
 
 	template<typename T>
 	Component getComponentId() {
-		const char* typeName = typeid(T).name();
+		uint32_t typeIndex = TypeIndex<IComponentArray>::get<T>();
 
-		NEIGE_ASSERT(componentTypes.find(typeName) != componentTypes.end(), "Component \"" + std::string(typeName) + "\" does not exist (get component).");
+		NEIGE_ASSERT(typeIndex < componentTypes.size() && componentTypes[typeIndex] != NO_COMPONENT, "Component \"" + std::string(typeid(T).name()) + "\" does not exist (get component).");
 
-		return componentTypes[typeName];
+		return componentTypes[typeIndex];
 	}
 
 	template<typename T>
 	void addComponent(Entity entity, T component) {
-		getComponentArray<T>()->insertData(entity, component);
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.insertData<T>(entity, getComponentId<T>(), std::move(component));
+		}
+		else {
+			getComponentArray<T>()->insertData(entity, component);
+		}
 	}
 
 	template<typename T>
 	void removeComponent(Entity entity) {
-		getComponentArray<T>()->removeData(entity);
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.removeData(entity, getComponentId<T>());
+		}
+		else {
+			getComponentArray<T>()->removeData(entity);
+		}
 	}
 
 	template<typename T>
 	T& getComponent(Entity entity) {
+		if (storage == ComponentStorage::ARCHETYPES) {
+			return archetypeStorage.getData<T>(entity, getComponentId<T>());
+		}
+		
 		return getComponentArray<T>()->getData(entity);
 	}
 
+	// Removes the components of the old mask that are not kept, the new ones must then be emplaced
+	void changeComponents(Entity entity, ComponentMask oldMask, ComponentMask kept, ComponentMask newMask) {
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.changeMask(entity, newMask, kept);
+		}
+		else {
+			for (Component component = 0; component < nextComponent; component++) {
+				if (oldMask.test(component) && !(kept.test(component) && newMask.test(component))) {
+					componentArrays[component]->entityDestroyed(entity);
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	void emplaceComponent(Entity entity, T component) {
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.emplaceData<T>(entity, getComponentId<T>(), std::move(component));
+		}
+		else {
+			getComponentArray<T>()->insertData(entity, component);
+		}
+	}
+
+	// Change tracking
+	void setChanged(Component component, Entity entity) {
+		versions[component].set(entity, currentVersion);
+	}
+
+	void markChanged(Component component, Entity entity) {
+		versions[component].mark(entity, currentVersion);
+	}
+
+	uint32_t getComponentVersion(Component component, Entity entity) {
+		return versions[component].get(entity);
+	}
+
+	uint32_t getVersion() {
+		return currentVersion;
+	}
+
+	void advanceVersion() {
+		currentVersion++;
+	}
+
 	void entityDestroyed(Entity entity) {
-		for (auto const& pair : componentArrays) {
-			auto const& componentArray = pair.second;
-			componentArray->entityDestroyed(entity);
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.entityDestroyed(entity);
+		}
+		else {
+			for (std::unique_ptr<IComponentArray>& componentArray : componentArrays) {
+				componentArray->entityDestroyed(entity);
+			}
+		}
+	}
+
+	template<typename T, typename... Ts, typename F>
+	void forEach(EntityManager* entityManager, F&& function) {
+		ComponentMask required;
+		std::array<Component, sizeof...(Ts) + 1> components = { getComponentId<T>(), getComponentId<Ts>()... };
+		for (Component component : components) {
+			required.set(component);
+		}
+
+		if (storage == ComponentStorage::ARCHETYPES) {
+			archetypeStorage.forEach<T, Ts...>(required, components, function);
 		}
+		else {
+			ComponentArray<T>* componentArray = getComponentArray<T>();
+			const Entity* entities = componentArray->entitiesData();
+			for (size_t i = 0; i < componentArray->size(); i++) {
+				if ((entityManager->getComponents(entities[i]) & required) == required) {
+					function(entities[i], componentArray->dataAt(i), getComponent<Ts>(entities[i])...);
+				}
+			}
+		}
+	}
+	ComponentStorage getStorage() {
+		return storage;
+	}
+
+	ArchetypeStorage* getArchetypeStorage() {
+		return &archetypeStorage;
+	}
+
+	template<typename T>
+	ComponentArray<T>* getComponentArray() {
+		NEIGE_ASSERT(storage == ComponentStorage::ARRAYS, "Component arrays are only available with array storage (get component array).");
+
+		return static_cast<ComponentArray<T>*>(componentArrays[getComponentId<T>()].get());
 	}
 private:
-	std::unordered_map<const char*, Component> componentTypes;
-	std::unordered_map<const char*, std::shared_ptr<IComponentArray>> componentArrays;
+	ComponentStorage storage;
+	// Component id per component type index
+	std::vector<Component> componentTypes;
+	// Component arrays per component id
+	std::vector<std::unique_ptr<IComponentArray>> componentArrays;
+	ArchetypeStorage archetypeStorage;
 	Component nextComponent = 0;
+	// Version 0 means never written
+	std::array<ComponentVersions, MAX_COMPONENTS> versions;
+	uint32_t currentVersion = 1;
+};
 
-	template<typename T>
-	std::shared_ptr<ComponentArray<T>> getComponentArray() {
-		const char* typeName = typeid(T).name();
+// Entities matching a component mask, kept up to date when masks change
+// Components given as const are only read, the others are marked as changed for every entity iterated
+class ViewBase {
+public:
+	virtual ~ViewBase() = default;
+
+	ComponentMask mask;
+	EntitySet entities;
+};
+
+template<typename... Ts>
+class View : public ViewBase {
+public:
+	View(ComponentManager* viewComponentManager) : componentManager(viewComponentManager) {
+		components = { componentManager->getComponentId<std::remove_const_t<Ts>>()... };
+		for (Component component : components) {
+			mask.set(component);
+		}
+
+		if (componentManager->getStorage() == ComponentStorage::ARRAYS) {
+			componentArrays = std::make_tuple(componentManager->getComponentArray<std::remove_const_t<Ts>>()...);
+		}
+	}
+
+	// Calls function(entity, components...) on every entity of the view
+	template<typename F>
+	void each(F&& function) {
+		auto trackedFunction = [&](Entity entity, Ts&... entityComponents) {
+			markChanged(entity, std::index_sequence_for<Ts...>{});
+			function(entity, entityComponents...);
+		};
+
+		if (componentManager->getStorage() == ComponentStorage::ARCHETYPES) {
+			ArchetypeStorage* archetypeStorage = componentManager->getArchetypeStorage();
+			updateArchetypes();
+
+			for (uint32_t archetype : archetypes) {
+				archetypeStorage->forEachInArchetype<std::remove_const_t<Ts>...>(archetype, components, trackedFunction);
+			}
+		}
+		else {
+			eachInArrays(trackedFunction, 0, entities.size(), std::index_sequence_for<Ts...>{});
+		}
+	}
+
+	// Splits the view in chunks that can be processed in parallel, must be called before eachInChunk
+	uint32_t getChunkCount() {
+		if (componentManager->getStorage() == ComponentStorage::ARCHETYPES) {
+			ArchetypeStorage* archetypeStorage = componentManager->getArchetypeStorage();
+			updateArchetypes();
+
+			archetypeChunks.clear();
+			for (uint32_t archetype : archetypes) {
+				for (uint32_t chunk = 0; chunk < archetypeStorage->getArchetypeChunkCount(archetype); chunk++) {
+					archetypeChunks.push_back({ archetype, chunk });
+				}
+			}
+
+			return static_cast<uint32_t>(archetypeChunks.size());
+		}
+		else {
+			return static_cast<uint32_t>((entities.size() + VIEW_CHUNK_SIZE - 1) / VIEW_CHUNK_SIZE);
+		}
+	}
+
+	// Calls function(entity, components...) on every entity of a chunk, chunks do not share any entity
+	template<typename F>
+	void eachInChunk(uint32_t chunk, F&& function) {
+		auto trackedFunction = [&](Entity entity, Ts&... entityComponents) {
+			markChanged(entity, std::index_sequence_for<Ts...>{});
+			function(entity, entityComponents...);
+		};
+
+		if (componentManager->getStorage() == ComponentStorage::ARCHETYPES) {
+			componentManager->getArchetypeStorage()->forEachInArchetypeChunk<std::remove_const_t<Ts>...>(archetypeChunks[chunk].first, archetypeChunks[chunk].second, components, trackedFunction);
+		}
+		else {
+			size_t begin = static_cast<size_t>(chunk) * VIEW_CHUNK_SIZE;
+			eachInArrays(trackedFunction, begin, std::min(begin + VIEW_CHUNK_SIZE, entities.size()), std::index_sequence_for<Ts...>{});
+		}
+	}
 
-		NEIGE_ASSERT(componentTypes.find(typeName) != componentTypes.end(), "Component \"" + std::string(typeName) + "\" does not exist (get component array).");
+	size_t size() {
+		return entities.size();
+	}
+private:
+	ComponentManager* componentManager;
+	std::array<Component, sizeof...(Ts)> components;
+	std::tuple<ComponentArray<std::remove_const_t<Ts>>*...> componentArrays;
+	std::vector<uint32_t> archetypes;
+	std::vector<std::pair<uint32_t, uint32_t>> archetypeChunks;
+	uint32_t checkedArchetypes = 0;
+
+	// Archetypes are never destroyed, only the new ones need to be checked
+	void updateArchetypes() {
+		ArchetypeStorage* archetypeStorage = componentManager->getArchetypeStorage();
+		for (; checkedArchetypes < archetypeStorage->getArchetypeCount(); checkedArchetypes++) {
+			if ((archetypeStorage->getArchetypeMask(checkedArchetypes) & mask) == mask) {
+				archetypes.push_back(checkedArchetypes);
+			}
+		}
+	}
+
+	template<size_t... Is>
+	void markChanged(Entity entity, std::index_sequence<Is...>) {
+		(markComponentChanged<Ts>(entity, components[Is]), ...);
+	}
+
+	template<typename T>
+	void markComponentChanged(Entity entity, Component component) {
+		if constexpr (!std::is_const_v<T>) {
+			componentManager->markChanged(component, entity);
+		}
+	}
 
-		return std::static_pointer_cast<ComponentArray<T>>(componentArrays[typeName]);
+	template<typename F, size_t... Is>
+	void eachInArrays(F& function, size_t begin, size_t end, std::index_sequence<Is...>) {
+		const Entity* viewEntities = entities.data();
+		for (size_t i = begin; i < end; i++) {
+			function(viewEntities[i], std::get<Is>(componentArrays)->getData(viewEntities[i])...);
+		}
 	}
 };
 
 class System {
 public:
-	std::set<Entity> entities;
+	EntitySet entities;
 };
 
 class SystemManager {
 public:
 	template<typename T>
 	std::shared_ptr<T> registerSystem() {
-		const char* typeName = typeid(T).name();
+		uint32_t typeIndex = TypeIndex<System>::get<T>();
+		if (typeIndex >= systems.size()) {
+			systems.resize(typeIndex + 1);
+		}
 
-		NEIGE_ASSERT(systems.find(typeName) == systems.end(), "System \"" + std::string(typeName) + "\" is already registered (register system).");
+		NEIGE_ASSERT(!systems[typeIndex], "System \"" + std::string(typeid(T).name()) + "\" is already registered (register system).");
 
 		std::shared_ptr<T> system = std::make_shared<T>();
-		systems.insert({ typeName, system });
+		systems[typeIndex] = system;
 		return system;
 	}
 
 	template<typename T>
 	void setComponents(ComponentMask componentMask) {
-		const char* typeName = typeid(T).name();
+		uint32_t typeIndex = TypeIndex<System>::get<T>();
+
+		NEIGE_ASSERT(typeIndex < systems.size() && systems[typeIndex], "System \"" + std::string(typeid(T).name()) + "\" does not exist (set components).");
 
-		NEIGE_ASSERT(systems.find(typeName) != systems.end(), "System \"" + std::string(typeName) + "\" does not exist (set components).");
+		addEntitySet(componentMask, &systems[typeIndex]->entities);
+	}
 
-		componentMasks.insert({ typeName, componentMask });
+	// Entity sets are only checked when a component of their mask changes
+	void addEntitySet(ComponentMask componentMask, EntitySet* entitySet) {
+		entitySets.push_back({ componentMask, entitySet });
+		for (Component component = 0; component < MAX_COMPONENTS; component++) {
+			if (componentMask.test(component)) {
+				entitySetsPerComponent[component].push_back(entitySets.size() - 1);
+			}
+		}
 	}
 
 	void entityDestroyed(Entity entity) {
-		for (auto const& pair : systems) {
-			auto const& system = pair.second;
-			system->entities.erase(entity);
+		for (auto const& pair : entitySets) {
+			pair.second->erase(entity);
+		}
+	}
+
+	// Several components changed at once, each entity set is checked once
+	void entityComponentMaskChanged(Entity entity, ComponentMask entityComponentMask, ComponentMask changedComponents) {
+		for (auto const& pair : entitySets) {
+			if ((pair.first & changedComponents).none()) {
+				continue;
+			}
+
+			if ((entityComponentMask & pair.first) == pair.first) {
+				pair.second->insert(entity);
+			} else {
+				pair.second->erase(entity);
+			}
+		}
+	}
+
+	// Entities without components that all got the same mask, each entity set is checked once
+	void entitiesComponentMaskSet(const std::vector<Entity>& entities, ComponentMask entityComponentMask) {
+		for (auto const& pair : entitySets) {
+			if ((entityComponentMask & pair.first) == pair.first) {
+				for (Entity entity : entities) {
+					pair.second->insert(entity);
+				}
+			}
 		}
 	}
 
-	void entityComponentMaskChanged(Entity entity, ComponentMask entityComponentMask) {
-		for (auto const& pair : systems) {
-			auto const& type = pair.first;
-			auto const& system = pair.second;
-			auto const& systemComponentMask = componentMasks[type];
-			if ((entityComponentMask & systemComponentMask) == systemComponentMask) {
-				system->entities.insert(entity);
+	void entityComponentMaskChanged(Entity entity, ComponentMask entityComponentMask, Component changedComponent) {
+		for (size_t entitySetIndex : entitySetsPerComponent[changedComponent]) {
+			auto const& entitySetComponentMask = entitySets[entitySetIndex].first;
+			EntitySet* entitySet = entitySets[entitySetIndex].second;
+			if ((entityComponentMask & entitySetComponentMask) == entitySetComponentMask) {
+				entitySet->insert(entity);
 			} else {
-				system->entities.erase(entity);
+				entitySet->erase(entity);
 			}
 		}
 	}
 private:
-	std::unordered_map<const char*, ComponentMask> componentMasks;
-	std::unordered_map<const char*, std::shared_ptr<System>> systems;
+	// Systems per system type index
+	std::vector<std::shared_ptr<System>> systems;
+	std::vector<std::pair<ComponentMask, EntitySet*>> entitySets;
+	std::array<std::vector<size_t>, MAX_COMPONENTS> entitySetsPerComponent;
 };
 
 class ECS {
 public:
-	void init() {
+	void init(ComponentStorage componentStorage = ComponentStorage::ARRAYS) {
 		entityManager = std::make_unique<EntityManager>();
-		componentManager = std::make_unique<ComponentManager>();
+		componentManager = std::make_unique<ComponentManager>(componentStorage);
 		systemManager = std::make_unique<SystemManager>();
+		views.clear();
 	}
 
 	// Entity
@@ -230,6 +1133,14 @@ public:
 		return entityManager->createEntity();
 	}
 
+	std::vector<Entity> createEntities(uint32_t count) {
+		return entityManager->createEntities(count);
+	}
+
+	bool isAlive(Entity entity) {
+		return entityManager->isAlive(entity);
+	}
+
 	void destroyEntity(Entity entity) {
 		entityManager->destroyEntity(entity);
 		componentManager->entityDestroyed(entity);
@@ -245,10 +1156,11 @@ public:
 	template<typename T>
 	void addComponent(Entity entity, T component) {
 		componentManager->addComponent<T>(entity, component);
+		componentManager->setChanged(componentManager->getComponentId<T>(), entity);
 		auto components = entityManager->getComponents(entity);
 		components.set(componentManager->getComponentId<T>(), true);
 		entityManager->setComponents(entity, components);
-		systemManager->entityComponentMaskChanged(entity, components);
+		systemManager->entityComponentMaskChanged(entity, components, componentManager->getComponentId<T>());
 	}
 
 	template<typename T>
@@ -257,19 +1169,122 @@ public:
 		auto components = entityManager->getComponents(entity);
 		components.set(componentManager->getComponentId<T>(), false);
 		entityManager->setComponents(entity, components);
-		systemManager->entityComponentMaskChanged(components);
+		systemManager->entityComponentMaskChanged(entity, components, componentManager->getComponentId<T>());
 	}
 
+	// Marks the component as changed, use readComponent to only read it
 	template<typename T>
 	T& getComponent(Entity entity) {
+		T& component = componentManager->getComponent<T>(entity);
+		componentManager->markChanged(componentManager->getComponentId<T>(), entity);
+		return component;
+	}
+
+	template<typename T>
+	const T& readComponent(Entity entity) {
 		return componentManager->getComponent<T>(entity);
 	}
 
+	// Marks the component as changed, for writes made without getComponent or a view giving it as non-const
+	template<typename T>
+	void markChanged(Entity entity) {
+		NEIGE_ASSERT(entityManager->getComponents(entity).test(componentManager->getComponentId<T>()), "Component \"" + std::to_string(entity) + "\" does not exist (mark changed).");
+
+		componentManager->markChanged(componentManager->getComponentId<T>(), entity);
+	}
+
+	ComponentMask getComponents(Entity entity) {
+		return entityManager->getComponents(entity);
+	}
+
+	// Structural change in one step, used by command buffers
+	// Components of the new mask that are not kept must then be emplaced with emplaceComponent
+	void changeComponents(Entity entity, ComponentMask kept, ComponentMask newMask) {
+		ComponentMask oldMask = entityManager->getComponents(entity);
+		componentManager->changeComponents(entity, oldMask, kept, newMask);
+		entityManager->setComponents(entity, newMask);
+		systemManager->entityComponentMaskChanged(entity, newMask, oldMask ^ newMask);
+	}
+
+	// Bulk instantiation of entities without components sharing the same mask, used by the scene loader
+	// The components must then be emplaced with emplaceComponent
+	void initializeComponents(const std::vector<Entity>& entities, ComponentMask mask) {
+		for (Entity entity : entities) {
+			NEIGE_ASSERT(entityManager->getComponents(entity).none(), "Entity " + std::to_string(entity) + " already has components (initialize components).");
+			componentManager->changeComponents(entity, ComponentMask(), ComponentMask(), mask);
+			entityManager->setComponents(entity, mask);
+		}
+		systemManager->entitiesComponentMaskSet(entities, mask);
+	}
+
+	template<typename T>
+	void emplaceComponent(Entity entity, T component) {
+		componentManager->emplaceComponent<T>(entity, std::move(component));
+		componentManager->setChanged(componentManager->getComponentId<T>(), entity);
+	}
+
+	// Change tracking
+	// The version is advanced once per frame, a component changed since version N has a version greater than N
+	uint32_t getVersion() {
+		return componentManager->getVersion();
+	}
+
+	void advanceVersion() {
+		componentManager->advanceVersion();
+	}
+
+	template<typename T>
+	uint32_t getComponentVersion(Entity entity) {
+		return componentManager->getComponentVersion(componentManager->getComponentId<T>(), entity);
+	}
+
+	template<typename T>
+	bool changedSince(Entity entity, uint32_t version) {
+		return getComponentVersion<T>(entity) > version;
+	}
+
 	template<typename T>
 	Component getComponentId() {
 		return componentManager->getComponentId<T>();
 	}
 
+	// Dense component array, only with array storage
+	template<typename T>
+	ComponentArray<T>* getComponentArray() {
+		return componentManager->getComponentArray<T>();
+	}
+
+	// Query
+	// With archetype storage, function(entity, components...) walks contiguous chunk memory
+	template<typename... Ts, typename F>
+	void forEach(F&& function) {
+		componentManager->forEach<Ts...>(entityManager.get(), [&](Entity entity, Ts&... entityComponents) {
+			(componentManager->markChanged(componentManager->getComponentId<Ts>(), entity), ...);
+			function(entity, entityComponents...);
+		});
+	}
+
+	// Cached view, created on first use and then updated incrementally
+	// Views should be created before systems start running on several threads
+	template<typename... Ts>
+	View<Ts...>& view() {
+		uint32_t typeIndex = TypeIndex<ViewBase>::get<View<Ts...>>();
+		if (typeIndex >= views.size()) {
+			views.resize(typeIndex + 1);
+		}
+
+		if (!views[typeIndex]) {
+			std::unique_ptr<View<Ts...>> newView = std::make_unique<View<Ts...>>(componentManager.get());
+			componentManager->forEach<std::remove_const_t<Ts>...>(entityManager.get(), [&](Entity entity, std::remove_const_t<Ts>&...) {
+				newView->entities.insert(entity);
+			});
+			systemManager->addEntitySet(newView->mask, &newView->entities);
+			views[typeIndex] = std::move(newView);
+		}
+
+		return *static_cast<View<Ts...>*>(views[typeIndex].get());
+	}
+
 	// System
 	template<typename T>
 	std::shared_ptr<T> registerSystem() {
@@ -284,4 +1299,6 @@ private:
 	std::unique_ptr<EntityManager> entityManager;
 	std::unique_ptr<ComponentManager> componentManager;
 	std::unique_ptr<SystemManager> systemManager;
+	// Views per view type index
+	std::vector<std::unique_ptr<ViewBase>> views;
 };
\ No newline at end of file
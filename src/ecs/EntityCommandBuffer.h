@@ -0,0 +1,181 @@
+#pragma once
+#include "ECS.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+enum struct EntityCommandType {
+	CREATE,
+	DESTROY,
+	ADD,
+	REMOVE
+};
+
+class IComponentPayload {
+public:
+	virtual ~IComponentPayload() = default;
+	virtual void emplace(ECS* ecs, Entity entity) = 0;
+};
+
+template<typename T>
+class ComponentPayload : public IComponentPayload {
+public:
+	ComponentPayload(T payloadComponent) : component(std::move(payloadComponent)) {}
+
+	void emplace(ECS* ecs, Entity entity) override {
+		ecs->emplaceComponent<T>(entity, std::move(component));
+	}
+private:
+	T component;
+};
+
+struct EntityCommand {
+	EntityCommandType type;
+	Entity entity;
+	Component component;
+	uint32_t sequence;
+	std::unique_ptr<IComponentPayload> payload;
+};
+
+// Records structural changes from any thread and applies them in one batch at a sync point
+class EntityCommandBuffer {
+public:
+	void init(ECS* commandECS) {
+		ecs = commandECS;
+	}
+
+	// The returned entity is provisional, it can be used in this buffer until playback
+	Entity createEntity() {
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		Entity provisionalEntity = createEntityHandle(provisionalEntityCount++, PROVISIONAL_GENERATION);
+		commands.push_back({ EntityCommandType::CREATE, provisionalEntity, 0, static_cast<uint32_t>(commands.size()), nullptr });
+		return provisionalEntity;
+	}
+
+	void destroyEntity(Entity entity) {
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		commands.push_back({ EntityCommandType::DESTROY, entity, 0, static_cast<uint32_t>(commands.size()), nullptr });
+	}
+
+	template<typename T>
+	void addComponent(Entity entity, T component) {
+		std::unique_ptr<IComponentPayload> payload = std::make_unique<ComponentPayload<T>>(std::move(component));
+		Component componentId = ecs->getComponentId<T>();
+
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		commands.push_back({ EntityCommandType::ADD, entity, componentId, static_cast<uint32_t>(commands.size()), std::move(payload) });
+	}
+
+	template<typename T>
+	void removeComponent(Entity entity) {
+		Component componentId = ecs->getComponentId<T>();
+
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		commands.push_back({ EntityCommandType::REMOVE, entity, componentId, static_cast<uint32_t>(commands.size()), nullptr });
+	}
+
+	// Must be called when no system is running
+	void playback() {
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		if (commands.empty()) {
+			return;
+		}
+
+		// Provisional entities become real entities in one block
+		std::vector<Entity> createdEntities = ecs->createEntities(provisionalEntityCount);
+		for (EntityCommand& command : commands) {
+			if (entityGeneration(command.entity) == PROVISIONAL_GENERATION) {
+				command.entity = createdEntities[entityIndex(command.entity)];
+			}
+		}
+
+		// Commands on the same entity are grouped, keeping their recording order
+		std::sort(commands.begin(), commands.end(), [](const EntityCommand& a, const EntityCommand& b) {
+			if (entityIndex(a.entity) != entityIndex(b.entity)) {
+				return entityIndex(a.entity) < entityIndex(b.entity);
+			}
+			if (a.entity != b.entity) {
+				return a.entity < b.entity;
+			}
+
+			return a.sequence < b.sequence;
+		});
+
+		size_t begin = 0;
+		while (begin < commands.size()) {
+			size_t end = begin + 1;
+			while ((end < commands.size()) && (commands[end].entity == commands[begin].entity)) {
+				end++;
+			}
+			applyEntityCommands(begin, end);
+			begin = end;
+		}
+
+		commands.clear();
+		provisionalEntityCount = 0;
+	}
+
+	size_t size() {
+		std::unique_lock<std::mutex> lock(commandsMutex);
+
+		return commands.size();
+	}
+private:
+	ECS* ecs = nullptr;
+	std::vector<EntityCommand> commands;
+	std::mutex commandsMutex;
+	uint32_t provisionalEntityCount = 0;
+
+	// The final mask is computed first so the entity is moved and its systems are updated only once
+	void applyEntityCommands(size_t begin, size_t end) {
+		Entity entity = commands[begin].entity;
+		if (!ecs->isAlive(entity)) {
+			return;
+		}
+
+		ComponentMask oldMask = ecs->getComponents(entity);
+		ComponentMask newMask = oldMask;
+		std::array<IComponentPayload*, MAX_COMPONENTS> payloads = {};
+		for (size_t i = begin; i < end; i++) {
+			EntityCommand& command = commands[i];
+			if (command.type == EntityCommandType::DESTROY) {
+				ecs->destroyEntity(entity);
+
+				return;
+			}
+			else if (command.type == EntityCommandType::ADD) {
+				newMask.set(command.component);
+				payloads[command.component] = command.payload.get();
+			}
+			else if (command.type == EntityCommandType::REMOVE) {
+				newMask.reset(command.component);
+				payloads[command.component] = nullptr;
+			}
+		}
+
+		// Components receiving a new value are replaced, not kept
+		ComponentMask kept = newMask;
+		for (Component component = 0; component < MAX_COMPONENTS; component++) {
+			if (payloads[component]) {
+				kept.reset(component);
+			}
+		}
+
+		if ((kept == oldMask) && (newMask == oldMask)) {
+			return;
+		}
+
+		ecs->changeComponents(entity, kept, newMask);
+		for (Component component = 0; component < MAX_COMPONENTS; component++) {
+			if (payloads[component]) {
+				payloads[component]->emplace(ecs, entity);
+			}
+		}
+	}
+};
@@ -0,0 +1,151 @@
+#include "SystemScheduler.h"
+
+void SystemScheduler::init(uint32_t threadCount) {
+	threadPool.init(threadCount);
+}
+
+void SystemScheduler::destroy() {
+	threadPool.destroy();
+}
+
+uint32_t SystemScheduler::addSystem(const std::string& name, ComponentMask reads, ComponentMask writes, bool mainThread, std::function<void(double)> update) {
+	ScheduledSystem system;
+	system.name = name;
+	system.reads = reads;
+	system.writes = writes;
+	system.mainThread = mainThread;
+	system.update = update;
+	systems.push_back(system);
+
+	graphOutdated = true;
+
+	return static_cast<uint32_t>(systems.size() - 1);
+}
+
+void SystemScheduler::addOrder(uint32_t before, uint32_t after) {
+	NEIGE_ASSERT(before < after && after < systems.size(), "A system must be added after the ones it runs after (add order).");
+
+	orders.push_back({ before, after });
+	graphOutdated = true;
+}
+
+void SystemScheduler::run(double frameDeltaTime) {
+	if (graphOutdated) {
+		buildGraph();
+	}
+
+	deltaTime = frameDeltaTime;
+	frameStart = std::chrono::steady_clock::now();
+	finishedSystems.store(0);
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		remainingDependencies[i].store(static_cast<uint32_t>(systems[i].dependencies.size()));
+	}
+
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		if (systems[i].dependencies.empty()) {
+			schedule(i);
+		}
+	}
+
+	// The main thread runs the systems that must stay on it and helps the workers otherwise
+	while (finishedSystems.load() < systems.size()) {
+		uint32_t mainThreadSystem = UINT32_MAX;
+		{
+			std::unique_lock<std::mutex> lock(mainThreadMutex);
+			if (!mainThreadSystems.empty()) {
+				mainThreadSystem = mainThreadSystems.front();
+				mainThreadSystems.pop_front();
+			}
+		}
+
+		if (mainThreadSystem != UINT32_MAX) {
+			runSystem(mainThreadSystem);
+		}
+		else if (!threadPool.runPendingTask()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void SystemScheduler::buildGraph() {
+	// Systems run in registration order unless they do not touch the same components
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		systems[i].dependencies.clear();
+		systems[i].dependents.clear();
+	}
+
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		for (uint32_t j = i + 1; j < systems.size(); j++) {
+			bool writeConflict = (systems[i].writes & (systems[j].reads | systems[j].writes)).any();
+			bool readConflict = (systems[i].reads & systems[j].writes).any();
+			bool mainThreadOrder = systems[i].mainThread && systems[j].mainThread;
+			bool explicitOrder = std::find(orders.begin(), orders.end(), std::make_pair(i, j)) != orders.end();
+			if (writeConflict || readConflict || mainThreadOrder || explicitOrder) {
+				systems[i].dependents.push_back(j);
+				systems[j].dependencies.push_back(i);
+			}
+		}
+	}
+
+	remainingDependencies = std::make_unique<std::atomic<uint32_t>[]>(systems.size());
+	graphOutdated = false;
+}
+
+void SystemScheduler::schedule(uint32_t system) {
+	if (systems[system].mainThread) {
+		std::unique_lock<std::mutex> lock(mainThreadMutex);
+		mainThreadSystems.push_back(system);
+	}
+	else {
+		threadPool.submit([this, system]() { runSystem(system); });
+	}
+}
+
+void SystemScheduler::runSystem(uint32_t system) {
+	ScheduledSystem& scheduledSystem = systems[system];
+
+	scheduledSystem.start = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+	scheduledSystem.update(deltaTime);
+	scheduledSystem.end = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+	for (uint32_t dependent : scheduledSystem.dependents) {
+		if (remainingDependencies[dependent].fetch_sub(1) == 1) {
+			schedule(dependent);
+		}
+	}
+	finishedSystems.fetch_add(1);
+}
+
+void SystemScheduler::printTimings() {
+	NEIGE_INFO("Systems timings of the last frame:");
+
+	// Longest chain of dependent systems, systems are already in topological order
+	std::vector<double> pathDurations(systems.size());
+	std::vector<uint32_t> pathPrevious(systems.size(), UINT32_MAX);
+	uint32_t pathEnd = 0;
+	for (uint32_t i = 0; i < systems.size(); i++) {
+		double longestDependency = 0.0;
+		for (uint32_t dependency : systems[i].dependencies) {
+			if (pathDurations[dependency] > longestDependency) {
+				longestDependency = pathDurations[dependency];
+				pathPrevious[i] = dependency;
+			}
+		}
+		pathDurations[i] = longestDependency + (systems[i].end - systems[i].start);
+		if (pathDurations[i] > pathDurations[pathEnd]) {
+			pathEnd = i;
+		}
+
+		std::cout << systems[i].name << (systems[i].mainThread ? " (main thread)" : "") << ": \033[95m" << systems[i].start << "\033[39m -> \033[96m" << systems[i].end << "\033[39m ms" << std::endl;
+	}
+
+	if (systems.empty()) {
+		return;
+	}
+
+	std::string criticalPath = systems[pathEnd].name;
+	for (uint32_t i = pathPrevious[pathEnd]; i != UINT32_MAX; i = pathPrevious[i]) {
+		criticalPath = systems[i].name + " -> " + criticalPath;
+	}
+	std::cout << "Critical path: " << criticalPath << " (\033[96m" << pathDurations[pathEnd] << "\033[39m ms)" << std::endl << std::endl;
+}
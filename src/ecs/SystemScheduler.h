@@ -0,0 +1,56 @@
+#pragma once
+#include "ECS.h"
+#include "../utils/threadpool/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct ScheduledSystem {
+	std::string name;
+	ComponentMask reads;
+	ComponentMask writes;
+	bool mainThread;
+	std::function<void(double)> update;
+
+	// Graph
+	std::vector<uint32_t> dependencies;
+	std::vector<uint32_t> dependents;
+
+	// Timing of the last frame, in milliseconds since the start of the frame
+	double start = 0.0;
+	double end = 0.0;
+};
+
+struct SystemScheduler {
+	ThreadPool threadPool;
+	std::vector<ScheduledSystem> systems;
+	// Explicit edges, for dependencies on resources that are not components
+	std::vector<std::pair<uint32_t, uint32_t>> orders;
+	bool graphOutdated = true;
+
+	// Frame
+	std::unique_ptr<std::atomic<uint32_t>[]> remainingDependencies;
+	std::atomic<uint32_t> finishedSystems{ 0 };
+	std::deque<uint32_t> mainThreadSystems;
+	std::mutex mainThreadMutex;
+	std::chrono::steady_clock::time_point frameStart;
+	double deltaTime = 0.0;
+
+	void init(uint32_t threadCount);
+	void destroy();
+	// Returns the index of the system
+	uint32_t addSystem(const std::string& name, ComponentMask reads, ComponentMask writes, bool mainThread, std::function<void(double)> update);
+	// The system after runs once the system before is done, before must have been added first
+	void addOrder(uint32_t before, uint32_t after);
+	void run(double frameDeltaTime);
+	void buildGraph();
+	void schedule(uint32_t system);
+	void runSystem(uint32_t system);
+	void printTimings();
+};
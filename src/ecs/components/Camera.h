@@ -12,9 +12,6 @@ struct Camera {
 	float farPlane;
 	std::string envmapPath = "";
 
-	glm::mat4 view;
-	glm::mat4 projection;
-
 	static glm::mat4 createLookAtView(glm::vec3 eye, glm::vec3 center, glm::vec3 up) {
 		return glm::lookAt(eye, center, up);
 	}
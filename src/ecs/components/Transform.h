@@ -2,10 +2,36 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "../../external/glm/glm/glm.hpp"
+#include "../../../external/glm/glm/gtc/quaternion.hpp"
+#include "../ECS.h"
 
 struct Transform {
-	glm::vec3 position;
-	glm::vec3 rotation;
-	glm::vec3 scale;
-};
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	// Hierarchy, the parent must have a Transform
+	Entity parent = NO_ENTITY;
+
+	// Computed by the TransformSystem
+	glm::mat4 worldMatrix = glm::mat4(1.0f);
+
+	glm::mat4 localMatrix() const {
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= scale.x;
+		matrix[1] *= scale.y;
+		matrix[2] *= scale.z;
+		matrix[3] = glm::vec4(position, 1.0f);
 
+		return matrix;
+	}
+
+	// Euler angles in degrees, applied in X, Y then Z order
+	static glm::quat eulerToQuaternion(glm::vec3 angles) {
+		glm::quat rotateX = glm::angleAxis(glm::radians(angles.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::quat rotateY = glm::angleAxis(glm::radians(angles.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::quat rotateZ = glm::angleAxis(glm::radians(angles.z), glm::vec3(0.0f, 0.0f, 1.0f));
+
+		return rotateX * rotateY * rotateZ;
+	}
+};
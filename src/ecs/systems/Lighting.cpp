@@ -5,14 +5,14 @@ extern ECS ecs;
 
 void Lighting::init() {
 	for (Entity entity : entities) {
-		lights.emplace(entity);
+		lights.insert(entity);
 	}
 	entities.clear();
 }
 
 void Lighting::update() {
 	for (Entity entity : entities) {
-		lights.emplace(entity);
+		lights.insert(entity);
 	}
 	entities.clear();
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "TransformSystem.h"
+
+extern ECS ecs;
+
+void TransformSystem::update() {
+	if (hierarchyChanged()) {
+		buildLevels();
+	}
+
+	// Breadth-first, entities of the same level do not depend on each other
+	for (const std::vector<Entity>& level : levels) {
+		uint32_t chunkCount = static_cast<uint32_t>((level.size() + TRANSFORM_CHUNK_SIZE - 1) / TRANSFORM_CHUNK_SIZE);
+		threadPool->parallelFor(chunkCount, [&](uint32_t chunk) {
+			size_t begin = static_cast<size_t>(chunk) * TRANSFORM_CHUNK_SIZE;
+			size_t end = std::min(begin + TRANSFORM_CHUNK_SIZE, level.size());
+			for (size_t i = begin; i < end; i++) {
+				Entity entity = level[i];
+				const Transform& entityTransform = ecs.readComponent<Transform>(entity);
+				bool entityHasParent = hasParent(entityTransform);
+
+				// The world matrix only changes if the transform or one of its ancestors changed
+				if (!ecs.changedSince<Transform>(entity, lastVersion) && !(entityHasParent && ecs.changedSince<Transform>(entityTransform.parent, lastVersion))) {
+					continue;
+				}
+
+				Transform& changedTransform = ecs.getComponent<Transform>(entity);
+				if (entityHasParent) {
+					changedTransform.worldMatrix = ecs.readComponent<Transform>(changedTransform.parent).worldMatrix * changedTransform.localMatrix();
+				}
+				else {
+					changedTransform.worldMatrix = changedTransform.localMatrix();
+				}
+			}
+		});
+	}
+
+	lastVersion = ecs.getVersion();
+}
+
+bool TransformSystem::hasParent(const Transform& transform) {
+	return (transform.parent != NO_ENTITY) && entities.contains(transform.parent);
+}
+
+Entity TransformSystem::effectiveParent(const Transform& transform) {
+	return hasParent(transform) ? transform.parent : NO_ENTITY;
+}
+
+bool TransformSystem::hierarchyChanged() {
+	if (entities.getModificationCount() != levelsModificationCount) {
+		return true;
+	}
+
+	// A parent can only have been changed on a transform written since the last update
+	for (Entity entity : entities) {
+		if (ecs.changedSince<Transform>(entity, lastVersion) && (effectiveParent(ecs.readComponent<Transform>(entity)) != levelParents[entityIndex(entity)])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TransformSystem::buildLevels() {
+	for (std::vector<Entity>& level : levels) {
+		level.clear();
+	}
+
+	for (Entity entity : entities) {
+		uint32_t index = entityIndex(entity);
+		if (index >= depths.size()) {
+			depths.resize(static_cast<size_t>(index) + 1);
+			levelParents.resize(static_cast<size_t>(index) + 1, NO_ENTITY);
+		}
+		depths[index] = UINT32_MAX;
+	}
+
+	for (Entity entity : entities) {
+		uint32_t depth = computeDepth(entity);
+		if (depth >= levels.size()) {
+			levels.resize(static_cast<size_t>(depth) + 1);
+		}
+		levels[depth].push_back(entity);
+
+		// An entity whose parent got destroyed or changed needs a new world matrix
+		Entity parent = effectiveParent(ecs.readComponent<Transform>(entity));
+		if (parent != levelParents[entityIndex(entity)]) {
+			ecs.getComponent<Transform>(entity);
+			levelParents[entityIndex(entity)] = parent;
+		}
+	}
+
+	while (!levels.empty() && levels.back().empty()) {
+		levels.pop_back();
+	}
+
+	levelsModificationCount = entities.getModificationCount();
+}
+
+uint32_t TransformSystem::computeDepth(Entity entity) {
+	// Walks up to the root or to an ancestor whose depth is known
+	std::vector<Entity> chain;
+	Entity current = entity;
+	uint32_t depth = 0;
+	while (depths[entityIndex(current)] == UINT32_MAX) {
+		chain.push_back(current);
+
+		NEIGE_ASSERT(chain.size() <= entities.size(), "Transform hierarchy of entity " + std::to_string(entity) + " has a cycle (compute depth).");
+
+		const Transform& currentTransform = ecs.readComponent<Transform>(current);
+		if (!hasParent(currentTransform)) {
+			depth = 0;
+			depths[entityIndex(current)] = 0;
+			chain.pop_back();
+			break;
+		}
+		current = currentTransform.parent;
+		depth = depths[entityIndex(current)];
+	}
+
+	for (std::vector<Entity>::reverse_iterator it = chain.rbegin(); it != chain.rend(); it++) {
+		depth++;
+		depths[entityIndex(*it)] = depth;
+	}
+
+	return depths[entityIndex(entity)];
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "../ECS.h"
+#include "../components/Transform.h"
+#include "../../utils/threadpool/ThreadPool.h"
+#include <algorithm>
+#include <vector>
+
+#define TRANSFORM_CHUNK_SIZE 256
+
+struct TransformSystem : public System {
+	ThreadPool* threadPool;
+
+	// Entities per depth in the hierarchy, a parent is always on a previous level
+	std::vector<std::vector<Entity>> levels;
+	// Parent and depth per entity index when the levels were built
+	std::vector<Entity> levelParents;
+	std::vector<uint32_t> depths;
+	uint32_t levelsModificationCount = UINT32_MAX;
+
+	// ECS version of the last update
+	uint32_t lastVersion = 0;
+
+	void update();
+	bool hasParent(const Transform& transform);
+	Entity effectiveParent(const Transform& transform);
+	bool hierarchyChanged();
+	void buildLevels();
+	uint32_t computeDepth(Entity entity);
+};
@@ -6,6 +6,10 @@
 #include "../ecs/components/Light.h"
 #include "../ecs/components/Camera.h"
 #include "../ecs/components/Renderable.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
 
 extern ECS ecs;
 
@@ -65,25 +69,20 @@ void Renderer::init() {
 	}
 
 	// Camera
-	auto& cameraCamera = ecs.getComponent<Camera>(camera);
-	cameraCamera.projection = Camera::createPerspectiveProjection(cameraCamera.FOV, window->extent.width / static_cast<float>(window->extent.height), cameraCamera.nearPlane, cameraCamera.farPlane, true);
+	auto const& cameraCamera = ecs.readComponent<Camera>(camera);
+	cameraProjection = Camera::createPerspectiveProjection(cameraCamera.FOV, window->extent.width / static_cast<float>(window->extent.height), cameraCamera.nearPlane, cameraCamera.farPlane, true);
 
-	cameraBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	for (Buffer& buffer : cameraBuffers) {
-		BufferTools::createUniformBuffer(buffer.buffer, buffer.deviceMemory, sizeof(CameraUniformBufferObject));
-	}
-
-	// Lights
-	lightingBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	for (Buffer& buffer : lightingBuffers) {
-		BufferTools::createUniformBuffer(buffer.buffer, buffer.deviceMemory, sizeof(LightingUniformBufferObject));
-	}
+	// Objects, every transform is uploaded on the first frame
+	lastInstancesLayouts.resize(MAX_FRAMES_IN_FLIGHT, 0);
+	lastTransformVersions.resize(MAX_FRAMES_IN_FLIGHT, 0);
 
-	// Time
-	timeBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	for (Buffer& buffer : timeBuffers) {
-		BufferTools::createUniformBuffer(buffer.buffer, buffer.deviceMemory, sizeof(double));
-	}
+	// Camera, lights, shadow, SSAO and time uniforms, written every frame in the region of the frame in flight
+	cameraUniformOffset = frameUniforms.reserve(sizeof(CameraUniformBufferObject));
+	lightingUniformOffset = frameUniforms.reserve(sizeof(LightingUniformBufferObject));
+	shadow.uniformOffset = frameUniforms.reserve(sizeof(ShadowUniformBufferObject));
+	ssao.uniformOffset = frameUniforms.reserve(sizeof(SSAOUniformBufferObject));
+	timeUniformOffset = frameUniforms.reserve(sizeof(float));
+	frameUniforms.init();
 
 	// Depth prepass
 	depthPrepass.init(fullscreenViewport);
@@ -91,7 +90,20 @@ void Renderer::init() {
 	// SSAO
 	ssao.init(fullscreenViewport);
 
-	// Shadow
+	// Shadow, one tile of the atlas per shadowed spot light and per cascade of the directional lights
+	for (Entity light : lights) {
+		auto const& lightLight = ecs.readComponent<Light>(light);
+
+		if (lightLight.type == LightType::DIRECTIONAL || lightLight.type == LightType::SPOT) {
+			int lightMapCount = (lightLight.type == LightType::DIRECTIONAL) ? SHADOW_CASCADE_COUNT : 1;
+			if (shadow.mapCount + lightMapCount > MAX_SHADOW_MAPS) {
+				NEIGE_WARNING("Too much shadowed lights, only the first " + std::to_string(MAX_SHADOW_MAPS) + " shadow maps are used.");
+				break;
+			}
+
+			shadow.mapCount += lightMapCount;
+		}
+	}
 	shadow.init();
 
 	// Envmap
@@ -111,8 +123,8 @@ void Renderer::init() {
 		skyboxDescriptorSets[i].init(&skyboxGraphicsPipeline, 0);
 
 		VkDescriptorBufferInfo cameraInfo = {};
-		cameraInfo.buffer = cameraBuffers.at(i).buffer;
-		cameraInfo.offset = 0;
+		cameraInfo.buffer = frameUniforms.buffer.buffer;
+		cameraInfo.offset = frameUniforms.offset(i, cameraUniformOffset);
 		cameraInfo.range = sizeof(CameraUniformBufferObject);
 
 		VkDescriptorImageInfo skyboxInfo = {};
@@ -151,34 +163,23 @@ void Renderer::init() {
 		skyboxDescriptorSets[i].update(writesDescriptorSet);
 	}
 
-	// Framebuffers
-	createResources();
-
-	{
-		for (Entity light : lights) {
-			auto const& lightLight = ecs.getComponent<Light>(light);
-
-			if (lightLight.type == LightType::DIRECTIONAL || lightLight.type == LightType::SPOT) {
-				std::vector<Framebuffer> lightFramebuffers;
-				lightFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-				Image depthAttachment;
-				ImageTools::createImage(&depthAttachment.image, 1, SHADOWMAP_WIDTH, SHADOWMAP_HEIGHT, 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthAttachment.allocationId);
-				ImageTools::createImageView(&depthAttachment.imageView, depthAttachment.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-				shadow.images.push_back(depthAttachment);
-
-				std::vector<std::vector<VkImageView>> framebufferAttachments;
-				framebufferAttachments.resize(MAX_FRAMES_IN_FLIGHT);
-				for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-					framebufferAttachments[i].push_back(depthAttachment.imageView);
-					lightFramebuffers[i].init(&shadow.renderPass, framebufferAttachments[i], SHADOWMAP_WIDTH, SHADOWMAP_HEIGHT, 1);
-				}
-				shadow.framebuffers.push_back(lightFramebuffers);
+	// Clustered lighting, the lights grow with the scene while the clusters are fixed
+	lightClustersComputePipeline.computeShaderPath = "../shaders/lightClusters.comp";
+	lightClustersComputePipeline.init();
 
-				shadow.mapCount++;
-			}
-		}
+	clusterBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	for (Buffer& buffer : clusterBuffers) {
+		BufferTools::createBuffer(buffer.buffer, sizeof(ClusterStorageBufferObject) * CLUSTER_X * CLUSTER_Y * CLUSTER_Z, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer.allocationId);
 	}
+	createLightBuffers(std::max(static_cast<uint32_t>(lights.size()), 1u));
+
+	// Render graph, creating the images the framebuffers are made of
+	createRenderGraph();
+
+	// Framebuffers
+	depthPrepass.createResources(fullscreenViewport);
+	ssao.createResources(fullscreenViewport);
+	createResources();
 
 	// Post-process
 	GraphicsPipeline postGraphicsPipeline;
@@ -235,10 +236,19 @@ void Renderer::init() {
 	materials.push_back(defaultMaterial);
 
 	// Object resources
+	createObjectBuffers(std::max(static_cast<uint32_t>(entities.size()), 1u));
 	for (Entity object : entities) {
 		loadObject(object);
 	}
 
+	// GPU-driven rendering, instanced draws are used when indirect draws cannot cover several primitives and instances
+	gpuDriven = physicalDevice.features.multiDrawIndirect && physicalDevice.features.drawIndirectFirstInstance;
+	NEIGE_INFO("GPU-driven rendering : " + std::string(gpuDriven ? "enabled" : "disabled"));
+	if (gpuDriven) {
+		gpuCulling.init();
+		gpuCulling.createResources(objectBufferCapacity, static_cast<uint32_t>(1 + (2 * shadow.mapCount)), 64, 64, visibleInstanceBuffers);
+	}
+
 	// Command pools and buffers
 	renderingCommandPools.resize(MAX_FRAMES_IN_FLIGHT);
 	renderingCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
@@ -246,6 +256,8 @@ void Renderer::init() {
 		renderingCommandPools[i].init();
 		renderingCommandBuffers[i].init(&renderingCommandPools[i]);
 	}
+	recordingCommandPools.resize(MAX_FRAMES_IN_FLIGHT);
+	recordingCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
 	// Sync objects
 	fences.resize(MAX_FRAMES_IN_FLIGHT);
@@ -275,6 +287,11 @@ void Renderer::update() {
 			}
 			skyboxGraphicsPipeline.destroyPipeline();
 			skyboxGraphicsPipeline.init();
+			if (gpuDriven) {
+				gpuCulling.reload();
+			}
+			lightClustersComputePipeline.destroyPipeline();
+			lightClustersComputePipeline.init();
 		}
 
 		if (keyboardInputs.cKey == KeyState::PRESSED) {
@@ -348,26 +365,34 @@ void Renderer::destroy() {
 	for (CommandPool& renderingCommandPool : renderingCommandPools) {
 		renderingCommandPool.destroy();
 	}
+	for (std::vector<CommandPool>& frameRecordingCommandPools : recordingCommandPools) {
+		for (CommandPool& recordingCommandPool : frameRecordingCommandPools) {
+			recordingCommandPool.destroy();
+		}
+	}
 	for (std::unordered_map<std::string, RenderPass>::iterator it = renderPasses.begin(); it != renderPasses.end(); it++) {
 		RenderPass* renderPass = &it->second;
 		renderPass->destroy();
 	}
-	for (Buffer& buffer : cameraBuffers) {
+	frameUniforms.destroy();
+	for (Buffer& buffer : objectBuffers) {
 		buffer.destroy();
 	}
-	for (Buffer& buffer : lightingBuffers) {
+	for (Buffer& buffer : visibleInstanceBuffers) {
 		buffer.destroy();
 	}
-	for (Buffer& buffer : timeBuffers) {
+	gpuCulling.destroy();
+	if (geometryVertexBuffer.buffer != VK_NULL_HANDLE) {
+		geometryVertexBuffer.destroy();
+		geometryIndexBuffer.destroy();
+	}
+	for (Buffer& buffer : lightBuffers) {
 		buffer.destroy();
 	}
-	for (Entity entity : entities) {
-		auto& objectRenderable = ecs.getComponent<Renderable>(entity);
-
-		for (Buffer& buffer : objectRenderable.buffers) {
-			buffer.destroy();
-		}
+	for (Buffer& buffer : clusterBuffers) {
+		buffer.destroy();
 	}
+	lightClustersComputePipeline.destroy();
 	for (std::unordered_map<std::string, GraphicsPipeline>::iterator it = graphicsPipelines.begin(); it != graphicsPipelines.end(); it++) {
 		GraphicsPipeline* graphicsPipeline = &it->second;
 		graphicsPipeline->destroy();
@@ -426,24 +451,11 @@ void Renderer::loadObject(Entity object) {
 
 	objectRenderable.graphicsPipeline = &graphicsPipelines.at(objectRenderable.lookupString);
 
-	objectRenderable.buffers.resize(MAX_FRAMES_IN_FLIGHT);
-	objectRenderable.descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-	objectRenderable.depthPrepassDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-	objectRenderable.shadowDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-
-	if (objectRenderable.graphicsPipeline->sets.size() != 0) {
-		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			// Buffers
-			BufferTools::createUniformBuffer(objectRenderable.buffers.at(i).buffer, objectRenderable.buffers.at(i).deviceMemory, sizeof(ObjectUniformBufferObject));
-
-			// Descriptor sets
-			objectRenderable.createEntityDescriptorSet(i);
-
-			// Depth prepass
-			objectRenderable.createDepthPrepassEntityDescriptorSet(i);
-
-			// Shadow
-			objectRenderable.createShadowEntityDescriptorSet(i);
+	// Descriptor sets, shared by every object using this graphics pipeline
+	if (objectRenderable.graphicsPipeline->sets.size() != 0 && objectDescriptorSets.find(objectRenderable.graphicsPipeline) == objectDescriptorSets.end()) {
+		objectDescriptorSets[objectRenderable.graphicsPipeline].resize(MAX_FRAMES_IN_FLIGHT);
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			createObjectDescriptorSet(objectRenderable.graphicsPipeline, i);
 		}
 	}
 
@@ -458,204 +470,1365 @@ void Renderer::loadObject(Entity object) {
 	}
 }
 
-void Renderer::updateData(uint32_t frameInFlightIndex) {
-	void* data;
+void Renderer::buildInstanceBatches() {
+	auto& renderables = ecs.view<Renderable, const Transform>();
+
+	// Removed renderables leave the spatial index
+	for (Entity instance : instances) {
+		if (!renderables.entities.contains(instance)) {
+			bvh.remove(bvhLeaves[entityIndex(instance)]);
+			bvhLeaves[entityIndex(instance)] = BVH_NULL_NODE;
+		}
+	}
+
+	instances.assign(renderables.entities.begin(), renderables.entities.end());
+
+	// Renderables added after initialization
+	for (Entity instance : instances) {
+		if (ecs.readComponent<Renderable>(instance).graphicsPipeline == nullptr) {
+			loadObject(instance);
+		}
+	}
+
+	std::sort(instances.begin(), instances.end(), [](Entity a, Entity b) {
+		auto const& aRenderable = ecs.readComponent<Renderable>(a);
+		auto const& bRenderable = ecs.readComponent<Renderable>(b);
+
+		return std::tie(aRenderable.lookupString, aRenderable.modelPath) < std::tie(bRenderable.lookupString, bRenderable.modelPath);
+	});
+
+	instanceBatches.clear();
+	instanceDynamic.resize(instances.size());
+	for (uint32_t i = 0; i < static_cast<uint32_t>(instances.size()); i++) {
+		auto const& objectRenderable = ecs.readComponent<Renderable>(instances[i]);
+		Model* model = &models.at(objectRenderable.modelPath);
+		instanceDynamic[i] = model->skinned ? UINT8_MAX : 0;
+
+		if (instanceBatches.empty() || instanceBatches.back().graphicsPipeline != objectRenderable.graphicsPipeline || instanceBatches.back().model != model) {
+			uint32_t pipelineIndex = 0;
+			if (!instanceBatches.empty()) {
+				pipelineIndex = instanceBatches.back().pipelineIndex + (instanceBatches.back().graphicsPipeline != objectRenderable.graphicsPipeline ? 1 : 0);
+			}
+			instanceBatches.push_back({ model, objectRenderable.graphicsPipeline, pipelineIndex, i, 0, {}, 0 });
+		}
+		instanceBatches.back().instanceCount++;
+
+		// Entity index to instance and leaf
+		uint32_t index = entityIndex(instances[i]);
+		if (index >= bvhLeaves.size()) {
+			bvhLeaves.resize(index + 1, BVH_NULL_NODE);
+			instanceIndices.resize(index + 1);
+		}
+		instanceIndices[index] = i;
+		if (bvhLeaves[index] == BVH_NULL_NODE) {
+			bvhLeaves[index] = bvh.insert(instances[i], model->aabb.transform(ecs.readComponent<Transform>(instances[i]).worldMatrix));
+		}
+	}
+
+	instancesModificationCount = renderables.entities.getModificationCount();
+	instancesLayout++;
+	staticCastersChanged = true;
+	batchBounds.resize(instanceBatches.size());
+	batchBoundsOutdated.assign(instanceBatches.size(), 1);
+
+	// Batches order, until the next sort
+	NEIGE_ASSERT(instanceBatches.size() < (1 << SORT_KEY_BATCH_BITS), "Too much instance batches to sort (" + std::to_string(instanceBatches.size()) + " batches).");
+	NEIGE_ASSERT(instanceBatches.empty() || instanceBatches.back().pipelineIndex < (1 << SORT_KEY_PIPELINE_BITS), "Too much graphics pipelines to sort (" + std::to_string(instanceBatches.back().pipelineIndex + 1) + " graphics pipelines).");
+	shadowBatchOrder.resize(instanceBatches.size());
+	for (uint32_t i = 0; i < static_cast<uint32_t>(instanceBatches.size()); i++) {
+		shadowBatchOrder[i] = i;
+	}
+	depthPrepassBatchOrder = shadowBatchOrder;
+	sceneBatchOrder = shadowBatchOrder;
+
+	// Object buffers growth, the frames in flight must be done with the old ones
+	bool objectBuffersGrown = instances.size() > objectBufferCapacity;
+	if (objectBuffersGrown) {
+		uint32_t capacity = objectBufferCapacity;
+		while (capacity < instances.size()) {
+			capacity *= 2;
+		}
+
+		logicalDevice.wait();
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			objectBuffers[i].destroy();
+			visibleInstanceBuffers[i].destroy();
+			depthPrepassDescriptorSets[i].destroy();
+			shadowDescriptorSets[i].destroy();
+		}
+		createObjectBuffers(capacity);
+		recreateObjectDescriptorSets();
+	}
+
+	// Draw commands, in instance batches order
+	drawCommands.clear();
+	for (InstanceBatch& instanceBatch : instanceBatches) {
+		instanceBatch.firstDrawCommand = static_cast<uint32_t>(drawCommands.size());
+		instanceBatch.model->createDrawCommands(instanceBatch.firstInstance, instanceBatch.instanceCount, &drawCommands);
+	}
+	viewDrawCommandCount = static_cast<uint32_t>(drawCommands.size());
+
+	if (gpuDriven) {
+		// Models loaded since the last build join the shared geometry
+		if (models.size() != geometryModelCount) {
+			createGeometryBuffers();
+		}
+
+		// Draw commands with the batch whose visible instances they draw, in the shared geometry
+		cullingDrawCommands.clear();
+		for (uint32_t i = 0; i < static_cast<uint32_t>(instanceBatches.size()); i++) {
+			const Model* model = instanceBatches[i].model;
+			for (uint32_t j = instanceBatches[i].firstDrawCommand; j < instanceBatches[i].firstDrawCommand + model->primitiveCount; j++) {
+				VkDrawIndexedIndirectCommand drawCommand = drawCommands[j];
+				drawCommand.firstIndex += model->geometryIndexOffset;
+				drawCommand.vertexOffset += static_cast<int32_t>(model->geometryVertexOffset);
+				cullingDrawCommands.push_back({ drawCommand, i });
+			}
+		}
+
+		// Culling resources growth, they also refer to the visible instances buffers
+		uint32_t batchCapacity = gpuCulling.batchCapacity;
+		while (batchCapacity < instanceBatches.size()) {
+			batchCapacity *= 2;
+		}
+		uint32_t drawCommandCapacity = gpuCulling.drawCommandCapacity;
+		while (drawCommandCapacity < cullingDrawCommands.size()) {
+			drawCommandCapacity *= 2;
+		}
+		if (objectBuffersGrown || batchCapacity != gpuCulling.batchCapacity || drawCommandCapacity != gpuCulling.drawCommandCapacity) {
+			logicalDevice.wait();
+			gpuCulling.destroyResources();
+			gpuCulling.createResources(objectBufferCapacity, static_cast<uint32_t>(1 + (2 * shadow.mapCount)), batchCapacity, drawCommandCapacity, visibleInstanceBuffers);
+		}
+	}
+}
+
+void Renderer::createObjectBuffers(uint32_t capacity) {
+	objectBufferCapacity = capacity;
+
+	// Written every frame, they stay mapped
+	objectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	for (Buffer& buffer : objectBuffers) {
+		BufferTools::createStorageBuffer(buffer.buffer, buffer.deviceMemory, sizeof(ObjectStorageBufferObject) * static_cast<VkDeviceSize>(capacity));
+		buffer.map(0, VK_WHOLE_SIZE, &buffer.mappedMemory);
+	}
+
+	visibleInstanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	for (Buffer& buffer : visibleInstanceBuffers) {
+		BufferTools::createStorageBuffer(buffer.buffer, buffer.deviceMemory, sizeof(uint32_t) * static_cast<VkDeviceSize>(capacity) * (1 + (2 * shadow.mapCount)));
+		buffer.map(0, VK_WHOLE_SIZE, &buffer.mappedMemory);
+	}
+
+	depthPrepassDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	shadowDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		createDepthPrepassDescriptorSet(i);
+		createShadowDescriptorSet(i);
+	}
+}
+
+void Renderer::createGeometryBuffers() {
+	// Every model is copied again, the frames in flight must be done with the old buffers
+	logicalDevice.wait();
+	if (geometryVertexBuffer.buffer != VK_NULL_HANDLE) {
+		geometryVertexBuffer.destroy();
+		geometryIndexBuffer.destroy();
+	}
+
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	for (std::unordered_map<std::string, Model>::iterator it = models.begin(); it != models.end(); it++) {
+		Model* model = &it->second;
+		model->geometryVertexOffset = vertexCount;
+		model->geometryIndexOffset = indexCount;
+		vertexCount += model->vertexCount;
+		indexCount += model->indexCount;
+	}
+
+	BufferTools::createBuffer(geometryVertexBuffer.buffer, sizeof(Vertex) * static_cast<VkDeviceSize>(vertexCount), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &geometryVertexBuffer.allocationId);
+	BufferTools::createBuffer(geometryIndexBuffer.buffer, sizeof(uint32_t) * static_cast<VkDeviceSize>(indexCount), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &geometryIndexBuffer.allocationId);
+	for (std::unordered_map<std::string, Model>::iterator it = models.begin(); it != models.end(); it++) {
+		const Model* model = &it->second;
+		BufferTools::copyBuffer(model->vertexBuffer.buffer, geometryVertexBuffer.buffer, sizeof(Vertex) * static_cast<VkDeviceSize>(model->vertexCount), sizeof(Vertex) * static_cast<VkDeviceSize>(model->geometryVertexOffset));
+		BufferTools::copyBuffer(model->indexBuffer.buffer, geometryIndexBuffer.buffer, sizeof(uint32_t) * static_cast<VkDeviceSize>(model->indexCount), sizeof(uint32_t) * static_cast<VkDeviceSize>(model->geometryIndexOffset));
+	}
+	geometryModelCount = models.size();
+}
+
+void Renderer::createObjectDescriptorSet(GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex) {
+	std::vector<DescriptorSet>& descriptorSets = objectDescriptorSets.at(graphicsPipeline);
+	descriptorSets[frameInFlightIndex].init(graphicsPipeline, 0);
+
+	std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+
+	VkDescriptorBufferInfo objectInfo = {};
+	VkDescriptorBufferInfo visibleInstancesInfo = {};
+	VkDescriptorBufferInfo cameraInfo = {};
+	VkDescriptorBufferInfo shadowInfo = {};
+	VkDescriptorBufferInfo lightingInfo = {};
+	VkDescriptorBufferInfo lightsInfo = {};
+	VkDescriptorBufferInfo clustersInfo = {};
+	VkDescriptorImageInfo irradianceInfo = {};
+	VkDescriptorImageInfo prefilterInfo = {};
+	VkDescriptorImageInfo brdfLUTInfo = {};
+	VkDescriptorImageInfo shadowAtlasInfo = {};
+	VkDescriptorBufferInfo timeInfo = {};
+
+	for (size_t i = 0; i < graphicsPipeline->sets[0].bindings.size(); i++) {
+		std::string bindingName = graphicsPipeline->sets[0].bindings[i].name;
+		if (bindingName == "objects") {
+			objectInfo.buffer = objectBuffers.at(frameInFlightIndex).buffer;
+			objectInfo.offset = 0;
+			objectInfo.range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet objectWriteDescriptorSet = {};
+			objectWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			objectWriteDescriptorSet.pNext = nullptr;
+			objectWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			objectWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			objectWriteDescriptorSet.dstArrayElement = 0;
+			objectWriteDescriptorSet.descriptorCount = 1;
+			objectWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			objectWriteDescriptorSet.pImageInfo = nullptr;
+			objectWriteDescriptorSet.pBufferInfo = &objectInfo;
+			objectWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(objectWriteDescriptorSet);
+		}
+		else if (bindingName == "visibleInstances") {
+			visibleInstancesInfo.buffer = visibleInstanceBuffers.at(frameInFlightIndex).buffer;
+			visibleInstancesInfo.offset = 0;
+			visibleInstancesInfo.range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet visibleInstancesWriteDescriptorSet = {};
+			visibleInstancesWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			visibleInstancesWriteDescriptorSet.pNext = nullptr;
+			visibleInstancesWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			visibleInstancesWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			visibleInstancesWriteDescriptorSet.dstArrayElement = 0;
+			visibleInstancesWriteDescriptorSet.descriptorCount = 1;
+			visibleInstancesWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			visibleInstancesWriteDescriptorSet.pImageInfo = nullptr;
+			visibleInstancesWriteDescriptorSet.pBufferInfo = &visibleInstancesInfo;
+			visibleInstancesWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(visibleInstancesWriteDescriptorSet);
+		}
+		else if (bindingName == "camera") {
+			cameraInfo.buffer = frameUniforms.buffer.buffer;
+			cameraInfo.offset = frameUniforms.offset(frameInFlightIndex, cameraUniformOffset);
+			cameraInfo.range = sizeof(CameraUniformBufferObject);
+
+			VkWriteDescriptorSet cameraWriteDescriptorSet = {};
+			cameraWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			cameraWriteDescriptorSet.pNext = nullptr;
+			cameraWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			cameraWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			cameraWriteDescriptorSet.dstArrayElement = 0;
+			cameraWriteDescriptorSet.descriptorCount = 1;
+			cameraWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			cameraWriteDescriptorSet.pImageInfo = nullptr;
+			cameraWriteDescriptorSet.pBufferInfo = &cameraInfo;
+			cameraWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(cameraWriteDescriptorSet);
+		}
+		else if (bindingName == "shadow") {
+			shadowInfo.buffer = frameUniforms.buffer.buffer;
+			shadowInfo.offset = frameUniforms.offset(frameInFlightIndex, shadow.uniformOffset);
+			shadowInfo.range = sizeof(ShadowUniformBufferObject);
+
+			VkWriteDescriptorSet shadowWriteDescriptorSet = {};
+			shadowWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			shadowWriteDescriptorSet.pNext = nullptr;
+			shadowWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			shadowWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			shadowWriteDescriptorSet.dstArrayElement = 0;
+			shadowWriteDescriptorSet.descriptorCount = 1;
+			shadowWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			shadowWriteDescriptorSet.pImageInfo = nullptr;
+			shadowWriteDescriptorSet.pBufferInfo = &shadowInfo;
+			shadowWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(shadowWriteDescriptorSet);
+		}
+		else if (bindingName == "lighting") {
+			lightingInfo.buffer = frameUniforms.buffer.buffer;
+			lightingInfo.offset = frameUniforms.offset(frameInFlightIndex, lightingUniformOffset);
+			lightingInfo.range = sizeof(LightingUniformBufferObject);
+
+			VkWriteDescriptorSet lightingWriteDescriptorSet = {};
+			lightingWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			lightingWriteDescriptorSet.pNext = nullptr;
+			lightingWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			lightingWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			lightingWriteDescriptorSet.dstArrayElement = 0;
+			lightingWriteDescriptorSet.descriptorCount = 1;
+			lightingWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			lightingWriteDescriptorSet.pImageInfo = nullptr;
+			lightingWriteDescriptorSet.pBufferInfo = &lightingInfo;
+			lightingWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(lightingWriteDescriptorSet);
+		}
+		else if (bindingName == "lights") {
+			lightsInfo.buffer = lightBuffers.at(frameInFlightIndex).buffer;
+			lightsInfo.offset = 0;
+			lightsInfo.range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet lightsWriteDescriptorSet = {};
+			lightsWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			lightsWriteDescriptorSet.pNext = nullptr;
+			lightsWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			lightsWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			lightsWriteDescriptorSet.dstArrayElement = 0;
+			lightsWriteDescriptorSet.descriptorCount = 1;
+			lightsWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			lightsWriteDescriptorSet.pImageInfo = nullptr;
+			lightsWriteDescriptorSet.pBufferInfo = &lightsInfo;
+			lightsWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(lightsWriteDescriptorSet);
+		}
+		else if (bindingName == "clusters") {
+			clustersInfo.buffer = clusterBuffers.at(frameInFlightIndex).buffer;
+			clustersInfo.offset = 0;
+			clustersInfo.range = VK_WHOLE_SIZE;
+
+			VkWriteDescriptorSet clustersWriteDescriptorSet = {};
+			clustersWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			clustersWriteDescriptorSet.pNext = nullptr;
+			clustersWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			clustersWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			clustersWriteDescriptorSet.dstArrayElement = 0;
+			clustersWriteDescriptorSet.descriptorCount = 1;
+			clustersWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			clustersWriteDescriptorSet.pImageInfo = nullptr;
+			clustersWriteDescriptorSet.pBufferInfo = &clustersInfo;
+			clustersWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(clustersWriteDescriptorSet);
+		}
+		else if (bindingName == "irradianceMap") {
+			irradianceInfo.sampler = envmap.diffuseIradianceImage.imageSampler;
+			irradianceInfo.imageView = envmap.diffuseIradianceImage.imageView;
+			irradianceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkWriteDescriptorSet irradianceWriteDescriptorSet = {};
+			irradianceWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			irradianceWriteDescriptorSet.pNext = nullptr;
+			irradianceWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			irradianceWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			irradianceWriteDescriptorSet.dstArrayElement = 0;
+			irradianceWriteDescriptorSet.descriptorCount = 1;
+			irradianceWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			irradianceWriteDescriptorSet.pImageInfo = &irradianceInfo;
+			irradianceWriteDescriptorSet.pBufferInfo = nullptr;
+			irradianceWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(irradianceWriteDescriptorSet);
+		}
+		else if (bindingName == "prefilterMap") {
+			prefilterInfo.sampler = envmap.prefilterImage.imageSampler;
+			prefilterInfo.imageView = envmap.prefilterImage.imageView;
+			prefilterInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkWriteDescriptorSet prefilterWriteDescriptorSet = {};
+			prefilterWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			prefilterWriteDescriptorSet.pNext = nullptr;
+			prefilterWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			prefilterWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			prefilterWriteDescriptorSet.dstArrayElement = 0;
+			prefilterWriteDescriptorSet.descriptorCount = 1;
+			prefilterWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			prefilterWriteDescriptorSet.pImageInfo = &prefilterInfo;
+			prefilterWriteDescriptorSet.pBufferInfo = nullptr;
+			prefilterWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(prefilterWriteDescriptorSet);
+		}
+		else if (bindingName == "brdfLUT") {
+			brdfLUTInfo.sampler = envmap.brdfConvolutionImage.imageSampler;
+			brdfLUTInfo.imageView = envmap.brdfConvolutionImage.imageView;
+			brdfLUTInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkWriteDescriptorSet brdfLUTWriteDescriptorSet = {};
+			brdfLUTWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			brdfLUTWriteDescriptorSet.pNext = nullptr;
+			brdfLUTWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			brdfLUTWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			brdfLUTWriteDescriptorSet.dstArrayElement = 0;
+			brdfLUTWriteDescriptorSet.descriptorCount = 1;
+			brdfLUTWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			brdfLUTWriteDescriptorSet.pImageInfo = &brdfLUTInfo;
+			brdfLUTWriteDescriptorSet.pBufferInfo = nullptr;
+			brdfLUTWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(brdfLUTWriteDescriptorSet);
+		}
+		else if (bindingName == "shadowAtlas") {
+			shadowAtlasInfo.sampler = shadow.atlas.imageSampler;
+			shadowAtlasInfo.imageView = shadow.atlas.imageView;
+			shadowAtlasInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+			VkWriteDescriptorSet shadowAtlasWriteDescriptorSet = {};
+			shadowAtlasWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			shadowAtlasWriteDescriptorSet.pNext = nullptr;
+			shadowAtlasWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			shadowAtlasWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			shadowAtlasWriteDescriptorSet.dstArrayElement = 0;
+			shadowAtlasWriteDescriptorSet.descriptorCount = 1;
+			shadowAtlasWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			shadowAtlasWriteDescriptorSet.pImageInfo = &shadowAtlasInfo;
+			shadowAtlasWriteDescriptorSet.pBufferInfo = nullptr;
+			shadowAtlasWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(shadowAtlasWriteDescriptorSet);
+		}
+		else if (bindingName == "time") {
+			timeInfo.buffer = frameUniforms.buffer.buffer;
+			timeInfo.offset = frameUniforms.offset(frameInFlightIndex, timeUniformOffset);
+			timeInfo.range = sizeof(float);
+
+			VkWriteDescriptorSet timeWriteDescriptorSet = {};
+			timeWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			timeWriteDescriptorSet.pNext = nullptr;
+			timeWriteDescriptorSet.dstSet = descriptorSets.at(frameInFlightIndex).descriptorSet;
+			timeWriteDescriptorSet.dstBinding = graphicsPipeline->sets[0].bindings[i].binding.binding;
+			timeWriteDescriptorSet.dstArrayElement = 0;
+			timeWriteDescriptorSet.descriptorCount = 1;
+			timeWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			timeWriteDescriptorSet.pImageInfo = nullptr;
+			timeWriteDescriptorSet.pBufferInfo = &timeInfo;
+			timeWriteDescriptorSet.pTexelBufferView = nullptr;
+
+			writesDescriptorSet.push_back(timeWriteDescriptorSet);
+		}
+	}
+	descriptorSets.at(frameInFlightIndex).update(writesDescriptorSet);
+}
+
+void Renderer::createDepthPrepassDescriptorSet(uint32_t frameInFlightIndex) {
+	depthPrepassDescriptorSets[frameInFlightIndex].init(&depthPrepass.graphicsPipeline, 0);
+
+	VkDescriptorBufferInfo objectInfo = {};
+	objectInfo.buffer = objectBuffers.at(frameInFlightIndex).buffer;
+	objectInfo.offset = 0;
+	objectInfo.range = VK_WHOLE_SIZE;
+
+	VkDescriptorBufferInfo cameraInfo = {};
+	cameraInfo.buffer = frameUniforms.buffer.buffer;
+	cameraInfo.offset = frameUniforms.offset(frameInFlightIndex, cameraUniformOffset);
+	cameraInfo.range = sizeof(CameraUniformBufferObject);
+
+	VkDescriptorBufferInfo visibleInstancesInfo = {};
+	visibleInstancesInfo.buffer = visibleInstanceBuffers.at(frameInFlightIndex).buffer;
+	visibleInstancesInfo.offset = 0;
+	visibleInstancesInfo.range = VK_WHOLE_SIZE;
+
+	std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+
+	VkWriteDescriptorSet objectWriteDescriptorSet = {};
+	objectWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	objectWriteDescriptorSet.pNext = nullptr;
+	objectWriteDescriptorSet.dstSet = depthPrepassDescriptorSets[frameInFlightIndex].descriptorSet;
+	objectWriteDescriptorSet.dstBinding = 0;
+	objectWriteDescriptorSet.dstArrayElement = 0;
+	objectWriteDescriptorSet.descriptorCount = 1;
+	objectWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	objectWriteDescriptorSet.pImageInfo = nullptr;
+	objectWriteDescriptorSet.pBufferInfo = &objectInfo;
+	objectWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(objectWriteDescriptorSet);
+
+	VkWriteDescriptorSet cameraWriteDescriptorSet = {};
+	cameraWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	cameraWriteDescriptorSet.pNext = nullptr;
+	cameraWriteDescriptorSet.dstSet = depthPrepassDescriptorSets[frameInFlightIndex].descriptorSet;
+	cameraWriteDescriptorSet.dstBinding = 1;
+	cameraWriteDescriptorSet.dstArrayElement = 0;
+	cameraWriteDescriptorSet.descriptorCount = 1;
+	cameraWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	cameraWriteDescriptorSet.pImageInfo = nullptr;
+	cameraWriteDescriptorSet.pBufferInfo = &cameraInfo;
+	cameraWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(cameraWriteDescriptorSet);
+
+	VkWriteDescriptorSet visibleInstancesWriteDescriptorSet = {};
+	visibleInstancesWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	visibleInstancesWriteDescriptorSet.pNext = nullptr;
+	visibleInstancesWriteDescriptorSet.dstSet = depthPrepassDescriptorSets[frameInFlightIndex].descriptorSet;
+	visibleInstancesWriteDescriptorSet.dstBinding = 2;
+	visibleInstancesWriteDescriptorSet.dstArrayElement = 0;
+	visibleInstancesWriteDescriptorSet.descriptorCount = 1;
+	visibleInstancesWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	visibleInstancesWriteDescriptorSet.pImageInfo = nullptr;
+	visibleInstancesWriteDescriptorSet.pBufferInfo = &visibleInstancesInfo;
+	visibleInstancesWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(visibleInstancesWriteDescriptorSet);
+
+	depthPrepassDescriptorSets[frameInFlightIndex].update(writesDescriptorSet);
+}
+
+void Renderer::createShadowDescriptorSet(uint32_t frameInFlightIndex) {
+	shadowDescriptorSets[frameInFlightIndex].init(&shadow.graphicsPipeline, 0);
+
+	VkDescriptorBufferInfo objectInfo = {};
+	objectInfo.buffer = objectBuffers.at(frameInFlightIndex).buffer;
+	objectInfo.offset = 0;
+	objectInfo.range = VK_WHOLE_SIZE;
+
+	VkDescriptorBufferInfo shadowInfo = {};
+	shadowInfo.buffer = frameUniforms.buffer.buffer;
+	shadowInfo.offset = frameUniforms.offset(frameInFlightIndex, shadow.uniformOffset);
+	shadowInfo.range = sizeof(ShadowUniformBufferObject);
+
+	VkDescriptorBufferInfo visibleInstancesInfo = {};
+	visibleInstancesInfo.buffer = visibleInstanceBuffers.at(frameInFlightIndex).buffer;
+	visibleInstancesInfo.offset = 0;
+	visibleInstancesInfo.range = VK_WHOLE_SIZE;
+
+	std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+
+	VkWriteDescriptorSet objectWriteDescriptorSet = {};
+	objectWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	objectWriteDescriptorSet.pNext = nullptr;
+	objectWriteDescriptorSet.dstSet = shadowDescriptorSets[frameInFlightIndex].descriptorSet;
+	objectWriteDescriptorSet.dstBinding = 0;
+	objectWriteDescriptorSet.dstArrayElement = 0;
+	objectWriteDescriptorSet.descriptorCount = 1;
+	objectWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	objectWriteDescriptorSet.pImageInfo = nullptr;
+	objectWriteDescriptorSet.pBufferInfo = &objectInfo;
+	objectWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(objectWriteDescriptorSet);
+
+	VkWriteDescriptorSet shadowWriteDescriptorSet = {};
+	shadowWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	shadowWriteDescriptorSet.pNext = nullptr;
+	shadowWriteDescriptorSet.dstSet = shadowDescriptorSets[frameInFlightIndex].descriptorSet;
+	shadowWriteDescriptorSet.dstBinding = 1;
+	shadowWriteDescriptorSet.dstArrayElement = 0;
+	shadowWriteDescriptorSet.descriptorCount = 1;
+	shadowWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	shadowWriteDescriptorSet.pImageInfo = nullptr;
+	shadowWriteDescriptorSet.pBufferInfo = &shadowInfo;
+	shadowWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(shadowWriteDescriptorSet);
+
+	VkWriteDescriptorSet visibleInstancesWriteDescriptorSet = {};
+	visibleInstancesWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	visibleInstancesWriteDescriptorSet.pNext = nullptr;
+	visibleInstancesWriteDescriptorSet.dstSet = shadowDescriptorSets[frameInFlightIndex].descriptorSet;
+	visibleInstancesWriteDescriptorSet.dstBinding = 2;
+	visibleInstancesWriteDescriptorSet.dstArrayElement = 0;
+	visibleInstancesWriteDescriptorSet.descriptorCount = 1;
+	visibleInstancesWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	visibleInstancesWriteDescriptorSet.pImageInfo = nullptr;
+	visibleInstancesWriteDescriptorSet.pBufferInfo = &visibleInstancesInfo;
+	visibleInstancesWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(visibleInstancesWriteDescriptorSet);
+
+	shadowDescriptorSets[frameInFlightIndex].update(writesDescriptorSet);
+}
+
+void Renderer::recreateObjectDescriptorSets() {
+	for (auto& pair : objectDescriptorSets) {
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			pair.second[i].destroy();
+			createObjectDescriptorSet(pair.first, i);
+		}
+	}
+}
+
+void Renderer::createLightBuffers(uint32_t capacity) {
+	lightBufferCapacity = capacity;
+
+	// Written every frame, they stay mapped
+	lightBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	lightClustersDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		BufferTools::createStorageBuffer(lightBuffers[i].buffer, lightBuffers[i].deviceMemory, sizeof(LightStorageBufferObject) * static_cast<VkDeviceSize>(capacity));
+		lightBuffers[i].map(0, VK_WHOLE_SIZE, &lightBuffers[i].mappedMemory);
+		createLightClustersDescriptorSet(i);
+	}
+}
+
+void Renderer::createLightClustersDescriptorSet(uint32_t frameInFlightIndex) {
+	lightClustersDescriptorSets[frameInFlightIndex].init(&lightClustersComputePipeline, 0);
+
+	VkDescriptorBufferInfo lightingInfo = {};
+	lightingInfo.buffer = frameUniforms.buffer.buffer;
+	lightingInfo.offset = frameUniforms.offset(frameInFlightIndex, lightingUniformOffset);
+	lightingInfo.range = sizeof(LightingUniformBufferObject);
+
+	VkDescriptorBufferInfo lightsInfo = {};
+	lightsInfo.buffer = lightBuffers.at(frameInFlightIndex).buffer;
+	lightsInfo.offset = 0;
+	lightsInfo.range = VK_WHOLE_SIZE;
+
+	VkDescriptorBufferInfo clustersInfo = {};
+	clustersInfo.buffer = clusterBuffers.at(frameInFlightIndex).buffer;
+	clustersInfo.offset = 0;
+	clustersInfo.range = VK_WHOLE_SIZE;
+
+	std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+
+	VkWriteDescriptorSet lightingWriteDescriptorSet = {};
+	lightingWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	lightingWriteDescriptorSet.pNext = nullptr;
+	lightingWriteDescriptorSet.dstSet = lightClustersDescriptorSets[frameInFlightIndex].descriptorSet;
+	lightingWriteDescriptorSet.dstBinding = 0;
+	lightingWriteDescriptorSet.dstArrayElement = 0;
+	lightingWriteDescriptorSet.descriptorCount = 1;
+	lightingWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	lightingWriteDescriptorSet.pImageInfo = nullptr;
+	lightingWriteDescriptorSet.pBufferInfo = &lightingInfo;
+	lightingWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(lightingWriteDescriptorSet);
+
+	VkWriteDescriptorSet lightsWriteDescriptorSet = {};
+	lightsWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	lightsWriteDescriptorSet.pNext = nullptr;
+	lightsWriteDescriptorSet.dstSet = lightClustersDescriptorSets[frameInFlightIndex].descriptorSet;
+	lightsWriteDescriptorSet.dstBinding = 1;
+	lightsWriteDescriptorSet.dstArrayElement = 0;
+	lightsWriteDescriptorSet.descriptorCount = 1;
+	lightsWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	lightsWriteDescriptorSet.pImageInfo = nullptr;
+	lightsWriteDescriptorSet.pBufferInfo = &lightsInfo;
+	lightsWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(lightsWriteDescriptorSet);
+
+	VkWriteDescriptorSet clustersWriteDescriptorSet = {};
+	clustersWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	clustersWriteDescriptorSet.pNext = nullptr;
+	clustersWriteDescriptorSet.dstSet = lightClustersDescriptorSets[frameInFlightIndex].descriptorSet;
+	clustersWriteDescriptorSet.dstBinding = 2;
+	clustersWriteDescriptorSet.dstArrayElement = 0;
+	clustersWriteDescriptorSet.descriptorCount = 1;
+	clustersWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	clustersWriteDescriptorSet.pImageInfo = nullptr;
+	clustersWriteDescriptorSet.pBufferInfo = &clustersInfo;
+	clustersWriteDescriptorSet.pTexelBufferView = nullptr;
+	writesDescriptorSet.push_back(clustersWriteDescriptorSet);
+
+	lightClustersDescriptorSets[frameInFlightIndex].update(writesDescriptorSet);
+}
+
+void Renderer::updateBVH() {
+	for (uint32_t batch = 0; batch < static_cast<uint32_t>(instanceBatches.size()); batch++) {
+		const InstanceBatch& instanceBatch = instanceBatches[batch];
+		for (uint32_t i = instanceBatch.firstInstance; i < instanceBatch.firstInstance + instanceBatch.instanceCount; i++) {
+			if (ecs.changedSince<Transform>(instances[i], lastBVHVersion)) {
+				bvh.move(bvhLeaves[entityIndex(instances[i])], instanceBatch.model->aabb.transform(ecs.readComponent<Transform>(instances[i]).worldMatrix));
+				batchBoundsOutdated[batch] = 1;
+
+				// A static caster that starts moving leaves the caches
+				if (!instanceDynamic[i]) {
+					staticCastersChanged = true;
+				}
+				if (instanceDynamic[i] != UINT8_MAX) {
+					instanceDynamic[i] = SHADOW_DYNAMIC_SETTLE_FRAMES;
+				}
+			}
+			else if ((instanceDynamic[i] != 0) && (instanceDynamic[i] != UINT8_MAX)) {
+				// A dynamic caster that settled goes back to the caches
+				instanceDynamic[i]--;
+				if (!instanceDynamic[i]) {
+					staticCastersChanged = true;
+				}
+			}
+		}
+	}
+	lastBVHVersion = ecs.getVersion();
+}
 
+void Renderer::cullInstances() {
+	// World space boxes, as centers and half extents per component
+	auto writeBounds = [](const glm::mat4& worldMatrix, const AABB& aabb, size_t index, size_t count, float* bounds) {
+		glm::vec3 center = glm::vec3(worldMatrix * glm::vec4((aabb.min + aabb.max) * 0.5f, 1.0f));
+		glm::vec3 halfExtent = (aabb.max - aabb.min) * 0.5f;
+		glm::mat3 absoluteMatrix = glm::mat3(glm::abs(glm::vec3(worldMatrix[0])), glm::abs(glm::vec3(worldMatrix[1])), glm::abs(glm::vec3(worldMatrix[2])));
+		glm::vec3 extent = absoluteMatrix * halfExtent;
+
+		bounds[index] = center.x;
+		bounds[count + index] = center.y;
+		bounds[(2 * count) + index] = center.z;
+		bounds[(3 * count) + index] = extent.x;
+		bounds[(4 * count) + index] = extent.y;
+		bounds[(5 * count) + index] = extent.z;
+	};
+
+	size_t count = instances.size();
+	uint32_t viewCount = static_cast<uint32_t>(1 + (2 * shadow.mapCount));
+	visibleInstances.resize(count * viewCount);
+	for (InstanceBatch& instanceBatch : instanceBatches) {
+		instanceBatch.visibleInstanceCounts.assign(viewCount, 0);
+	}
+
+	// Instances, from the spatial index, the camera draws every instance, the shadow maps their dynamic casters and the caches their static casters
+	for (uint32_t view = 0; view < static_cast<uint32_t>(viewFrustums.size()); view++) {
+		if (!culledViews[view]) {
+			continue;
+		}
+		bool dynamicView = view <= static_cast<uint32_t>(shadow.mapCount);
+
+		visibleEntities.clear();
+		bvh.queryFrustum(viewFrustums[view], &visibleEntities);
+		instanceVisibility.assign(count, 0);
+		float minCasterSize = viewMinCasterSizes[view];
+		for (Entity entity : visibleEntities) {
+			const AABB& aabb = bvh.nodes[bvhLeaves[entityIndex(entity)]].objectAABB;
+			if ((minCasterSize == 0.0f) || (glm::length(aabb.max - aabb.min) >= minCasterSize)) {
+				instanceVisibility[instanceIndices[entityIndex(entity)]] = 1;
+			}
+		}
+
+		uint32_t* viewVisibleInstances = visibleInstances.data() + (view * count);
+		for (InstanceBatch& instanceBatch : instanceBatches) {
+			uint32_t& visibleInstanceCount = instanceBatch.visibleInstanceCounts[view];
+			for (uint32_t i = instanceBatch.firstInstance; i < instanceBatch.firstInstance + instanceBatch.instanceCount; i++) {
+				if ((instanceVisibility[i] || instanceBatch.model->skinned) && ((view == 0) || ((instanceDynamic[i] != 0) == dynamicView))) {
+					viewVisibleInstances[instanceBatch.firstInstance + visibleInstanceCount] = i;
+					visibleInstanceCount++;
+				}
+			}
+		}
+	}
+
+	// Primitives of the batches with a single instance visible from the camera
+	primitiveVisibility.assign(viewDrawCommandCount, 1);
+	for (InstanceBatch& instanceBatch : instanceBatches) {
+		Model* model = instanceBatch.model;
+
+		if (instanceBatch.visibleInstanceCounts[0] == 1 && !model->skinned && model->primitiveCount > 1) {
+			const glm::mat4& worldMatrix = ecs.readComponent<Transform>(instances[visibleInstances[instanceBatch.firstInstance]]).worldMatrix;
+
+			cullingBounds.resize(6 * static_cast<size_t>(model->primitiveCount));
+			size_t primitiveIndex = 0;
+			for (Mesh& mesh : model->meshes) {
+				for (Primitive& primitive : mesh.primitives) {
+					writeBounds(worldMatrix, primitive.aabb, primitiveIndex, model->primitiveCount, cullingBounds.data());
+					primitiveIndex++;
+				}
+			}
+			viewFrustums[0].cull(model->primitiveCount, cullingBounds.data(), cullingBounds.data() + model->primitiveCount, cullingBounds.data() + (2 * model->primitiveCount), cullingBounds.data() + (3 * model->primitiveCount), cullingBounds.data() + (4 * model->primitiveCount), cullingBounds.data() + (5 * model->primitiveCount), primitiveVisibility.data() + instanceBatch.firstDrawCommand);
+		}
+	}
+}
+
+void Renderer::fitShadowCascades() {
+	auto const& cameraCamera = ecs.readComponent<Camera>(camera);
+
+	// Splits between the camera near plane and the shadow distance, blending uniform and logarithmic slices, the components past the last cascade hold the distance
+	float nearPlane = cameraCamera.nearPlane;
+	float distance = std::min(cameraCamera.farPlane, SHADOW_CASCADE_DISTANCE);
+	for (int i = 0; i < 4; i++) {
+		float ratio = static_cast<float>(std::min(i + 1, SHADOW_CASCADE_COUNT)) / SHADOW_CASCADE_COUNT;
+		float logarithmicSplit = nearPlane * std::pow(distance / nearPlane, ratio);
+		float uniformSplit = nearPlane + ((distance - nearPlane) * ratio);
+		shadow.cascadeSplits[i] = (SHADOW_CASCADE_SPLIT_LAMBDA * logarithmicSplit) + ((1.0f - SHADOW_CASCADE_SPLIT_LAMBDA) * uniformSplit);
+	}
+
+	glm::mat4 inverseView = glm::inverse(cameraView);
+	float tanHalfFOV = std::tan(glm::radians(cameraCamera.FOV) * 0.5f);
+	float aspectRatio = window->extent.width / static_cast<float>(window->extent.height);
+	for (size_t i = 0; i < shadow.tiles.size(); i++) {
+		ShadowCascade& cascade = shadow.cascades[i];
+		if (cascade.index < 0) {
+			continue;
+		}
+
+		// The first two cascades are fitted every frame, the next ones every 2 then 4 frames, never on the same frame
+		uint32_t period = 1u << std::max(cascade.index - 1, 0);
+		uint32_t tileSize = shadow.tiles[i].scissor.extent.width;
+		cascade.fitted = false;
+		if ((((shadow.cascadeFrame + cascade.index) % period) != 0) && (tileSize == cascade.fittedTileSize) && (cascade.direction == cascade.fittedDirection)) {
+			continue;
+		}
+
+		// Bounding sphere of the slice, its radius does not change when the camera moves or turns
+		float sliceNear = (cascade.index == 0) ? nearPlane : shadow.cascadeSplits[cascade.index - 1];
+		float sliceFar = shadow.cascadeSplits[cascade.index];
+		glm::vec3 sliceCenter = glm::vec3(0.0f, 0.0f, -(sliceNear + sliceFar) * 0.5f);
+		glm::vec3 nearCorner = glm::vec3(sliceNear * tanHalfFOV * aspectRatio, sliceNear * tanHalfFOV, -sliceNear);
+		glm::vec3 farCorner = glm::vec3(sliceFar * tanHalfFOV * aspectRatio, sliceFar * tanHalfFOV, -sliceFar);
+		float radius = std::max(glm::length(nearCorner - sliceCenter), glm::length(farCorner - sliceCenter));
+		glm::vec3 center = glm::vec3(inverseView * glm::vec4(sliceCenter, 1.0f));
+
+		// The volume moves by whole texels of the tile, so the shadow does not shimmer
+		glm::vec3 up = (std::abs(glm::normalize(cascade.direction).y) > 0.99f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::mat4 shadowView = Camera::createLookAtView(glm::vec3(0.0f), cascade.direction, up);
+		float texelSize = (2.0f * radius) / static_cast<float>(tileSize);
+		glm::vec3 lightCenter = glm::vec3(shadowView * glm::vec4(center, 1.0f));
+		lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+		lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+
+		// Casters up to twice the radius between the light and the slice still cast shadows in it
+		glm::mat4 shadowProjection = Camera::createOrthoProjection(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius, -lightCenter.z - (3.0f * radius), -lightCenter.z + radius);
+		cascade.lightSpace = shadowProjection * shadowView;
+		cascade.texelSize = texelSize;
+		cascade.fittedDirection = cascade.direction;
+		cascade.fittedTileSize = tileSize;
+		cascade.fitted = true;
+	}
+	shadow.cascadeFrame++;
+}
+
+void Renderer::sortInstanceBatches(const glm::vec3& position, const glm::vec3& forward) {
+	// Depth of the nearest instance visible from the camera, the bits of a positive float are ordered like it
+	sortKeys.clear();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(instanceBatches.size()); i++) {
+		const InstanceBatch& instanceBatch = instanceBatches[i];
+
+		// Batches with no visible instance, or entirely behind the camera, are drawn last
+		uint32_t depth = (1 << SORT_KEY_DEPTH_BITS) - 1;
+		float nearestDepth = -1.0f;
+		if (gpuDriven) {
+			// Visible instances are only known by the GPU when it culls them, the bounds of the batch are used instead
+			if (batchBoundsOutdated[i]) {
+				batchBounds[i] = AABB();
+				for (uint32_t j = instanceBatch.firstInstance; j < instanceBatch.firstInstance + instanceBatch.instanceCount; j++) {
+					batchBounds[i].merge(bvh.nodes[bvhLeaves[entityIndex(instances[j])]].objectAABB);
+				}
+				batchBoundsOutdated[i] = 0;
+			}
+			if (instanceBatch.instanceCount != 0) {
+				float centerDepth = glm::dot(((batchBounds[i].min + batchBounds[i].max) * 0.5f) - position, forward);
+				float radius = glm::dot((batchBounds[i].max - batchBounds[i].min) * 0.5f, glm::abs(forward));
+				if (centerDepth + radius >= 0.0f) {
+					nearestDepth = std::max(centerDepth - radius, 0.0f);
+				}
+			}
+		}
+		else if (instanceBatch.visibleInstanceCounts[0] != 0) {
+			// Visible instances with their center behind the camera surround it
+			nearestDepth = std::numeric_limits<float>::max();
+			for (uint32_t j = instanceBatch.firstInstance; j < instanceBatch.firstInstance + instanceBatch.visibleInstanceCounts[0]; j++) {
+				const AABB& aabb = bvh.nodes[bvhLeaves[entityIndex(instances[visibleInstances[j]])]].objectAABB;
+				nearestDepth = std::min(nearestDepth, glm::dot(((aabb.min + aabb.max) * 0.5f) - position, forward));
+			}
+			nearestDepth = std::max(nearestDepth, 0.0f);
+		}
+		if (nearestDepth >= 0.0f) {
+			uint32_t depthBits;
+			memcpy(&depthBits, &nearestDepth, sizeof(float));
+			depth = depthBits >> (32 - SORT_KEY_DEPTH_BITS);
+		}
+
+		// The depth prepass only uses one graphics pipeline
+		sortKeys.push_back(drawSortKey(BatchPassType::DEPTH_PREPASS, 0, depth, i));
+		sortKeys.push_back(drawSortKey(BatchPassType::SCENE, instanceBatch.pipelineIndex, depth, i));
+	}
+
+	RadixSort::sort(&sortKeys, &sortScratch);
+
+	// Keys are ordered by pass first
+	size_t batchCount = instanceBatches.size();
+	for (size_t i = 0; i < batchCount; i++) {
+		depthPrepassBatchOrder[i] = static_cast<uint32_t>(sortKeys[i] & ((1 << SORT_KEY_BATCH_BITS) - 1));
+		sceneBatchOrder[i] = static_cast<uint32_t>(sortKeys[batchCount + i] & ((1 << SORT_KEY_BATCH_BITS) - 1));
+	}
+}
+
+void Renderer::drawInstanceBatch(CommandBuffer* commandBuffer, InstanceBatch& instanceBatch, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures, uint32_t view) {
+	// The GPU writes the instance counts of the draw commands
+	if (gpuDriven) {
+		commandBuffer->bindVertexBuffer(geometryVertexBuffer.buffer);
+		commandBuffer->bindIndexBuffer(geometryIndexBuffer.buffer);
+
+		VkBuffer indirectBuffer = gpuCulling.indirectBuffers.at(frameInFlightIndex).buffer;
+		uint32_t firstDrawCommand = (view * viewDrawCommandCount) + instanceBatch.firstDrawCommand;
+		if (bindTextures) {
+			instanceBatch.model->drawIndirect(commandBuffer, graphicsPipeline, frameInFlightIndex, indirectBuffer, firstDrawCommand);
+		}
+		else {
+			vkCmdDrawIndexedIndirect(commandBuffer->commandBuffer, indirectBuffer, firstDrawCommand * sizeof(VkDrawIndexedIndirectCommand), instanceBatch.model->primitiveCount, sizeof(VkDrawIndexedIndirectCommand));
+		}
+		return;
+	}
+
+	uint32_t visibleInstanceCount = instanceBatch.visibleInstanceCounts[view];
+	if (visibleInstanceCount == 0) {
+		return;
+	}
+
+	uint32_t firstInstance = (view * static_cast<uint32_t>(instances.size())) + instanceBatch.firstInstance;
+	const uint8_t* batchPrimitiveVisibility = (view == 0) ? primitiveVisibility.data() + instanceBatch.firstDrawCommand : nullptr;
+	instanceBatch.model->draw(commandBuffer, graphicsPipeline, frameInFlightIndex, bindTextures, firstInstance, visibleInstanceCount, batchPrimitiveVisibility);
+}
+
+void Renderer::drawInstanceBatches(CommandBuffer* commandBuffer, const std::vector<uint32_t>& batchOrder, size_t firstBatch, size_t lastBatch, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, uint32_t view) {
+	if (!gpuDriven) {
+		for (size_t i = firstBatch; i < lastBatch; i++) {
+			drawInstanceBatch(commandBuffer, instanceBatches[batchOrder[i]], graphicsPipeline, frameInFlightIndex, false, view);
+		}
+		return;
+	}
+
+	// Batches whose draw commands follow each other in the indirect buffer are drawn by a single indirect draw
+	commandBuffer->bindVertexBuffer(geometryVertexBuffer.buffer);
+	commandBuffer->bindIndexBuffer(geometryIndexBuffer.buffer);
+
+	VkBuffer indirectBuffer = gpuCulling.indirectBuffers.at(frameInFlightIndex).buffer;
+	uint32_t maxDrawCount = physicalDevice.properties.limits.maxDrawIndirectCount;
+	size_t i = firstBatch;
+	while (i < lastBatch) {
+		uint32_t firstDrawCommand = instanceBatches[batchOrder[i]].firstDrawCommand;
+		uint32_t drawCount = instanceBatches[batchOrder[i]].model->primitiveCount;
+		i++;
+		while ((i < lastBatch) && (instanceBatches[batchOrder[i]].firstDrawCommand == firstDrawCommand + drawCount) && (instanceBatches[batchOrder[i]].model->primitiveCount <= maxDrawCount - drawCount)) {
+			drawCount += instanceBatches[batchOrder[i]].model->primitiveCount;
+			i++;
+		}
+
+		vkCmdDrawIndexedIndirect(commandBuffer->commandBuffer, indirectBuffer, ((view * viewDrawCommandCount) + firstDrawCommand) * sizeof(VkDrawIndexedIndirectCommand), drawCount, sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
+
+void Renderer::updateData(uint32_t frameInFlightIndex) {
 	// Camera
-	auto& cameraCamera = ecs.getComponent<Camera>(camera);
+	auto const& cameraCamera = ecs.readComponent<Camera>(camera);
 
 	CameraUniformBufferObject cubo = {};
-	cameraCamera.view = Camera::createLookAtView(cameraCamera.position, cameraCamera.position + cameraCamera.to, glm::vec3(0.0f, 1.0f, 0.0f));
-	cubo.view = cameraCamera.view;
-	cubo.projection = cameraCamera.projection;
+	cameraView = Camera::createLookAtView(cameraCamera.position, cameraCamera.position + cameraCamera.to, glm::vec3(0.0f, 1.0f, 0.0f));
+	cubo.view = cameraView;
+	cubo.projection = cameraProjection;
 	cubo.position = cameraCamera.position;
 
-	cameraBuffers.at(frameInFlightIndex).map(0, sizeof(CameraUniformBufferObject), &data);
-	memcpy(data, &cubo, sizeof(CameraUniformBufferObject));
-	cameraBuffers.at(frameInFlightIndex).unmap();
+	frameUniforms.write(frameInFlightIndex, cameraUniformOffset, &cubo, sizeof(CameraUniformBufferObject));
 
-	// Lights
-	int dirLightCount = 0;
-	int pointLightCount = 0;
-	int spotLightCount = 0;
-	LightingUniformBufferObject lubo = {};
-	ShadowUniformBufferObject subo = {};
-	for (Entity entity : lights) {
-		auto const& lightLight = ecs.getComponent<Light>(entity);
+	// SSAO, reprojected with the camera of the previous frame
+	ssao.updateData(frameInFlightIndex, cameraView, cameraProjection);
 
-		if (lightLight.type == LightType::DIRECTIONAL) {
-			lubo.dirLightsDirection[dirLightCount] = glm::vec4(lightLight.direction, 0.0f);
-			lubo.dirLightsColor[dirLightCount] = glm::vec4(lightLight.color, 0.0f);
+	// Lights buffers growth, the frames in flight must be done with the old ones
+	uint32_t lightCount = static_cast<uint32_t>(lights.size());
+	if (lightCount > lightBufferCapacity) {
+		uint32_t capacity = lightBufferCapacity;
+		while (capacity < lightCount) {
+			capacity *= 2;
+		}
 
-			glm::vec3 eye = -lightLight.direction;
-			glm::vec3 up = glm::dot(glm::vec3(0.0f, 1.0f, 0.0f), eye) == (glm::length(glm::vec3(0.0f, 1.0f, 0.0f)) * glm::length(eye)) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0);
-			glm::mat4 shadowProjection = Camera::createOrthoProjection(-10.0f, 10.0f, -10.0f, 10.0f, -10.0f, 20.0f);
-			glm::mat4 shadowView = Camera::createLookAtView(eye + cameraCamera.position + (cameraCamera.to * 3.0f), glm::vec3(0.0f, 0.0f, 0.0f) + cameraCamera.position + (cameraCamera.to * 3.0f), up);
-			subo.dirLightSpaces[dirLightCount] = shadowProjection * shadowView;
+		logicalDevice.wait();
+		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			lightBuffers[i].destroy();
+			lightClustersDescriptorSets[i].destroy();
+		}
+		createLightBuffers(capacity);
+		recreateObjectDescriptorSets();
+	}
 
+	// Lights, directional lights first as they are not binned into clusters
+	uint32_t dirLightCount = 0;
+	for (Entity entity : lights) {
+		if (ecs.readComponent<Light>(entity).type == LightType::DIRECTIONAL) {
 			dirLightCount++;
 		}
-		else if (lightLight.type == LightType::POINT) {
-			lubo.pointLightsPosition[pointLightCount] = glm::vec4(lightLight.position, 0.0f);
-			lubo.pointLightsColor[pointLightCount] = glm::vec4(lightLight.color, 0.0f);
+	}
 
-			pointLightCount++;
+	LightingUniformBufferObject lubo = {};
+	ShadowUniformBufferObject subo = {};
+	LightStorageBufferObject* lightObjects = static_cast<LightStorageBufferObject*>(lightBuffers.at(frameInFlightIndex).mappedMemory);
+	uint32_t dirLightIndex = 0;
+	uint32_t lightIndex = dirLightCount;
+	int shadowMapIndex = 0;
+	shadow.coverages.clear();
+	for (ShadowCascade& cascade : shadow.cascades) {
+		cascade.index = -1;
+	}
+	for (Entity entity : lights) {
+		auto const& lightLight = ecs.readComponent<Light>(entity);
+
+		LightStorageBufferObject lightObject = {};
+		lightObject.direction = glm::vec4(lightLight.direction, static_cast<float>(lightLight.type));
+		lightObject.color = glm::vec4(lightLight.color, -1.0f);
+
+		// Distance at which the brightest channel falls under the cutoff
+		float intensity = std::max(lightLight.color.x, std::max(lightLight.color.y, lightLight.color.z));
+		float range = std::sqrt(intensity / LIGHT_INTENSITY_CUTOFF);
+
+		glm::mat4 lightSpace = glm::mat4(1.0f);
+		if (lightLight.type == LightType::POINT) {
+			lightObject.position = glm::vec4(lightLight.position, range);
 		}
 		else if (lightLight.type == LightType::SPOT) {
-			lubo.spotLightsPosition[spotLightCount] = glm::vec4(lightLight.position, 0.0f);
-			lubo.spotLightsDirection[spotLightCount] = glm::vec4(lightLight.direction, 0.0f);
-			lubo.spotLightsColor[spotLightCount] = glm::vec4(lightLight.color, 0.0f);
-			lubo.spotLightsCutoffs[spotLightCount] = glm::vec4(glm::cos(glm::radians(lightLight.cutoffs.x)), glm::cos(glm::radians(lightLight.cutoffs.y)), 0.0f, 0.0f);
+			lightObject.position = glm::vec4(lightLight.position, range);
+			lightObject.cutoffs = glm::vec4(glm::cos(glm::radians(lightLight.cutoffs.x)), glm::cos(glm::radians(lightLight.cutoffs.y)), 0.0f, 0.0f);
 
 			glm::vec3 eye = lightLight.position;
 			glm::vec3 to = lightLight.direction;
 			glm::vec3 up = glm::dot(glm::vec3(0.0f, 1.0f, 0.0f), -to) == (glm::length(glm::vec3(0.0f, 1.0f, 0.0f)) * glm::length(-to)) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0);
-			glm::mat4 shadowProjection = Camera::createPerspectiveProjection(120.0f, SHADOWMAP_WIDTH / static_cast<float>(SHADOWMAP_HEIGHT), 0.1f, 20.0f, false);
+			glm::mat4 shadowProjection = Camera::createPerspectiveProjection(120.0f, 1.0f, 0.1f, range, false);
 			glm::mat4 shadowView = Camera::createLookAtView(eye, eye + to, up);
-			subo.spotLightSpaces[spotLightCount] = shadowProjection * shadowView;
-
-			spotLightCount++;
+			lightSpace = shadowProjection * shadowView;
 		}
-	}
 
-	lubo.numLights.x = static_cast<float>(dirLightCount);
-	lubo.numLights.y = static_cast<float>(pointLightCount);
-	lubo.numLights.z = static_cast<float>(spotLightCount);
+		// Shadow maps are created in the order of the shadowed lights, directional lights have one per cascade
+		if (lightLight.type == LightType::DIRECTIONAL || lightLight.type == LightType::SPOT) {
+			int lightMapCount = (lightLight.type == LightType::DIRECTIONAL) ? SHADOW_CASCADE_COUNT : 1;
+			if (shadowMapIndex + lightMapCount <= shadow.mapCount) {
+				lightObject.color.w = static_cast<float>(shadowMapIndex);
+
+				// Screen coverage of the light, cascades cover the whole view and are fitted once their tiles are known
+				if (lightLight.type == LightType::DIRECTIONAL) {
+					for (int cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++) {
+						shadow.cascades[shadowMapIndex + cascade].index = cascade;
+						shadow.cascades[shadowMapIndex + cascade].direction = lightLight.direction;
+						shadow.coverages.push_back(1.0f);
+					}
+				}
+				else {
+					subo.lightSpaces[shadowMapIndex] = lightSpace;
+
+					float coverage = 1.0f;
+					float distance = glm::length(lightLight.position - cameraCamera.position);
+					if (distance > range) {
+						coverage = std::min(range / (distance * std::tan(glm::radians(cameraCamera.FOV) * 0.5f)), 1.0f);
+					}
+					shadow.coverages.push_back(coverage);
+				}
+			}
+			shadowMapIndex += lightMapCount;
+		}
 
-	subo.numLights.x = static_cast<float>(dirLightCount);
-	subo.numLights.y = static_cast<float>(pointLightCount);
-	subo.numLights.z = static_cast<float>(spotLightCount);
+		if (lightLight.type == LightType::DIRECTIONAL) {
+			lightObjects[dirLightIndex] = lightObject;
+			dirLightIndex++;
+		}
+		else {
+			lightObjects[lightIndex] = lightObject;
+			lightIndex++;
+		}
+	}
 
-	lightingBuffers.at(frameInFlightIndex).map(0, sizeof(LightingUniformBufferObject), &data);
-	memcpy(data, &lubo, sizeof(LightingUniformBufferObject));
-	lightingBuffers.at(frameInFlightIndex).unmap();
+	// Shadow maps tiles, as offset and size in atlas coordinates, then the cascades snapped to the texels of their tile
+	shadow.packAtlas();
+	fitShadowCascades();
+	for (size_t i = 0; i < shadow.tiles.size(); i++) {
+		const VkViewport& tile = shadow.tiles[i].viewport;
+		subo.atlasRects[i] = glm::vec4(tile.x, tile.y, tile.width, tile.height) / static_cast<float>(shadow.atlasSize);
+		if (shadow.cascades[i].index >= 0) {
+			subo.lightSpaces[i] = shadow.cascades[i].lightSpace;
+		}
+	}
+	subo.cascadeSplits = shadow.cascadeSplits;
+
+	// Clusters slice the view exponentially between the camera planes
+	float depthRatio = std::log(cameraCamera.farPlane / cameraCamera.nearPlane);
+	lubo.view = cameraView;
+	lubo.inverseProjection = glm::inverse(cameraProjection);
+	lubo.clusterDepth = glm::vec4(cameraCamera.nearPlane, cameraCamera.farPlane, CLUSTER_Z / depthRatio, (CLUSTER_Z * std::log(cameraCamera.nearPlane)) / depthRatio);
+	lubo.screenSize = glm::vec4(static_cast<float>(window->extent.width), static_cast<float>(window->extent.height), 0.0f, 0.0f);
+	lubo.lightCounts = glm::uvec4(dirLightCount, lightCount, 0, 0);
+
+	// Culling volumes of the camera, of each shadow map then of each shadow map cache
+	int shadowMapCount = static_cast<int>(shadow.tiles.size());
+	viewFrustums.resize(1 + (2 * shadow.mapCount));
+	culledViews.assign(viewFrustums.size(), 0);
+	viewMinCasterSizes.assign(viewFrustums.size(), 0.0f);
+	viewFrustums[0].init(cameraProjection * cameraView);
+	culledViews[0] = 1;
+	for (int i = 0; i < shadowMapCount; i++) {
+		viewFrustums[1 + i].init(subo.lightSpaces[i]);
+		// Casters between the light and the volume still cast shadows in it
+		viewFrustums[1 + i].removeNearPlane();
+		viewFrustums[1 + shadow.mapCount + i] = viewFrustums[1 + i];
+
+		// The texels of the far cascades are large, small casters barely cover them
+		if (shadow.cascades[i].index >= 0) {
+			viewMinCasterSizes[1 + i] = SHADOW_CASCADE_MIN_CASTER_TEXELS * shadow.cascades[i].texelSize;
+			viewMinCasterSizes[1 + shadow.mapCount + i] = viewMinCasterSizes[1 + i];
+		}
+	}
 
-	shadow.buffers.at(frameInFlightIndex).map(0, sizeof(ShadowUniformBufferObject), &data);
-	memcpy(data, &subo, sizeof(ShadowUniformBufferObject));
-	shadow.buffers.at(frameInFlightIndex).unmap();
+	frameUniforms.write(frameInFlightIndex, lightingUniformOffset, &lubo, sizeof(LightingUniformBufferObject));
+	frameUniforms.write(frameInFlightIndex, shadow.uniformOffset, &subo, sizeof(ShadowUniformBufferObject));
 
 	// Time
 	float time = static_cast<float>(glfwGetTime());
-	timeBuffers.at(frameInFlightIndex).map(0, sizeof(float), &data);
-	memcpy(data, &time, sizeof(double));
-	timeBuffers.at(frameInFlightIndex).unmap();
+	frameUniforms.write(frameInFlightIndex, timeUniformOffset, &time, sizeof(float));
 
-	// Renderables
-	for (Entity object : entities) {
-		auto const& objectTransform = ecs.getComponent<Transform>(object);
-		auto& objectRenderable = ecs.getComponent<Renderable>(object);
+	// Instances, rebuilt when renderables are added or removed
+	if (ecs.view<Renderable, const Transform>().entities.getModificationCount() != instancesModificationCount) {
+		buildInstanceBatches();
+	}
 
-		if (graphicsPipelines.at(objectRenderable.lookupString).sets.size() != 0) {
-			ObjectUniformBufferObject oubo = {};
-			glm::mat4 translate = glm::translate(glm::mat4(1.0f), objectTransform.position);
-			glm::mat4 rotateX = glm::rotate(glm::mat4(1.0f), glm::radians(objectTransform.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-			glm::mat4 rotateY = glm::rotate(glm::mat4(1.0f), glm::radians(objectTransform.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-			glm::mat4 rotateZ = glm::rotate(glm::mat4(1.0f), glm::radians(objectTransform.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-			glm::mat4 scale = glm::scale(glm::mat4(1.0f), objectTransform.scale);
-			oubo.model = translate * rotateX * rotateY * rotateZ * scale;
+	// Every instance when the layout changed, otherwise only the ones whose transform changed since the last update of this frame in flight
+	if (!instances.empty()) {
+		bool layoutChanged = lastInstancesLayouts[frameInFlightIndex] != instancesLayout;
+		uint32_t lastTransformVersion = lastTransformVersions[frameInFlightIndex];
 
-			objectRenderable.buffers.at(frameInFlightIndex).map(0, sizeof(ObjectUniformBufferObject), &data);
-			memcpy(data, &oubo, sizeof(ObjectUniformBufferObject));
-			objectRenderable.buffers.at(frameInFlightIndex).unmap();
+		ObjectStorageBufferObject* objects = static_cast<ObjectStorageBufferObject*>(objectBuffers.at(frameInFlightIndex).mappedMemory);
+		for (size_t i = 0; i < instances.size(); i++) {
+			if (layoutChanged || ecs.changedSince<Transform>(instances[i], lastTransformVersion)) {
+				objects[i].model = ecs.readComponent<Transform>(instances[i]).worldMatrix;
+			}
 		}
 	}
-}
 
-void Renderer::recordRenderingCommands(uint32_t frameInFlightIndex, uint32_t framebufferIndex) {
-	currentPipeline = nullptr;
-
-	RenderPass* sceneRenderPass = &renderPasses.at("scene");
-	RenderPass* postRenderPass = &renderPasses.at("post");
+	// Shadow map caches whose static casters moved, or whose light space or tile changed, are drawn again
+	updateBVH();
+	shadow.invalidateCaches(subo.lightSpaces, staticCastersChanged);
+	staticCastersChanged = false;
+	for (uint32_t staleCache : shadow.staleCaches) {
+		culledViews[1 + shadow.mapCount + staleCache] = 1;
+	}
+	for (uint32_t drawnTile : shadow.drawnTiles) {
+		culledViews[1 + drawnTile] = 1;
+	}
 
-	renderingCommandPools[frameInFlightIndex].reset();
-	renderingCommandBuffers[frameInFlightIndex].begin();
+	if (!instances.empty()) {
+		if (gpuDriven) {
+			// Bounds of every instance when the layout changed, otherwise only of the ones whose transform changed, dynamic casters settle without moving
+			bool layoutChanged = lastInstancesLayouts[frameInFlightIndex] != instancesLayout;
+			uint32_t lastTransformVersion = lastTransformVersions[frameInFlightIndex];
+
+			CullingInstance* cullingInstances = static_cast<CullingInstance*>(gpuCulling.instanceBuffers.at(frameInFlightIndex).mappedMemory);
+			for (uint32_t i = 0; i < static_cast<uint32_t>(instanceBatches.size()); i++) {
+				const InstanceBatch& instanceBatch = instanceBatches[i];
+				for (uint32_t j = instanceBatch.firstInstance; j < instanceBatch.firstInstance + instanceBatch.instanceCount; j++) {
+					CullingInstance& cullingInstance = cullingInstances[j];
+					if (layoutChanged || ecs.changedSince<Transform>(instances[j], lastTransformVersion)) {
+						const AABB& aabb = bvh.nodes[bvhLeaves[entityIndex(instances[j])]].objectAABB;
+						cullingInstance.center = glm::vec4((aabb.min + aabb.max) * 0.5f, 0.0f);
+						cullingInstance.extent = glm::vec4((aabb.max - aabb.min) * 0.5f, 0.0f);
+						cullingInstance.batch = i;
+						cullingInstance.batchFirstInstance = instanceBatch.firstInstance;
+						cullingInstance.alwaysVisible = instanceBatch.model->skinned ? 1 : 0;
+					}
+					cullingInstance.dynamicCaster = (instanceDynamic[j] != 0) ? 1 : 0;
+				}
+			}
 
-	// Depth prepass
-	depthPrepass.renderPass.begin(&renderingCommandBuffers[frameInFlightIndex], depthPrepass.framebuffers[frameInFlightIndex].framebuffer, window->extent);
-	depthPrepass.graphicsPipeline.bind(&renderingCommandBuffers[frameInFlightIndex]);
+			// Views, the camera draws every instance, the shadow maps their dynamic casters and the caches their static casters
+			CullingView* cullingViews = static_cast<CullingView*>(gpuCulling.viewBuffers.at(frameInFlightIndex).mappedMemory);
+			for (uint32_t view = 0; view < static_cast<uint32_t>(viewFrustums.size()); view++) {
+				CullingCasters casters = (view == 0) ? CullingCasters::ALL : ((view <= static_cast<uint32_t>(shadow.mapCount)) ? CullingCasters::DYNAMIC : CullingCasters::STATIC);
+				GPUCulling::writeView(&cullingViews[view], viewFrustums[view], culledViews[view], viewMinCasterSizes[view], casters);
+			}
 
-	for (Entity object : entities) {
-		auto& objectRenderable = ecs.getComponent<Renderable>(object);
+			// Draw commands, only written again when the layout changed
+			if (layoutChanged) {
+				memcpy(gpuCulling.drawCommandBuffers.at(frameInFlightIndex).mappedMemory, cullingDrawCommands.data(), sizeof(CullingDrawCommand) * cullingDrawCommands.size());
+			}
+		}
+		else {
+			// Frustum culling
+			cullInstances();
 
-		objectRenderable.depthPrepassDescriptorSets.at(frameInFlightIndex).bind(&renderingCommandBuffers[frameInFlightIndex], 0);
+			memcpy(visibleInstanceBuffers.at(frameInFlightIndex).mappedMemory, visibleInstances.data(), sizeof(uint32_t) * visibleInstances.size());
+		}
 
-		models.at(objectRenderable.modelPath).draw(&renderingCommandBuffers[frameInFlightIndex], &depthPrepass.graphicsPipeline, frameInFlightIndex, false);
+		// Draw order
+		sortInstanceBatches(cameraCamera.position, cameraCamera.to);
 	}
+	lastInstancesLayouts[frameInFlightIndex] = instancesLayout;
+	lastTransformVersions[frameInFlightIndex] = ecs.getVersion();
+}
 
-	depthPrepass.renderPass.end(&renderingCommandBuffers[frameInFlightIndex]);
-
-	// Shadow
-	int lightIndex = 0;
-	for (Entity light : lights) {
-		auto const& lightLight = ecs.getComponent<Light>(light);
-
-		if (lightLight.type == LightType::DIRECTIONAL || lightLight.type == LightType::SPOT) {
-			shadow.renderPass.begin(&renderingCommandBuffers[frameInFlightIndex], shadow.framebuffers[lightIndex].at(frameInFlightIndex).framebuffer, { SHADOWMAP_WIDTH, SHADOWMAP_HEIGHT });
+void Renderer::recordBatchPass(CommandBuffer* commandBuffer, const BatchPass& batchPass, size_t firstBatch, size_t lastBatch, bool lastChunk, uint32_t frameInFlightIndex) {
+	// Secondary command buffers do not inherit any state, each chunk binds its own
+	commandBuffer->begin(batchPass.renderPass->renderPass, batchPass.framebuffer);
 
-			shadow.graphicsPipeline.bind(&renderingCommandBuffers[frameInFlightIndex]);
-			shadow.graphicsPipeline.pushConstant(&renderingCommandBuffers[frameInFlightIndex], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(int), &lightIndex);
+	if (batchPass.type == BatchPassType::DEPTH_PREPASS) {
+		depthPrepass.graphicsPipeline.bind(commandBuffer);
+		depthPrepassDescriptorSets.at(frameInFlightIndex).bind(commandBuffer, 0);
 
-			for (Entity object : entities) {
-				auto& objectRenderable = ecs.getComponent<Renderable>(object);
+		drawInstanceBatches(commandBuffer, *batchPass.batchOrder, firstBatch, lastBatch, &depthPrepass.graphicsPipeline, frameInFlightIndex, batchPass.view);
+	}
+	else if (batchPass.type == BatchPassType::SHADOW_CACHE || batchPass.type == BatchPassType::SHADOW) {
+		shadow.graphicsPipeline.bind(commandBuffer);
+		shadowDescriptorSets.at(frameInFlightIndex).bind(commandBuffer, 0);
+
+		// The cache only draws the stale tiles, cleared by the first chunk, the atlas draws the dynamic casters of the drawn tiles over the copy of the cache
+		bool cache = batchPass.type == BatchPassType::SHADOW_CACHE;
+		uint32_t tileCount = static_cast<uint32_t>(cache ? shadow.staleCaches.size() : shadow.drawnTiles.size());
+		if (cache && (firstBatch == 0) && (tileCount != 0)) {
+			VkClearAttachment clearAttachment = {};
+			clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			clearAttachment.colorAttachment = 0;
+			clearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+			std::vector<VkClearRect> clearRects;
+			for (uint32_t staleCache : shadow.staleCaches) {
+				clearRects.push_back({ shadow.tiles[staleCache].scissor, 0, 1 });
+			}
+			vkCmdClearAttachments(commandBuffer->commandBuffer, 1, &clearAttachment, static_cast<uint32_t>(clearRects.size()), clearRects.data());
+		}
 
-				objectRenderable.shadowDescriptorSets.at(frameInFlightIndex).bind(&renderingCommandBuffers[frameInFlightIndex], 0);
+		// Every shadow map is drawn in its tile of the atlas
+		for (uint32_t tile = 0; tile < tileCount; tile++) {
+			int lightIndex = static_cast<int>(cache ? shadow.staleCaches[tile] : shadow.drawnTiles[tile]);
+			shadow.tiles[lightIndex].setViewport(commandBuffer);
+			shadow.tiles[lightIndex].setScissor(commandBuffer);
+			shadow.graphicsPipeline.pushConstant(commandBuffer, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(int), &lightIndex);
 
-				models.at(objectRenderable.modelPath).draw(&renderingCommandBuffers[frameInFlightIndex], &shadow.graphicsPipeline, frameInFlightIndex, false);
+			drawInstanceBatches(commandBuffer, *batchPass.batchOrder, firstBatch, lastBatch, &shadow.graphicsPipeline, frameInFlightIndex, batchPass.view + lightIndex);
+		}
+	}
+	else {
+		// Batches are sorted by graphics pipeline, the state tracker drops the binds of the following ones
+		for (size_t i = firstBatch; i < lastBatch; i++) {
+			InstanceBatch& instanceBatch = instanceBatches[(*batchPass.batchOrder)[i]];
+			instanceBatch.graphicsPipeline->bind(commandBuffer);
+			if (instanceBatch.graphicsPipeline->sets.size() != 0) {
+				objectDescriptorSets.at(instanceBatch.graphicsPipeline).at(frameInFlightIndex).bind(commandBuffer, 0);
 			}
 
-			shadow.renderPass.end(&renderingCommandBuffers[frameInFlightIndex]);
+			drawInstanceBatch(commandBuffer, instanceBatch, instanceBatch.graphicsPipeline, frameInFlightIndex, true, batchPass.view);
+		}
 
-			lightIndex++;
+		// The skybox is drawn last, after every chunk of the scene
+		if (lastChunk) {
+			skyboxGraphicsPipeline.bind(commandBuffer);
+			skyboxDescriptorSets.at(frameInFlightIndex).bind(commandBuffer, 0);
+
+			envmap.draw(commandBuffer);
 		}
 	}
 
-	// Scene
-	sceneRenderPass->begin(&renderingCommandBuffers[frameInFlightIndex], sceneFramebuffers[frameInFlightIndex].framebuffer, window->extent);
-	for (Entity object : entities) {
-		auto& objectRenderable = ecs.getComponent<Renderable>(object);
+	commandBuffer->end();
+}
 
-		if (currentPipeline != objectRenderable.graphicsPipeline) {
-			objectRenderable.graphicsPipeline->bind(&renderingCommandBuffers[frameInFlightIndex]);
+void Renderer::recordRenderingCommands(uint32_t frameInFlightIndex, uint32_t framebufferIndex) {
+	RenderPass* sceneRenderPass = &renderPasses.at("scene");
 
-			currentPipeline = objectRenderable.graphicsPipeline;
+	batchPasses.clear();
+	batchPasses.push_back({ BatchPassType::DEPTH_PREPASS, &depthPrepass.renderPass, depthPrepass.framebuffers[frameInFlightIndex].framebuffer, window->extent, 0, &depthPrepassBatchOrder });
+	batchPasses.push_back({ BatchPassType::SHADOW_CACHE, &shadow.cacheRenderPass, shadow.cacheFramebuffer.framebuffer, { shadow.atlasSize, shadow.atlasSize }, static_cast<uint32_t>(1 + shadow.mapCount), &shadowBatchOrder });
+	batchPasses.push_back({ BatchPassType::SHADOW, &shadow.renderPass, shadow.framebuffer.framebuffer, { shadow.atlasSize, shadow.atlasSize }, 1, &shadowBatchOrder });
+	batchPasses.push_back({ BatchPassType::SCENE, sceneRenderPass, sceneFramebuffers[frameInFlightIndex].framebuffer, window->extent, 0, &sceneBatchOrder });
+
+	// Secondary command buffers, created when more tasks than ever are needed
+	uint32_t chunkCount = std::max(static_cast<uint32_t>((instanceBatches.size() + RECORDING_CHUNK_SIZE - 1) / RECORDING_CHUNK_SIZE), 1u);
+	uint32_t taskCount = static_cast<uint32_t>(batchPasses.size()) * chunkCount;
+	recordingChunkCount = chunkCount;
+	std::vector<CommandPool>& frameRecordingCommandPools = recordingCommandPools[frameInFlightIndex];
+	std::vector<CommandBuffer>& frameRecordingCommandBuffers = recordingCommandBuffers[frameInFlightIndex];
+	if (frameRecordingCommandPools.size() < taskCount) {
+		size_t previousTaskCount = frameRecordingCommandPools.size();
+		frameRecordingCommandPools.resize(taskCount);
+		frameRecordingCommandBuffers.resize(taskCount);
+		for (size_t i = previousTaskCount; i < taskCount; i++) {
+			frameRecordingCommandPools[i].init();
+			frameRecordingCommandBuffers[i].init(&frameRecordingCommandPools[i], VK_COMMAND_BUFFER_LEVEL_SECONDARY);
 		}
+	}
 
-		if (objectRenderable.graphicsPipeline->sets.size() != 0) {
-			objectRenderable.descriptorSets.at(frameInFlightIndex).bind(&renderingCommandBuffers[frameInFlightIndex], 0);
-		}
+	// A command pool is only used by the task owning it, so tasks record without locking
+	threadPool->parallelFor(taskCount, [&](uint32_t task) {
+		uint32_t chunk = task % chunkCount;
+		size_t firstBatch = static_cast<size_t>(chunk) * RECORDING_CHUNK_SIZE;
+		size_t lastBatch = std::min(firstBatch + RECORDING_CHUNK_SIZE, instanceBatches.size());
+
+		frameRecordingCommandPools[task].reset();
+		recordBatchPass(&frameRecordingCommandBuffers[task], batchPasses[task / chunkCount], firstBatch, lastBatch, chunk == chunkCount - 1, frameInFlightIndex);
+	});
 
-		models.at(objectRenderable.modelPath).draw(&renderingCommandBuffers[frameInFlightIndex], objectRenderable.graphicsPipeline, frameInFlightIndex, true);
+	renderingCommandPools[frameInFlightIndex].reset();
+	renderingCommandBuffers[frameInFlightIndex].begin();
+
+	// Culling and draw commands, before the passes reading them
+	if (gpuDriven && !cullingDrawCommands.empty()) {
+		gpuCulling.dispatch(&renderingCommandBuffers[frameInFlightIndex], frameInFlightIndex, static_cast<uint32_t>(instances.size()), static_cast<uint32_t>(1 + (2 * shadow.mapCount)), static_cast<uint32_t>(instanceBatches.size()), static_cast<uint32_t>(cullingDrawCommands.size()), visibleInstanceBuffers.at(frameInFlightIndex).buffer);
 	}
-	skyboxGraphicsPipeline.bind(&renderingCommandBuffers[frameInFlightIndex]);
-	skyboxDescriptorSets.at(frameInFlightIndex).bind(&renderingCommandBuffers[frameInFlightIndex], 0);
 
-	envmap.draw(&renderingCommandBuffers[frameInFlightIndex]);
+	// Light clusters, binned before the scene reads them
+	lightClustersComputePipeline.bind(&renderingCommandBuffers[frameInFlightIndex]);
+	lightClustersDescriptorSets.at(frameInFlightIndex).bind(&renderingCommandBuffers[frameInFlightIndex], 0);
+	lightClustersComputePipeline.dispatch(&renderingCommandBuffers[frameInFlightIndex], ((CLUSTER_X * CLUSTER_Y * CLUSTER_Z) + 63) / 64, 1, 1);
+
+	VkBufferMemoryBarrier clustersBarrier = {};
+	clustersBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	clustersBarrier.pNext = nullptr;
+	clustersBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	clustersBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	clustersBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	clustersBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	clustersBarrier.buffer = clusterBuffers.at(frameInFlightIndex).buffer;
+	clustersBarrier.offset = 0;
+	clustersBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(renderingCommandBuffers[frameInFlightIndex].commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 1, &clustersBarrier, 0, nullptr);
+
+	// Depth prepass, shadow maps, scene, SSAO and post-processing
+	swapchainImageIndex = framebufferIndex;
+	renderGraph.execute(&renderingCommandBuffers[frameInFlightIndex], frameInFlightIndex);
 
-	sceneRenderPass->end(&renderingCommandBuffers[frameInFlightIndex]);
+	renderingCommandBuffers[frameInFlightIndex].end();
+}
 
-	// SSAO
-	ssao.draw(&renderingCommandBuffers[frameInFlightIndex], frameInFlightIndex);
+void Renderer::executeBatchPass(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex, size_t batchPassIndex) {
+	const BatchPass& batchPass = batchPasses[batchPassIndex];
+	batchPass.renderPass->begin(commandBuffer, batchPass.framebuffer, batchPass.extent, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-	// Post-processing
-	postRenderPass->begin(&renderingCommandBuffers[frameInFlightIndex], postFramebuffers[framebufferIndex].framebuffer, window->extent);
-	graphicsPipelines.at("post").bind(&renderingCommandBuffers[frameInFlightIndex]);
-	postDescriptorSet.bind(&renderingCommandBuffers[frameInFlightIndex], 0);
+	executedCommandBuffers.clear();
+	for (uint32_t chunk = 0; chunk < recordingChunkCount; chunk++) {
+		executedCommandBuffers.push_back(recordingCommandBuffers[frameInFlightIndex][(batchPassIndex * recordingChunkCount) + chunk].commandBuffer);
+	}
+	commandBuffer->executeCommands(executedCommandBuffers);
 
-	vkCmdDraw(renderingCommandBuffers[frameInFlightIndex].commandBuffer, 3, 1, 0, 0);
+	batchPass.renderPass->end(commandBuffer);
+}
 
-	postRenderPass->end(&renderingCommandBuffers[frameInFlightIndex]);
+void Renderer::createRenderGraph() {
+	uint32_t depth = renderGraph.createImage("depth", &depthPrepass.image, window->extent.width, window->extent.height, physicalDevice.depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+	uint32_t normals = renderGraph.createImage("normals", &depthPrepass.normalImage, window->extent.width, window->extent.height, DEPTH_PREPASS_NORMAL_FORMAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	uint32_t scene = renderGraph.createImage("scene", &colorImage, window->extent.width, window->extent.height, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	uint32_t shadowAtlas = renderGraph.importImage("shadowAtlas", &shadow.atlas, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+	uint32_t shadowCache = renderGraph.importImage("shadowCache", &shadow.cache, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+
+	// Batch passes are the depth prepass, the shadow cache, the shadow atlas and the scene, the depth attachments are left read-only
+	uint32_t pass = renderGraph.addPass("depthPrepass", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { executeBatchPass(commandBuffer, frameInFlightIndex, 0); });
+	renderGraph.addWrite(pass, depth, true, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+	renderGraph.addWrite(pass, normals, true, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+	// Static casters are only drawn in the stale tiles of the cache, the drawn tiles of the atlas start as a copy of the cache and the others keep their last content
+	pass = renderGraph.addPass("shadowCache", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
+		if (!shadow.staleCaches.empty()) {
+			executeBatchPass(commandBuffer, frameInFlightIndex, 1);
+		}
+	});
+	renderGraph.addWrite(pass, shadowCache, false, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
 
-	renderingCommandBuffers[frameInFlightIndex].end();
+	pass = renderGraph.addPass("shadowCopy", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { shadow.copyCache(commandBuffer); });
+	renderGraph.addRead(pass, shadowCache, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+	renderGraph.addWrite(pass, shadowAtlas, false, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	pass = renderGraph.addPass("shadows", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
+		if (!shadow.drawnTiles.empty()) {
+			executeBatchPass(commandBuffer, frameInFlightIndex, 2);
+		}
+	});
+	renderGraph.addWrite(pass, shadowAtlas, false, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+	pass = renderGraph.addPass("scene", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { executeBatchPass(commandBuffer, frameInFlightIndex, batchPasses.size() - 1); });
+	renderGraph.addRead(pass, depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT);
+	renderGraph.addRead(pass, shadowAtlas, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph.addWrite(pass, scene, true, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+	uint32_t ssaoBlurred = ssao.addToRenderGraph(&renderGraph, fullscreenViewport, depth, normals);
+
+	// Post-processing writes the swapchain image, synchronized with its acquisition by the render pass
+	pass = renderGraph.addPass("post", true, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
+		RenderPass* postRenderPass = &renderPasses.at("post");
+		postRenderPass->begin(commandBuffer, postFramebuffers[swapchainImageIndex].framebuffer, window->extent);
+		graphicsPipelines.at("post").bind(commandBuffer);
+		postDescriptorSet.bind(commandBuffer, 0);
+
+		vkCmdDraw(commandBuffer->commandBuffer, 3, 1, 0, 0);
+
+		postRenderPass->end(commandBuffer);
+	});
+	renderGraph.addRead(pass, scene, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph.addRead(pass, ssaoBlurred, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	renderGraph.compile();
 }
 
 void Renderer::createResources() {
-	// Framebuffers
+	// Framebuffers, the images are created by the render graph
 	{
-		ImageTools::createImage(&colorImage.image, 1, window->extent.width, window->extent.height, 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &colorImage.allocationId);
-		ImageTools::createImageView(&colorImage.imageView, colorImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-		ImageTools::createImageSampler(&colorImage.imageSampler, 2, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
-		ImageTools::transitionLayout(colorImage.image, physicalDevice.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-	
 		std::vector<std::vector<VkImageView>> framebufferAttachments;
 		framebufferAttachments.resize(swapchainSize);
 		sceneFramebuffers.resize(swapchainSize);
@@ -679,7 +1852,7 @@ void Renderer::createResources() {
 
 void Renderer::destroyResources() {
 	swapchain.destroy();
-	colorImage.destroy();
+	renderGraph.destroy();
 	for (Framebuffer& framebuffer : sceneFramebuffers) {
 		framebuffer.destroy();
 	}
@@ -752,6 +1925,10 @@ void Renderer::reloadOnResize() {
 	fullscreenViewport.scissor.extent.width = window->extent.width;
 	fullscreenViewport.scissor.extent.height = window->extent.height;
 
+	// Render graph, the shadow atlas and cache lose their content so every tile is drawn again
+	createRenderGraph();
+	shadow.cachedTiles.clear();
+
 	// Depth prepass
 	depthPrepass.createResources(fullscreenViewport);
 
@@ -762,14 +1939,8 @@ void Renderer::reloadOnResize() {
 
 	createPostProcessDescriptorSet();
 
-	auto& cameraCamera = ecs.getComponent<Camera>(camera);
-	cameraCamera.projection = Camera::createPerspectiveProjection(cameraCamera.FOV, window->extent.width / static_cast<float>(window->extent.height), cameraCamera.nearPlane, cameraCamera.farPlane, true);
+	auto const& cameraCamera = ecs.readComponent<Camera>(camera);
+	cameraProjection = Camera::createPerspectiveProjection(cameraCamera.FOV, window->extent.width / static_cast<float>(window->extent.height), cameraCamera.nearPlane, cameraCamera.farPlane, true);
 
-	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		for (Entity entity : entities) {
-			auto& entityRenderable = ecs.getComponent<Renderable>(entity);
-
-			entityRenderable.createEntityDescriptorSet(i);
-		}
-	}
+	recreateObjectDescriptorSets();
 }
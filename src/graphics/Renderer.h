@@ -6,14 +6,21 @@
 #include "../utils/NeigeVKTranslate.h"
 #include "../utils/resources/ImageTools.h"
 #include "../utils/resources/ModelLoader.h"
+#include "../utils/sort/RadixSort.h"
 #include "devices/PhysicalDevicePicker.h"
 #include "commands/CommandBuffer.h"
 #include "commands/CommandPool.h"
+#include "culling/BVH.h"
+#include "culling/Frustum.h"
+#include "culling/GPUCulling.h"
+#include "models/Model.h"
+#include "pipelines/ComputePipeline.h"
 #include "pipelines/GraphicsPipeline.h"
 #include "pipelines/DescriptorSet.h"
 #include "pipelines/Shader.h"
 #include "pipelines/Viewport.h"
 #include "resources/Image.h"
+#include "rendergraph/RenderGraph.h"
 #include "renderpasses/Framebuffer.h"
 #include "renderpasses/RenderPass.h"
 #include "sync/Fence.h"
@@ -24,14 +31,62 @@
 #include "effects/ssao/SSAO.h"
 #include "../window/Window.h"
 #include "../ecs/ECS.h"
+#include "../utils/threadpool/ThreadPool.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <map>
 
+#define RECORDING_CHUNK_SIZE 64
+#define SORT_KEY_PIPELINE_BITS 12
+#define SORT_KEY_DEPTH_BITS 24
+#define SORT_KEY_BATCH_BITS 24
+
+// Entities sharing a model and a graphics pipeline, drawn with one instanced draw per primitive
+struct InstanceBatch {
+	Model* model;
+	GraphicsPipeline* graphicsPipeline;
+	uint32_t pipelineIndex;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+	// Instances inside the view volume of the camera, then of each shadow map and of each shadow map cache, only counted here when the CPU culls them
+	std::vector<uint32_t> visibleInstanceCounts;
+	uint32_t firstDrawCommand;
+};
+
+enum struct BatchPassType {
+	DEPTH_PREPASS,
+	SHADOW_CACHE,
+	SHADOW,
+	SCENE
+};
+
+// Render pass drawing the instance batches, recorded in chunks of batches into secondary command buffers
+struct BatchPass {
+	BatchPassType type;
+	RenderPass* renderPass;
+	VkFramebuffer framebuffer;
+	VkExtent2D extent;
+	uint32_t view;
+	const std::vector<uint32_t>* batchOrder;
+};
+
+// Draw sort key, from the most significant bits: pass, graphics pipeline, depth and instance batch
+// Batches are sorted by model inside a graphics pipeline and models own their materials, so the batch also orders models and materials
+inline uint64_t drawSortKey(BatchPassType pass, uint32_t pipelineIndex, uint32_t depth, uint32_t batchIndex) {
+	return (static_cast<uint64_t>(pass) << (SORT_KEY_PIPELINE_BITS + SORT_KEY_DEPTH_BITS + SORT_KEY_BATCH_BITS)) |
+		(static_cast<uint64_t>(pipelineIndex) << (SORT_KEY_DEPTH_BITS + SORT_KEY_BATCH_BITS)) |
+		(static_cast<uint64_t>(depth) << SORT_KEY_BATCH_BITS) |
+		static_cast<uint64_t>(batchIndex);
+}
+
 struct Renderer : public System {
 	Window* window;
 
+	// Camera matrices, derived from the camera component that the renderer only reads
+	glm::mat4 cameraView;
+	glm::mat4 cameraProjection;
+
 	// Envmap
 	GraphicsPipeline skyboxGraphicsPipeline;
 	std::vector<DescriptorSet> skyboxDescriptorSets;
@@ -42,8 +97,6 @@ struct Renderer : public System {
 	std::vector<Semaphore> RFsemaphores;
 
 	// Pipelines
-	GraphicsPipeline* currentPipeline;
-
 	Viewport fullscreenViewport;
 
 	std::unordered_map<std::string, GraphicsPipeline> graphicsPipelines;
@@ -58,17 +111,120 @@ struct Renderer : public System {
 	std::vector<CommandPool> renderingCommandPools;
 	std::vector<CommandBuffer> renderingCommandBuffers;
 
+	// Multithreaded recording, one task per chunk of each batch pass, every task owns a command pool per frame in flight
+	ThreadPool* threadPool;
+	std::vector<BatchPass> batchPasses;
+	std::vector<std::vector<CommandPool>> recordingCommandPools;
+	std::vector<std::vector<CommandBuffer>> recordingCommandBuffers;
+	std::vector<VkCommandBuffer> executedCommandBuffers;
+	uint32_t recordingChunkCount = 1;
+
+	// Passes of a frame, with the barriers between them and the memory of their transient images
+	RenderGraph renderGraph;
+	uint32_t swapchainImageIndex = 0;
+
 	uint32_t swapchainSize;
 	uint32_t currentFrame = 0;
 
+	// Objects, the model matrices of every instance in one storage buffer per frame in flight
+	std::vector<Buffer> objectBuffers;
+	uint32_t objectBufferCapacity = 0;
+	std::unordered_map<GraphicsPipeline*, std::vector<DescriptorSet>> objectDescriptorSets;
+	std::vector<DescriptorSet> depthPrepassDescriptorSets;
+	std::vector<DescriptorSet> shadowDescriptorSets;
+
+	// Instances sorted by graphics pipeline and model, rebuilt when renderables are added or removed
+	std::vector<Entity> instances;
+	std::vector<InstanceBatch> instanceBatches;
+	uint32_t instancesModificationCount = UINT32_MAX;
+	uint32_t instancesLayout = 0;
+	// Frames left before a moving instance settles, UINT8_MAX for skinned ones, dynamic instances are drawn in the shadow maps every frame and the others only in the shadow map caches
+	std::vector<uint8_t> instanceDynamic;
+	bool staticCastersChanged = true;
+
+	// Frustum culling, one view for the camera, one per shadow map for its dynamic casters then one per shadow map cache for its static casters
+	// Only the views in use are culled, the others draw nothing
+	// Each view has a section of visible instances as large as the instances, where the ones of each batch are packed from its first instance
+	std::vector<Frustum> viewFrustums;
+	std::vector<uint8_t> culledViews;
+	// Instances smaller than this are not drawn in the view, only used by the shadow cascades
+	std::vector<float> viewMinCasterSizes;
+	std::vector<Buffer> visibleInstanceBuffers;
+	std::vector<uint32_t> visibleInstances;
+	std::vector<uint8_t> instanceVisibility;
+	std::vector<uint8_t> primitiveVisibility;
+	std::vector<float> cullingBounds;
+
+	// Spatial index of the instances, refitted when their transform changes
+	// Only the renderer update writes it, systems reading renderables are never scheduled alongside it and can query it without locking
+	BVH bvh;
+	std::vector<uint32_t> bvhLeaves;
+	std::vector<uint32_t> instanceIndices;
+	std::vector<Entity> visibleEntities;
+	uint32_t lastBVHVersion = 0;
+
+	// Order of the instance batches in each pass, the depth prepass and the scene are sorted front to back every frame
+	std::vector<uint32_t> depthPrepassBatchOrder;
+	std::vector<uint32_t> shadowBatchOrder;
+	std::vector<uint32_t> sceneBatchOrder;
+	std::vector<uint64_t> sortKeys;
+	std::vector<uint64_t> sortScratch;
+
+	// Bounds of the instances of each batch, the GPU-driven sort uses them and they are refit when one of their instances moves
+	std::vector<AABB> batchBounds;
+	std::vector<uint8_t> batchBoundsOutdated;
+
+	// Draw commands of every primitive of the instance batches, each view draws them from its own section of visible instances
+	std::vector<VkDrawIndexedIndirectCommand> drawCommands;
+	uint32_t viewDrawCommandCount = 0;
+
+	// GPU-driven rendering, compute passes cull the instances of every view and write the draw commands read by every pass
+	bool gpuDriven = false;
+	GPUCulling gpuCulling;
+	std::vector<CullingDrawCommand> cullingDrawCommands;
+	// Vertices and indices of every model, consecutive batches of the untextured passes share a single indirect draw
+	Buffer geometryVertexBuffer;
+	Buffer geometryIndexBuffer;
+	size_t geometryModelCount = 0;
+
+	// Clustered lighting, a compute pass bins the lights into view-space clusters read by the scene shaders
+	ComputePipeline lightClustersComputePipeline;
+	std::vector<DescriptorSet> lightClustersDescriptorSets;
+	std::vector<Buffer> lightBuffers;
+	std::vector<Buffer> clusterBuffers;
+	uint32_t lightBufferCapacity = 0;
+
+	// Instances layout and ECS version of the last object data update, per frame in flight
+	std::vector<uint32_t> lastInstancesLayouts;
+	std::vector<uint32_t> lastTransformVersions;
+
 	bool pressed = false;
 
 	void init();
 	void update();
 	void destroy();
 	void loadObject(Entity object);
+	void buildInstanceBatches();
+	void createObjectBuffers(uint32_t capacity);
+	void createGeometryBuffers();
+	void createObjectDescriptorSet(GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex);
+	void createDepthPrepassDescriptorSet(uint32_t frameInFlightIndex);
+	void createShadowDescriptorSet(uint32_t frameInFlightIndex);
+	void recreateObjectDescriptorSets();
+	void createLightBuffers(uint32_t capacity);
+	void createLightClustersDescriptorSet(uint32_t frameInFlightIndex);
+	void updateBVH();
+	void cullInstances();
+	void fitShadowCascades();
+	void sortInstanceBatches(const glm::vec3& position, const glm::vec3& forward);
+	void drawInstanceBatch(CommandBuffer* commandBuffer, InstanceBatch& instanceBatch, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures, uint32_t view);
+	// Batches of an untextured pass, from firstBatch to lastBatch in batchOrder
+	void drawInstanceBatches(CommandBuffer* commandBuffer, const std::vector<uint32_t>& batchOrder, size_t firstBatch, size_t lastBatch, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, uint32_t view);
 	void updateData(uint32_t frameInFlightIndex);
+	void recordBatchPass(CommandBuffer* commandBuffer, const BatchPass& batchPass, size_t firstBatch, size_t lastBatch, bool lastChunk, uint32_t frameInFlightIndex);
+	void executeBatchPass(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex, size_t batchPassIndex);
 	void recordRenderingCommands(uint32_t frameInFlightIndex, uint32_t framebufferIndex);
+	void createRenderGraph();
 	void createResources();
 	void destroyResources();
 	void createPostProcessDescriptorSet();
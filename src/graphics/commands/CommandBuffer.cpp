@@ -1,12 +1,12 @@
 #include "CommandBuffer.h"
 #include "../resources/RendererResources.h"
 
-void CommandBuffer::init(CommandPool* commandPool) {
+void CommandBuffer::init(CommandPool* commandPool, VkCommandBufferLevel level) {
 	VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
 	commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	commandBufferAllocateInfo.pNext = nullptr;
 	commandBufferAllocateInfo.commandPool = commandPool->commandPool;
-	commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.level = level;
 	commandBufferAllocateInfo.commandBufferCount = 1;
 	NEIGE_VK_CHECK(vkAllocateCommandBuffers(logicalDevice.device, &commandBufferAllocateInfo, &commandBuffer));
 }
@@ -17,12 +17,52 @@ void CommandBuffer::begin() {
 	commandBufferBeginInfo.pNext = nullptr;
 	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	NEIGE_VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+	stateTracker.reset();
+}
+
+void CommandBuffer::begin(VkRenderPass renderPass, VkFramebuffer framebuffer) {
+	VkCommandBufferInheritanceInfo commandBufferInheritanceInfo = {};
+	commandBufferInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	commandBufferInheritanceInfo.pNext = nullptr;
+	commandBufferInheritanceInfo.renderPass = renderPass;
+	commandBufferInheritanceInfo.subpass = 0;
+	commandBufferInheritanceInfo.framebuffer = framebuffer;
+	commandBufferInheritanceInfo.occlusionQueryEnable = VK_FALSE;
+	commandBufferInheritanceInfo.queryFlags = 0;
+	commandBufferInheritanceInfo.pipelineStatistics = 0;
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.pNext = nullptr;
+	commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	commandBufferBeginInfo.pInheritanceInfo = &commandBufferInheritanceInfo;
+	NEIGE_VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+	stateTracker.reset();
 }
 
 void CommandBuffer::end() {
 	NEIGE_VK_CHECK(vkEndCommandBuffer(commandBuffer));
 }
 
+void CommandBuffer::bindVertexBuffer(VkBuffer buffer) {
+	if (stateTracker.setVertexBuffer(buffer)) {
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+	}
+}
+
+void CommandBuffer::bindIndexBuffer(VkBuffer buffer) {
+	if (stateTracker.setIndexBuffer(buffer)) {
+		vkCmdBindIndexBuffer(commandBuffer, buffer, 0, VK_INDEX_TYPE_UINT32);
+	}
+}
+
+void CommandBuffer::executeCommands(const std::vector<VkCommandBuffer>& commandBuffers) {
+	vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+	// The state is undefined after executing secondary command buffers
+	stateTracker.reset();
+}
+
 void CommandBuffer::endAndSubmit() {
 	NEIGE_VK_CHECK(vkEndCommandBuffer(commandBuffer));
 	VkSubmitInfo submitInfo = {};
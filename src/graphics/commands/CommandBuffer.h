@@ -2,13 +2,21 @@
 #include "vulkan/vulkan.hpp"
 #include "../../utils/NeigeDefines.h"
 #include "CommandPool.h"
+#include "StateTracker.h"
+#include <vector>
 
 struct CommandBuffer {
 	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	StateTracker stateTracker;
 
-	void init(CommandPool* commandPool);
+	void init(CommandPool* commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 	void begin();
+	// Secondary command buffer executed inside a render pass
+	void begin(VkRenderPass renderPass, VkFramebuffer framebuffer);
 	void end();
+	void bindVertexBuffer(VkBuffer buffer);
+	void bindIndexBuffer(VkBuffer buffer);
+	void executeCommands(const std::vector<VkCommandBuffer>& commandBuffers);
 	void endAndSubmit();
 };
 
@@ -0,0 +1,59 @@
+#include "StateTracker.h"
+
+void StateTracker::reset() {
+	pipeline = VK_NULL_HANDLE;
+	descriptorSetsLayout = VK_NULL_HANDLE;
+	for (uint32_t i = 0; i < STATE_TRACKER_MAX_SETS; i++) {
+		descriptorSets[i] = VK_NULL_HANDLE;
+	}
+	vertexBuffer = VK_NULL_HANDLE;
+	indexBuffer = VK_NULL_HANDLE;
+}
+
+bool StateTracker::setPipeline(VkPipeline newPipeline) {
+	if (pipeline == newPipeline) {
+		return false;
+	}
+	pipeline = newPipeline;
+
+	return true;
+}
+
+bool StateTracker::setDescriptorSet(VkPipelineLayout pipelineLayout, uint32_t set, VkDescriptorSet descriptorSet) {
+	if (set >= STATE_TRACKER_MAX_SETS) {
+		return true;
+	}
+
+	// Sets bound with another layout are not tracked, as they may not be compatible
+	if (descriptorSetsLayout != pipelineLayout) {
+		for (uint32_t i = 0; i < STATE_TRACKER_MAX_SETS; i++) {
+			descriptorSets[i] = VK_NULL_HANDLE;
+		}
+		descriptorSetsLayout = pipelineLayout;
+	}
+
+	if (descriptorSets[set] == descriptorSet) {
+		return false;
+	}
+	descriptorSets[set] = descriptorSet;
+
+	return true;
+}
+
+bool StateTracker::setVertexBuffer(VkBuffer buffer) {
+	if (vertexBuffer == buffer) {
+		return false;
+	}
+	vertexBuffer = buffer;
+
+	return true;
+}
+
+bool StateTracker::setIndexBuffer(VkBuffer buffer) {
+	if (indexBuffer == buffer) {
+		return false;
+	}
+	indexBuffer = buffer;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include "vulkan/vulkan.hpp"
+#include "../../utils/NeigeDefines.h"
+
+#define STATE_TRACKER_MAX_SETS 4
+
+// Graphics state bound in a command buffer, a bind leaving it unchanged can be dropped
+struct StateTracker {
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout descriptorSetsLayout = VK_NULL_HANDLE;
+	VkDescriptorSet descriptorSets[STATE_TRACKER_MAX_SETS] = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+
+	void reset();
+	// Each function records the new state and returns whether the bind is needed
+	bool setPipeline(VkPipeline newPipeline);
+	bool setDescriptorSet(VkPipelineLayout pipelineLayout, uint32_t set, VkDescriptorSet descriptorSet);
+	bool setVertexBuffer(VkBuffer buffer);
+	bool setIndexBuffer(VkBuffer buffer);
+};
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "BVH.h"
+#include <cmath>
+
+uint32_t BVH::insert(Entity entity, const AABB& aabb) {
+	uint32_t leaf = allocateNode();
+
+	glm::vec3 margin = (aabb.max - aabb.min) * BVH_FAT_AABB_MARGIN + glm::vec3(BVH_FAT_AABB_MIN_MARGIN);
+	nodes[leaf].aabb = { aabb.min - margin, aabb.max + margin };
+	nodes[leaf].objectAABB = aabb;
+	nodes[leaf].entity = entity;
+	nodes[leaf].height = 0;
+	insertLeaf(leaf);
+	leafCount++;
+
+	return leaf;
+}
+
+void BVH::remove(uint32_t leaf) {
+	NEIGE_ASSERT(leaf < nodes.size() && nodes[leaf].isLeaf() && nodes[leaf].height == 0, "BVH leaf " + std::to_string(leaf) + " does not exist.");
+
+	removeLeaf(leaf);
+	releaseNode(leaf);
+	leafCount--;
+}
+
+bool BVH::move(uint32_t leaf, const AABB& aabb) {
+	NEIGE_ASSERT(leaf < nodes.size() && nodes[leaf].isLeaf() && nodes[leaf].height == 0, "BVH leaf " + std::to_string(leaf) + " does not exist.");
+
+	nodes[leaf].objectAABB = aabb;
+	if (nodes[leaf].aabb.contains(aabb)) {
+		return false;
+	}
+
+	removeLeaf(leaf);
+	glm::vec3 margin = (aabb.max - aabb.min) * BVH_FAT_AABB_MARGIN + glm::vec3(BVH_FAT_AABB_MIN_MARGIN);
+	nodes[leaf].aabb = { aabb.min - margin, aabb.max + margin };
+	insertLeaf(leaf);
+
+	return true;
+}
+
+void BVH::clear() {
+	nodes.clear();
+	root = BVH_NULL_NODE;
+	freeList = BVH_NULL_NODE;
+	leafCount = 0;
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<Entity>* entities) const {
+	if (root == BVH_NULL_NODE) {
+		return;
+	}
+
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+	while (!stack.empty()) {
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		const AABB& aabb = node.isLeaf() ? node.objectAABB : node.aabb;
+		FrustumIntersection intersection = frustum.intersect((aabb.min + aabb.max) * 0.5f, (aabb.max - aabb.min) * 0.5f);
+		if (intersection == FrustumIntersection::OUTSIDE) {
+			continue;
+		}
+
+		if (node.isLeaf()) {
+			entities->push_back(node.entity);
+		}
+		else if (intersection == FrustumIntersection::INSIDE) {
+			// Every leaf below is inside too
+			collectLeaves(node.children[0], entities);
+			collectLeaves(node.children[1], entities);
+		}
+		else {
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+void BVH::queryAABB(const AABB& aabb, std::vector<Entity>* entities) const {
+	if (root == BVH_NULL_NODE) {
+		return;
+	}
+
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+	while (!stack.empty()) {
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.isLeaf()) {
+			if (node.objectAABB.overlaps(aabb)) {
+				entities->push_back(node.entity);
+			}
+		}
+		else if (node.aabb.overlaps(aabb)) {
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+bool BVH::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Entity* entity, float* distance) const {
+	if (root == BVH_NULL_NODE) {
+		return false;
+	}
+
+	// Slab test, a zero direction component gives infinite slab distances
+	glm::vec3 inverseDirection = glm::vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	auto hitDistance = [&origin, &inverseDirection](const AABB& aabb, float closest, float* hit) {
+		glm::vec3 t0 = (aabb.min - origin) * inverseDirection;
+		glm::vec3 t1 = (aabb.max - origin) * inverseDirection;
+		glm::vec3 tMin = glm::min(t0, t1);
+		glm::vec3 tMax = glm::max(t0, t1);
+		float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, closest));
+		*hit = enter;
+
+		return enter <= exit;
+	};
+
+	float closest = maxDistance;
+	bool found = false;
+
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+	while (!stack.empty()) {
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		float hit;
+		if (node.isLeaf()) {
+			if (hitDistance(node.objectAABB, closest, &hit)) {
+				closest = hit;
+				*entity = node.entity;
+				found = true;
+			}
+		}
+		else if (hitDistance(node.aabb, closest, &hit)) {
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+
+	if (found) {
+		*distance = closest;
+	}
+
+	return found;
+}
+
+uint32_t BVH::allocateNode() {
+	if (freeList == BVH_NULL_NODE) {
+		nodes.emplace_back();
+
+		return static_cast<uint32_t>(nodes.size() - 1);
+	}
+
+	uint32_t node = freeList;
+	freeList = nodes[node].parent;
+	nodes[node] = BVHNode();
+
+	return node;
+}
+
+void BVH::releaseNode(uint32_t node) {
+	nodes[node].parent = freeList;
+	nodes[node].children[0] = BVH_NULL_NODE;
+	nodes[node].children[1] = BVH_NULL_NODE;
+	nodes[node].height = -1;
+	nodes[node].entity = NO_ENTITY;
+	freeList = node;
+}
+
+void BVH::insertLeaf(uint32_t leaf) {
+	if (root == BVH_NULL_NODE) {
+		root = leaf;
+		nodes[leaf].parent = BVH_NULL_NODE;
+
+		return;
+	}
+
+	// Sibling, going down while a child costs less than pairing with the current node
+	AABB leafAABB = nodes[leaf].aabb;
+	uint32_t sibling = root;
+	while (!nodes[sibling].isLeaf()) {
+		AABB combinedAABB = nodes[sibling].aabb;
+		combinedAABB.merge(leafAABB);
+		float combinedArea = combinedAABB.surfaceArea();
+
+		// A new parent here, the ancestors grow by the same amount whatever the choice
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - nodes[sibling].aabb.surfaceArea());
+
+		float childCosts[2];
+		for (int i = 0; i < 2; i++) {
+			const BVHNode& child = nodes[nodes[sibling].children[i]];
+			AABB childAABB = child.aabb;
+			childAABB.merge(leafAABB);
+			childCosts[i] = childAABB.surfaceArea() + inheritanceCost;
+			if (!child.isLeaf()) {
+				childCosts[i] -= child.aabb.surfaceArea();
+			}
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1]) {
+			break;
+		}
+
+		sibling = nodes[sibling].children[childCosts[0] < childCosts[1] ? 0 : 1];
+	}
+
+	uint32_t oldParent = nodes[sibling].parent;
+	uint32_t newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].aabb = nodes[sibling].aabb;
+	nodes[newParent].aabb.merge(leafAABB);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].children[0] = sibling;
+	nodes[newParent].children[1] = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == BVH_NULL_NODE) {
+		root = newParent;
+	}
+	else {
+		nodes[oldParent].children[nodes[oldParent].children[0] == sibling ? 0 : 1] = newParent;
+	}
+
+	refit(oldParent);
+}
+
+void BVH::removeLeaf(uint32_t leaf) {
+	if (leaf == root) {
+		root = BVH_NULL_NODE;
+
+		return;
+	}
+
+	uint32_t parent = nodes[leaf].parent;
+	uint32_t grandParent = nodes[parent].parent;
+	uint32_t sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+
+	// The sibling takes the place of the parent
+	nodes[sibling].parent = grandParent;
+	if (grandParent == BVH_NULL_NODE) {
+		root = sibling;
+	}
+	else {
+		nodes[grandParent].children[nodes[grandParent].children[0] == parent ? 0 : 1] = sibling;
+	}
+	releaseNode(parent);
+
+	refit(grandParent);
+}
+
+void BVH::refit(uint32_t node) {
+	// Boxes and heights up to the root, balancing on the way
+	while (node != BVH_NULL_NODE) {
+		node = balance(node);
+
+		const BVHNode& child0 = nodes[nodes[node].children[0]];
+		const BVHNode& child1 = nodes[nodes[node].children[1]];
+		nodes[node].aabb = child0.aabb;
+		nodes[node].aabb.merge(child1.aabb);
+		nodes[node].height = 1 + std::max(child0.height, child1.height);
+
+		node = nodes[node].parent;
+	}
+}
+
+uint32_t BVH::balance(uint32_t node) {
+	if (nodes[node].isLeaf() || nodes[node].height < 2) {
+		return node;
+	}
+
+	int32_t balanceFactor = nodes[nodes[node].children[1]].height - nodes[nodes[node].children[0]].height;
+	if (balanceFactor > 1) {
+		return rotate(node, 1);
+	}
+	else if (balanceFactor < -1) {
+		return rotate(node, 0);
+	}
+
+	return node;
+}
+
+uint32_t BVH::rotate(uint32_t node, int tallChild) {
+	// The tall child takes the place of the node, which takes the shortest grandchild in place of the tall child
+	uint32_t a = node;
+	uint32_t c = nodes[a].children[tallChild];
+	uint32_t b = nodes[a].children[1 - tallChild];
+	uint32_t f = nodes[c].children[0];
+	uint32_t g = nodes[c].children[1];
+
+	nodes[c].parent = nodes[a].parent;
+	nodes[a].parent = c;
+	if (nodes[c].parent == BVH_NULL_NODE) {
+		root = c;
+	}
+	else {
+		uint32_t cParent = nodes[c].parent;
+		nodes[cParent].children[nodes[cParent].children[0] == a ? 0 : 1] = c;
+	}
+
+	uint32_t kept = f;
+	uint32_t moved = g;
+	if (nodes[f].height <= nodes[g].height) {
+		kept = g;
+		moved = f;
+	}
+
+	nodes[c].children[0] = a;
+	nodes[c].children[1] = kept;
+	nodes[a].children[tallChild] = moved;
+	nodes[moved].parent = a;
+
+	nodes[a].aabb = nodes[b].aabb;
+	nodes[a].aabb.merge(nodes[moved].aabb);
+	nodes[a].height = 1 + std::max(nodes[b].height, nodes[moved].height);
+	nodes[c].aabb = nodes[a].aabb;
+	nodes[c].aabb.merge(nodes[kept].aabb);
+	nodes[c].height = 1 + std::max(nodes[a].height, nodes[kept].height);
+
+	return c;
+}
+
+void BVH::collectLeaves(uint32_t node, std::vector<Entity>* entities) const {
+	std::vector<uint32_t> stack;
+	stack.reserve(64);
+	stack.push_back(node);
+	while (!stack.empty()) {
+		const BVHNode& current = nodes[stack.back()];
+		stack.pop_back();
+
+		if (current.isLeaf()) {
+			entities->push_back(current.entity);
+		}
+		else {
+			stack.push_back(current.children[0]);
+			stack.push_back(current.children[1]);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "../../../external/glm/glm/glm.hpp"
+#include "../../ecs/ECS.h"
+#include "Bounds.h"
+#include "Frustum.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BVH_NULL_NODE UINT32_MAX
+// Leaves are enlarged by this fraction of their size, plus a minimum, so that small moves do not reinsert them
+#define BVH_FAT_AABB_MARGIN 0.1f
+#define BVH_FAT_AABB_MIN_MARGIN 0.01f
+
+struct BVHNode {
+	// Enlarged object box for leaves, union of the children for internal nodes
+	AABB aabb;
+	// Leaves only
+	AABB objectAABB;
+	Entity entity = NO_ENTITY;
+
+	// Next free node when the node is free
+	uint32_t parent = BVH_NULL_NODE;
+	uint32_t children[2] = { BVH_NULL_NODE, BVH_NULL_NODE };
+	// 0 for leaves, -1 for free nodes
+	int32_t height = -1;
+
+	bool isLeaf() const {
+		return children[0] == BVH_NULL_NODE;
+	}
+};
+
+// Dynamic AABB tree, leaves are inserted next to the sibling adding the least surface area and the tree is kept balanced with rotations
+// Updates need exclusive access, queries do not modify the tree and can run from any number of threads at once
+struct BVH {
+	std::vector<BVHNode> nodes;
+	uint32_t root = BVH_NULL_NODE;
+	uint32_t freeList = BVH_NULL_NODE;
+	uint32_t leafCount = 0;
+
+	// Returns the leaf of the entity
+	uint32_t insert(Entity entity, const AABB& aabb);
+	void remove(uint32_t leaf);
+	// Returns true when the box left the enlarged box of the leaf and the leaf got reinserted
+	bool move(uint32_t leaf, const AABB& aabb);
+	void clear();
+
+	// Entities whose box is not fully outside the frustum
+	void queryFrustum(const Frustum& frustum, std::vector<Entity>* entities) const;
+	// Entities whose box overlaps the box
+	void queryAABB(const AABB& aabb, std::vector<Entity>* entities) const;
+	// Closest entity box hit by the ray, the distance is in direction lengths
+	bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Entity* entity, float* distance) const;
+
+	uint32_t allocateNode();
+	void releaseNode(uint32_t node);
+	void insertLeaf(uint32_t leaf);
+	void removeLeaf(uint32_t leaf);
+	void refit(uint32_t node);
+	uint32_t balance(uint32_t node);
+	uint32_t rotate(uint32_t node, int tallChild);
+	void collectLeaves(uint32_t node, std::vector<Entity>* entities) const;
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include "../../../external/glm/glm/glm.hpp"
+#include <algorithm>
+#include <limits>
+
+// Axis-aligned bounding box, empty until a point is added
+struct AABB {
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+	void merge(const AABB& other) {
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	bool contains(const AABB& other) const {
+		return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+	}
+
+	bool overlaps(const AABB& other) const {
+		return min.x <= other.max.x && min.y <= other.max.y && min.z <= other.max.z && max.x >= other.min.x && max.y >= other.min.y && max.z >= other.min.z;
+	}
+
+	float surfaceArea() const {
+		glm::vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	// Box enclosing this box once transformed
+	AABB transform(const glm::mat4& matrix) const {
+		glm::vec3 center = glm::vec3(matrix * glm::vec4((min + max) * 0.5f, 1.0f));
+		glm::vec3 halfExtent = (max - min) * 0.5f;
+		glm::vec3 extent = glm::abs(glm::vec3(matrix[0])) * halfExtent.x + glm::abs(glm::vec3(matrix[1])) * halfExtent.y + glm::abs(glm::vec3(matrix[2])) * halfExtent.z;
+
+		return { center - extent, center + extent };
+	}
+};
+
+// Bounding sphere
+struct BoundingSphere {
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "Frustum.h"
+#include <cmath>
+
+void Frustum::init(const glm::mat4& viewProjection) {
+	// Rows of the view projection matrix
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	std::array<glm::vec4, 6> planes = { rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[2],
+		rows[3] - rows[2] };
+
+	for (size_t i = 0; i < planes.size(); i++) {
+		float length = glm::length(glm::vec3(planes[i]));
+		a[i] = planes[i].x / length;
+		b[i] = planes[i].y / length;
+		c[i] = planes[i].z / length;
+		d[i] = planes[i].w / length;
+	}
+}
+
+void Frustum::removeNearPlane() {
+	a[4] = 0.0f;
+	b[4] = 0.0f;
+	c[4] = 0.0f;
+	d[4] = 1.0f;
+}
+
+void Frustum::cull(size_t count, const float* centersX, const float* centersY, const float* centersZ, const float* extentsX, const float* extentsY, const float* extentsZ, uint8_t* visible) const {
+	for (size_t i = 0; i < count; i++) {
+		visible[i] = 1;
+	}
+
+	// One plane at a time over every box, the inner loop has no branch
+	for (size_t p = 0; p < 6; p++) {
+		float planeA = a[p];
+		float planeB = b[p];
+		float planeC = c[p];
+		float planeD = d[p];
+		float absA = std::fabs(planeA);
+		float absB = std::fabs(planeB);
+		float absC = std::fabs(planeC);
+
+		for (size_t i = 0; i < count; i++) {
+			float distance = planeA * centersX[i] + planeB * centersY[i] + planeC * centersZ[i] + planeD;
+			float radius = absA * extentsX[i] + absB * extentsY[i] + absC * extentsZ[i];
+			visible[i] &= static_cast<uint8_t>(distance + radius >= 0.0f);
+		}
+	}
+}
+
+FrustumIntersection Frustum::intersect(const glm::vec3& center, const glm::vec3& extent) const {
+	FrustumIntersection intersection = FrustumIntersection::INSIDE;
+	for (size_t p = 0; p < 6; p++) {
+		float distance = a[p] * center.x + b[p] * center.y + c[p] * center.z + d[p];
+		float radius = std::fabs(a[p]) * extent.x + std::fabs(b[p]) * extent.y + std::fabs(c[p]) * extent.z;
+		if (distance + radius < 0.0f) {
+			return FrustumIntersection::OUTSIDE;
+		}
+		else if (distance - radius < 0.0f) {
+			intersection = FrustumIntersection::INTERSECT;
+		}
+	}
+
+	return intersection;
+}
\ No newline at end of file
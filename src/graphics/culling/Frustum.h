@@ -0,0 +1,28 @@
+#pragma once
+#include "../../../external/glm/glm/glm.hpp"
+#include <array>
+#include <cstdint>
+
+enum struct FrustumIntersection {
+	OUTSIDE,
+	INTERSECT,
+	INSIDE
+};
+
+// View frustum, planes are stored per component so that boxes are tested in batches
+struct Frustum {
+	// a * x + b * y + c * z + d >= 0 inside the frustum, left, right, bottom, top, near and far
+	std::array<float, 6> a;
+	std::array<float, 6> b;
+	std::array<float, 6> c;
+	std::array<float, 6> d;
+
+	// Projection with a [0, 1] depth range
+	void init(const glm::mat4& viewProjection);
+	// Keeps everything behind the near plane
+	void removeNearPlane();
+	// visible[i] is set to 0 when the box of center and half extents i is fully outside the frustum, 1 otherwise
+	void cull(size_t count, const float* centersX, const float* centersY, const float* centersZ, const float* extentsX, const float* extentsY, const float* extentsZ, uint8_t* visible) const;
+	// Single box of center and half extents
+	FrustumIntersection intersect(const glm::vec3& center, const glm::vec3& extent) const;
+};
\ No newline at end of file
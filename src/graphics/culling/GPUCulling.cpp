@@ -0,0 +1,221 @@
+#include "GPUCulling.h"
+#include "../../utils/resources/BufferTools.h"
+#include "../resources/RendererResources.h"
+
+void GPUCulling::init() {
+	cullingComputePipeline.computeShaderPath = "../shaders/cullInstances.comp";
+	cullingComputePipeline.init();
+
+	drawCommandsComputePipeline.computeShaderPath = "../shaders/drawCommands.comp";
+	drawCommandsComputePipeline.init();
+}
+
+void GPUCulling::destroy() {
+	destroyResources();
+	cullingComputePipeline.destroy();
+	drawCommandsComputePipeline.destroy();
+}
+
+void GPUCulling::reload() {
+	cullingComputePipeline.destroyPipeline();
+	cullingComputePipeline.init();
+	drawCommandsComputePipeline.destroyPipeline();
+	drawCommandsComputePipeline.init();
+}
+
+void GPUCulling::createResources(uint32_t instanceCount, uint32_t viewCount, uint32_t batchCount, uint32_t drawCommandCount, const std::vector<Buffer>& visibleInstanceBuffers) {
+	instanceCapacity = instanceCount;
+	viewCapacity = viewCount;
+	batchCapacity = batchCount;
+	drawCommandCapacity = drawCommandCount;
+
+	instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	viewBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	drawCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	countBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	indirectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	cullingDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	drawCommandsDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		BufferTools::createStorageBuffer(instanceBuffers[i].buffer, instanceBuffers[i].deviceMemory, sizeof(CullingInstance) * static_cast<VkDeviceSize>(instanceCapacity));
+		instanceBuffers[i].map(0, VK_WHOLE_SIZE, &instanceBuffers[i].mappedMemory);
+		BufferTools::createStorageBuffer(viewBuffers[i].buffer, viewBuffers[i].deviceMemory, sizeof(CullingView) * static_cast<VkDeviceSize>(viewCapacity));
+		viewBuffers[i].map(0, VK_WHOLE_SIZE, &viewBuffers[i].mappedMemory);
+		BufferTools::createStorageBuffer(drawCommandBuffers[i].buffer, drawCommandBuffers[i].deviceMemory, sizeof(CullingDrawCommand) * static_cast<VkDeviceSize>(drawCommandCapacity));
+		drawCommandBuffers[i].map(0, VK_WHOLE_SIZE, &drawCommandBuffers[i].mappedMemory);
+
+		// Counts are cleared every frame, the indirect commands can be read back
+		BufferTools::createBuffer(countBuffers[i].buffer, sizeof(uint32_t) * static_cast<VkDeviceSize>(viewCapacity) * batchCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &countBuffers[i].allocationId);
+		BufferTools::createBuffer(indirectBuffers[i].buffer, sizeof(VkDrawIndexedIndirectCommand) * static_cast<VkDeviceSize>(viewCapacity) * drawCommandCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &indirectBuffers[i].allocationId);
+
+		// Culling
+		{
+			cullingDescriptorSets[i].init(&cullingComputePipeline, 0);
+
+			VkDescriptorBufferInfo instancesInfo = {};
+			instancesInfo.buffer = instanceBuffers[i].buffer;
+			instancesInfo.offset = 0;
+			instancesInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo viewsInfo = {};
+			viewsInfo.buffer = viewBuffers[i].buffer;
+			viewsInfo.offset = 0;
+			viewsInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo countsInfo = {};
+			countsInfo.buffer = countBuffers[i].buffer;
+			countsInfo.offset = 0;
+			countsInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo visibleInstancesInfo = {};
+			visibleInstancesInfo.buffer = visibleInstanceBuffers.at(i).buffer;
+			visibleInstancesInfo.offset = 0;
+			visibleInstancesInfo.range = VK_WHOLE_SIZE;
+
+			std::vector<VkDescriptorBufferInfo*> buffersInfo = { &instancesInfo, &viewsInfo, &countsInfo, &visibleInstancesInfo };
+			std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+			for (uint32_t binding = 0; binding < static_cast<uint32_t>(buffersInfo.size()); binding++) {
+				VkWriteDescriptorSet writeDescriptorSet = {};
+				writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSet.pNext = nullptr;
+				writeDescriptorSet.dstSet = cullingDescriptorSets[i].descriptorSet;
+				writeDescriptorSet.dstBinding = binding;
+				writeDescriptorSet.dstArrayElement = 0;
+				writeDescriptorSet.descriptorCount = 1;
+				writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeDescriptorSet.pImageInfo = nullptr;
+				writeDescriptorSet.pBufferInfo = buffersInfo[binding];
+				writeDescriptorSet.pTexelBufferView = nullptr;
+				writesDescriptorSet.push_back(writeDescriptorSet);
+			}
+
+			cullingDescriptorSets[i].update(writesDescriptorSet);
+		}
+
+		// Draw commands
+		{
+			drawCommandsDescriptorSets[i].init(&drawCommandsComputePipeline, 0);
+
+			VkDescriptorBufferInfo drawCommandsInfo = {};
+			drawCommandsInfo.buffer = drawCommandBuffers[i].buffer;
+			drawCommandsInfo.offset = 0;
+			drawCommandsInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo countsInfo = {};
+			countsInfo.buffer = countBuffers[i].buffer;
+			countsInfo.offset = 0;
+			countsInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo indirectCommandsInfo = {};
+			indirectCommandsInfo.buffer = indirectBuffers[i].buffer;
+			indirectCommandsInfo.offset = 0;
+			indirectCommandsInfo.range = VK_WHOLE_SIZE;
+
+			std::vector<VkDescriptorBufferInfo*> buffersInfo = { &drawCommandsInfo, &countsInfo, &indirectCommandsInfo };
+			std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+			for (uint32_t binding = 0; binding < static_cast<uint32_t>(buffersInfo.size()); binding++) {
+				VkWriteDescriptorSet writeDescriptorSet = {};
+				writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSet.pNext = nullptr;
+				writeDescriptorSet.dstSet = drawCommandsDescriptorSets[i].descriptorSet;
+				writeDescriptorSet.dstBinding = binding;
+				writeDescriptorSet.dstArrayElement = 0;
+				writeDescriptorSet.descriptorCount = 1;
+				writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeDescriptorSet.pImageInfo = nullptr;
+				writeDescriptorSet.pBufferInfo = buffersInfo[binding];
+				writeDescriptorSet.pTexelBufferView = nullptr;
+				writesDescriptorSet.push_back(writeDescriptorSet);
+			}
+
+			drawCommandsDescriptorSets[i].update(writesDescriptorSet);
+		}
+	}
+}
+
+void GPUCulling::destroyResources() {
+	for (uint32_t i = 0; i < static_cast<uint32_t>(instanceBuffers.size()); i++) {
+		instanceBuffers[i].destroy();
+		viewBuffers[i].destroy();
+		drawCommandBuffers[i].destroy();
+		countBuffers[i].destroy();
+		indirectBuffers[i].destroy();
+		cullingDescriptorSets[i].destroy();
+		drawCommandsDescriptorSets[i].destroy();
+	}
+	instanceBuffers.clear();
+	viewBuffers.clear();
+	drawCommandBuffers.clear();
+	countBuffers.clear();
+	indirectBuffers.clear();
+	cullingDescriptorSets.clear();
+	drawCommandsDescriptorSets.clear();
+}
+
+void GPUCulling::writeView(CullingView* view, const Frustum& frustum, bool culled, float minCasterSize, CullingCasters casters) {
+	for (size_t p = 0; p < 6; p++) {
+		view->planes[p] = glm::vec4(frustum.a[p], frustum.b[p], frustum.c[p], frustum.d[p]);
+	}
+	view->minCasterSize = minCasterSize;
+	view->culled = culled ? 1 : 0;
+	view->casters = casters;
+	view->padding = 0;
+}
+
+void GPUCulling::dispatch(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex, uint32_t instanceCount, uint32_t viewCount, uint32_t batchCount, uint32_t drawCommandCount, VkBuffer visibleInstanceBuffer) {
+	// Counts start at zero every frame
+	vkCmdFillBuffer(commandBuffer->commandBuffer, countBuffers.at(frameInFlightIndex).buffer, 0, VK_WHOLE_SIZE, 0);
+
+	VkBufferMemoryBarrier clearBarrier = {};
+	clearBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	clearBarrier.pNext = nullptr;
+	clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	clearBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	clearBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	clearBarrier.buffer = countBuffers.at(frameInFlightIndex).buffer;
+	clearBarrier.offset = 0;
+	clearBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(commandBuffer->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &clearBarrier, 0, nullptr);
+
+	// One invocation per instance and view
+	uint32_t cullingConstants[2] = { instanceCount, batchCount };
+	cullingComputePipeline.bind(commandBuffer);
+	cullingDescriptorSets.at(frameInFlightIndex).bind(commandBuffer, 0);
+	cullingComputePipeline.pushConstant(commandBuffer, 0, sizeof(cullingConstants), cullingConstants);
+	cullingComputePipeline.dispatch(commandBuffer, (instanceCount + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE, viewCount, 1);
+
+	// Counts are read by the draw commands, visible instances by the vertex shaders
+	std::array<VkBufferMemoryBarrier, 2> cullingBarriers = {};
+	cullingBarriers[0].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	cullingBarriers[0].pNext = nullptr;
+	cullingBarriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	cullingBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	cullingBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	cullingBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	cullingBarriers[0].buffer = countBuffers.at(frameInFlightIndex).buffer;
+	cullingBarriers[0].offset = 0;
+	cullingBarriers[0].size = VK_WHOLE_SIZE;
+	cullingBarriers[1] = cullingBarriers[0];
+	cullingBarriers[1].buffer = visibleInstanceBuffer;
+	vkCmdPipelineBarrier(commandBuffer->commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 0, nullptr, static_cast<uint32_t>(cullingBarriers.size()), cullingBarriers.data(), 0, nullptr);
+
+	// One invocation per draw command and view
+	uint32_t drawCommandsConstants[3] = { drawCommandCount, instanceCount, batchCount };
+	drawCommandsComputePipeline.bind(commandBuffer);
+	drawCommandsDescriptorSets.at(frameInFlightIndex).bind(commandBuffer, 0);
+	drawCommandsComputePipeline.pushConstant(commandBuffer, 0, sizeof(drawCommandsConstants), drawCommandsConstants);
+	drawCommandsComputePipeline.dispatch(commandBuffer, (drawCommandCount + GPU_CULLING_GROUP_SIZE - 1) / GPU_CULLING_GROUP_SIZE, viewCount, 1);
+
+	VkBufferMemoryBarrier indirectBarrier = {};
+	indirectBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	indirectBarrier.pNext = nullptr;
+	indirectBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	indirectBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	indirectBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	indirectBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	indirectBarrier.buffer = indirectBuffers.at(frameInFlightIndex).buffer;
+	indirectBarrier.offset = 0;
+	indirectBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(commandBuffer->commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 1, &indirectBarrier, 0, nullptr);
+}
\ No newline at end of file
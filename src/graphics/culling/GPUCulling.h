@@ -0,0 +1,77 @@
+#pragma once
+#include "vulkan/vulkan.hpp"
+#include "../../utils/structs/RendererStructs.h"
+#include "../../../external/glm/glm/glm.hpp"
+#include "../commands/CommandBuffer.h"
+#include "../pipelines/ComputePipeline.h"
+#include "../pipelines/DescriptorSet.h"
+#include "../resources/Buffer.h"
+#include "Frustum.h"
+#include <array>
+#include <vector>
+
+#define GPU_CULLING_GROUP_SIZE 64
+
+// Instances a view draws, the camera draws every instance, the shadow maps their dynamic casters and the caches their static casters
+enum struct CullingCasters : uint32_t {
+	ALL,
+	DYNAMIC,
+	STATIC
+};
+
+// World space box of an instance, always visible instances are not tested
+struct CullingInstance {
+	glm::vec4 center;
+	glm::vec4 extent;
+	uint32_t batch;
+	uint32_t batchFirstInstance;
+	uint32_t dynamicCaster;
+	uint32_t alwaysVisible;
+};
+
+// Views that are not culled draw nothing, instances smaller than the minimum caster size are not drawn in the view
+struct CullingView {
+	glm::vec4 planes[6];
+	float minCasterSize;
+	uint32_t culled;
+	CullingCasters casters;
+	uint32_t padding;
+};
+
+// Draw command of one view with the instance batch it draws
+struct CullingDrawCommand {
+	VkDrawIndexedIndirectCommand drawCommand;
+	uint32_t batch;
+};
+
+// Frustum culling on the GPU, every view counts and packs its visible instances per batch, then the indirect draw commands of every view are written from the counts
+// Each view has a section of visible instances as large as the instances, where the ones of each batch are packed from its first instance
+struct GPUCulling {
+	ComputePipeline cullingComputePipeline;
+	ComputePipeline drawCommandsComputePipeline;
+	std::vector<DescriptorSet> cullingDescriptorSets;
+	std::vector<DescriptorSet> drawCommandsDescriptorSets;
+
+	// Written by the CPU, they stay mapped
+	std::vector<Buffer> instanceBuffers;
+	std::vector<Buffer> viewBuffers;
+	std::vector<Buffer> drawCommandBuffers;
+
+	// Visible instances per view and batch, then the draw commands of every view
+	std::vector<Buffer> countBuffers;
+	std::vector<Buffer> indirectBuffers;
+
+	uint32_t instanceCapacity = 0;
+	uint32_t viewCapacity = 0;
+	uint32_t batchCapacity = 0;
+	uint32_t drawCommandCapacity = 0;
+
+	void init();
+	void destroy();
+	void reload();
+	// Capacities, the visible instances buffers hold a section per view as large as the instances and the frames in flight must be done with the old resources
+	void createResources(uint32_t instanceCount, uint32_t viewCount, uint32_t batchCount, uint32_t drawCommandCount, const std::vector<Buffer>& visibleInstanceBuffers);
+	void destroyResources();
+	static void writeView(CullingView* view, const Frustum& frustum, bool culled, float minCasterSize, CullingCasters casters);
+	void dispatch(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex, uint32_t instanceCount, uint32_t viewCount, uint32_t batchCount, uint32_t drawCommandCount, VkBuffer visibleInstanceBuffer);
+};
\ No newline at end of file
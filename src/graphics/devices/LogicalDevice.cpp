@@ -24,6 +24,11 @@ void LogicalDevice::init() {
 	physicalDeviceFeatures.fillModeNonSolid = VK_TRUE;
 	physicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
 	physicalDeviceFeatures.sampleRateShading = VK_TRUE;
+	// GPU-driven rendering
+	physicalDeviceFeatures.multiDrawIndirect = physicalDevice.features.multiDrawIndirect;
+	physicalDeviceFeatures.drawIndirectFirstInstance = physicalDevice.features.drawIndirectFirstInstance;
+	// Shadow casters between the light and the near plane
+	physicalDeviceFeatures.depthClamp = physicalDevice.features.depthClamp;
 
 	// Logical device
 	VkDeviceCreateInfo deviceCreateInfo = {};
@@ -38,6 +38,13 @@ void PhysicalDevicePicker::pick(Window* window) {
 					preferredDeviceType = VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU;
 				}
 			}
+			else if (device.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) {
+				// Software rasterizer, only used when there is no GPU
+				if (preferredDeviceType == VK_PHYSICAL_DEVICE_TYPE_OTHER) {
+					preferredDevice = device;
+					preferredDeviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+				}
+			}
 		}
 	}
 	physicalDevice = preferredDevice;
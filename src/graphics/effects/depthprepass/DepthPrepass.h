@@ -11,11 +11,15 @@
 #include <vector>
 #include <random>
 
+// View-space normals, encoded in [0, 1]
+#define DEPTH_PREPASS_NORMAL_FORMAT VK_FORMAT_A2B10G10R10_UNORM_PACK32
+
 struct DepthPrepass {
 	Viewport viewport;
 	RenderPass renderPass;
 	GraphicsPipeline graphicsPipeline;
 	Image image;
+	Image normalImage;
 	std::vector<Framebuffer> framebuffers;
 
 	void init(Viewport fullscreenViewport);
@@ -67,10 +67,8 @@ void Envmap::destroy() {
 }
 
 void Envmap::draw(CommandBuffer* commandBuffer) {
-	VkDeviceSize offset = 0;
-
-	vkCmdBindVertexBuffers(commandBuffer->commandBuffer, 0, 1, &cubeVertexBuffer.buffer, &offset);
-	vkCmdBindIndexBuffer(commandBuffer->commandBuffer, cubeIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+	commandBuffer->bindVertexBuffer(cubeVertexBuffer.buffer);
+	commandBuffer->bindIndexBuffer(cubeIndexBuffer.buffer);
 
 	vkCmdDrawIndexed(commandBuffer->commandBuffer, 36, 1, 0, 0, 0);
 }
@@ -142,8 +140,6 @@ void Envmap::equilateralRectangleToCubemap() {
 	};
 
 	for (int face = 0; face < 6; face++) {
-		VkDeviceSize offset = 0;
-
 		CommandPool commandPool;
 		commandPool.init();
 		CommandBuffer commandBuffer;
@@ -159,8 +155,8 @@ void Envmap::equilateralRectangleToCubemap() {
 		equiRecToCubemapGraphicsPipeline.pushConstant(&commandBuffer, VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float), &viewProj);
 		equiRecToCubemapDescriptorSet.bind(&commandBuffer, 0);
 
-		vkCmdBindVertexBuffers(commandBuffer.commandBuffer, 0, 1, &cubeVertexBuffer.buffer, &offset);
-		vkCmdBindIndexBuffer(commandBuffer.commandBuffer, cubeIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+		commandBuffer.bindVertexBuffer(cubeVertexBuffer.buffer);
+		commandBuffer.bindIndexBuffer(cubeIndexBuffer.buffer);
 
 		vkCmdDrawIndexed(commandBuffer.commandBuffer, 36, 1, 0, 0, 0);
 
@@ -252,8 +248,6 @@ void Envmap::createDiffuseIradiance() {
 	};
 
 	for (int face = 0; face < 6; face++) {
-		VkDeviceSize offset = 0;
-
 		CommandPool commandPool;
 		commandPool.init();
 		CommandBuffer commandBuffer;
@@ -269,8 +263,8 @@ void Envmap::createDiffuseIradiance() {
 		convolveGraphicsPipeline.pushConstant(&commandBuffer, VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float), &viewProj);
 		convolveDescriptorSet.bind(&commandBuffer, 0);
 
-		vkCmdBindVertexBuffers(commandBuffer.commandBuffer, 0, 1, &cubeVertexBuffer.buffer, &offset);
-		vkCmdBindIndexBuffer(commandBuffer.commandBuffer, cubeIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+		commandBuffer.bindVertexBuffer(cubeVertexBuffer.buffer);
+		commandBuffer.bindIndexBuffer(cubeIndexBuffer.buffer);
 
 		vkCmdDrawIndexed(commandBuffer.commandBuffer, 36, 1, 0, 0, 0);
 
@@ -393,8 +387,6 @@ void Envmap::createPrefilter() {
 		};
 
 		for (int face = 0; face < 6; face++) {
-			VkDeviceSize offset = 0;
-
 			CommandPool commandPool;
 			commandPool.init();
 			CommandBuffer commandBuffer;
@@ -410,8 +402,8 @@ void Envmap::createPrefilter() {
 			prefilterGraphicsPipeline.pushConstant(&commandBuffer, VK_SHADER_STAGE_VERTEX_BIT, 0, 16 * sizeof(float), &viewProj);
 			prefilterDescriptorSet.bind(&commandBuffer, 0);
 
-			vkCmdBindVertexBuffers(commandBuffer.commandBuffer, 0, 1, &cubeVertexBuffer.buffer, &offset);
-			vkCmdBindIndexBuffer(commandBuffer.commandBuffer, cubeIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+			commandBuffer.bindVertexBuffer(cubeVertexBuffer.buffer);
+			commandBuffer.bindIndexBuffer(cubeIndexBuffer.buffer);
 
 			vkCmdDrawIndexed(commandBuffer.commandBuffer, 36, 1, 0, 0, 0);
 
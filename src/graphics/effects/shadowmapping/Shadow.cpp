@@ -1,16 +1,23 @@
 #include "Shadow.h"
 #include "../../../graphics/resources/RendererResources.h"
+#include <algorithm>
+#include <numeric>
 
 void Shadow::init() {
-	viewport.init(SHADOWMAP_WIDTH, SHADOWMAP_HEIGHT);
-
-	buffers.resize(MAX_FRAMES_IN_FLIGHT);
-	for (Buffer& buffer : buffers) {
-		BufferTools::createUniformBuffer(buffer.buffer, buffer.deviceMemory, sizeof(ShadowUniformBufferObject));
+	// Large enough for every shadow map at the highest resolution, up to the maximum size
+	atlasSize = SHADOW_TILE_MAX_SIZE;
+	while ((atlasSize < SHADOW_ATLAS_MAX_SIZE) && (static_cast<uint64_t>(atlasSize) * atlasSize < static_cast<uint64_t>(mapCount) * SHADOW_TILE_MAX_SIZE * SHADOW_TILE_MAX_SIZE)) {
+		atlasSize *= 2;
 	}
+	NEIGE_ASSERT(static_cast<uint64_t>(mapCount) * SHADOW_TILE_MIN_SIZE * SHADOW_TILE_MIN_SIZE <= static_cast<uint64_t>(atlasSize) * atlasSize, "Shadow atlas too small for " + std::to_string(mapCount) + " shadow maps.");
+
+	viewport.init(atlasSize, atlasSize);
+
+	// Every cascade is fitted on its first frame
+	cascades.assign(mapCount, { -1, glm::vec3(0.0f), glm::vec3(0.0f), 0, glm::mat4(1.0f), 0.0f, false });
 
 	std::vector<RenderPassAttachment> attachments;
-	attachments.push_back(RenderPassAttachment(AttachmentType::DEPTH, physicalDevice.depthFormat, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL));
+	attachments.push_back(RenderPassAttachment(AttachmentType::DEPTH, physicalDevice.depthFormat, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL));
 
 	std::vector<SubpassDependency> dependencies;
 	dependencies.push_back({ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_DEPENDENCY_BY_REGION_BIT });
@@ -18,32 +25,135 @@ void Shadow::init() {
 
 	renderPass.init(attachments, dependencies);
 
-	ImageTools::createImage(&defaultShadow.image, 1, 1, 1, 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &defaultShadow.allocationId);
-	ImageTools::createImageView(&defaultShadow.imageView, defaultShadow.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-	ImageTools::createImageSampler(&defaultShadow.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE, VK_COMPARE_OP_LESS);
-	ImageTools::transitionLayout(defaultShadow.image, physicalDevice.depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, 1, 1);
+	// The cache keeps its layout, its render pass can be skipped when no tile is rendered again
+	std::vector<RenderPassAttachment> cacheAttachments;
+	cacheAttachments.push_back(RenderPassAttachment(AttachmentType::DEPTH, physicalDevice.depthFormat, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+
+	cacheRenderPass.init(cacheAttachments, dependencies);
+
+	// Sampling is clamped to the tiles, the layout is handled by the render graph
+	ImageTools::createImage(&atlas.image, 1, atlasSize, atlasSize, 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &atlas.allocationId);
+	ImageTools::createImageView(&atlas.imageView, atlas.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+	ImageTools::createImageSampler(&atlas.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE, VK_COMPARE_OP_LESS);
+
+	std::vector<VkImageView> framebufferAttachments = { atlas.imageView };
+	framebuffer.init(&renderPass, framebufferAttachments, atlasSize, atlasSize, 1);
+
+	ImageTools::createImage(&cache.image, 1, atlasSize, atlasSize, 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &cache.allocationId);
+	ImageTools::createImageView(&cache.imageView, cache.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	std::vector<VkImageView> cacheFramebufferAttachments = { cache.imageView };
+	cacheFramebuffer.init(&cacheRenderPass, cacheFramebufferAttachments, atlasSize, atlasSize, 1);
 
 	graphicsPipeline.vertexShaderPath = "../shaders/shadow.vert";
 	graphicsPipeline.renderPass = &renderPass;
 	graphicsPipeline.viewport = &viewport;
 	graphicsPipeline.colorBlend = false;
 	graphicsPipeline.multiSample = false;
+	graphicsPipeline.depthClamp = physicalDevice.features.depthClamp;
 	graphicsPipeline.init();
 }
 
 void Shadow::destroy() {
 	renderPass.destroy();
 	graphicsPipeline.destroy();
-	for (Buffer& buffer : buffers) {
-		buffer.destroy();
+	atlas.destroy();
+	framebuffer.destroy();
+	cacheRenderPass.destroy();
+	cache.destroy();
+	cacheFramebuffer.destroy();
+}
+
+void Shadow::packAtlas() {
+	// Tiles are halved while the light covers at most half of their resolution
+	std::vector<uint32_t> sizes(coverages.size());
+	uint64_t area = 0;
+	for (size_t i = 0; i < coverages.size(); i++) {
+		uint32_t size = SHADOW_TILE_MAX_SIZE;
+		while ((size > SHADOW_TILE_MIN_SIZE) && (coverages[i] * SHADOW_TILE_MAX_SIZE <= static_cast<float>(size / 2))) {
+			size /= 2;
+		}
+		sizes[i] = size;
+		area += static_cast<uint64_t>(size) * size;
 	}
-	defaultShadow.destroy();
-	for (Image& image : images) {
-		image.destroy();
+
+	// Over budget, the largest tiles lose resolution first, the last shadow maps on ties so the farthest cascades go before the nearest
+	while (area > static_cast<uint64_t>(atlasSize) * atlasSize) {
+		size_t largest = sizes.size() - 1 - (std::max_element(sizes.rbegin(), sizes.rend()) - sizes.rbegin());
+		area -= (static_cast<uint64_t>(sizes[largest]) * sizes[largest] * 3) / 4;
+		sizes[largest] /= 2;
 	}
-	for (size_t i = 0; i < framebuffers.size(); i++) {
-		for (Framebuffer& framebuffer : framebuffers[i]) {
-			framebuffer.destroy();
+
+	// From the largest tile, each one starts where the previous ones end in Morton order, which keeps it aligned on its size
+	std::vector<uint32_t> order(coverages.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sizes](uint32_t a, uint32_t b) {
+		return sizes[a] > sizes[b];
+	});
+
+	tiles.resize(coverages.size());
+	uint32_t cell = 0;
+	for (uint32_t index : order) {
+		uint32_t x = 0;
+		uint32_t y = 0;
+		for (uint32_t bit = 0; bit < 16; bit++) {
+			x |= ((cell >> (2 * bit)) & 1) << bit;
+			y |= ((cell >> ((2 * bit) + 1)) & 1) << bit;
+		}
+
+		tiles[index].init(sizes[index], sizes[index]);
+		tiles[index].viewport.x = static_cast<float>(x * SHADOW_TILE_MIN_SIZE);
+		tiles[index].viewport.y = static_cast<float>(y * SHADOW_TILE_MIN_SIZE);
+		tiles[index].scissor.offset = { static_cast<int32_t>(x * SHADOW_TILE_MIN_SIZE), static_cast<int32_t>(y * SHADOW_TILE_MIN_SIZE) };
+
+		uint32_t cellsPerSide = sizes[index] / SHADOW_TILE_MIN_SIZE;
+		cell += cellsPerSide * cellsPerSide;
+	}
+}
+
+
+void Shadow::invalidateCaches(const glm::mat4* lightSpaces, bool staticCastersChanged) {
+	cachedLightSpaces.resize(tiles.size());
+	cachedTiles.resize(tiles.size(), {});
+
+	staleCaches.clear();
+	drawnTiles.clear();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(tiles.size()); i++) {
+		const VkRect2D& tile = tiles[i].scissor;
+		const VkRect2D& cachedTile = cachedTiles[i];
+		bool tileChanged = (tile.offset.x != cachedTile.offset.x) || (tile.offset.y != cachedTile.offset.y) || (tile.extent.width != cachedTile.extent.width) || (tile.extent.height != cachedTile.extent.height);
+
+		bool stale = staticCastersChanged || tileChanged || (lightSpaces[i] != cachedLightSpaces[i]);
+		if (stale) {
+			cachedLightSpaces[i] = lightSpaces[i];
+			cachedTiles[i] = tile;
+			staleCaches.push_back(i);
+		}
+
+		// A cascade that was not fitted again keeps its tile of the last frame, unless its static casters are drawn again
+		if (stale || (cascades[i].index < 0) || cascades[i].fitted) {
+			drawnTiles.push_back(i);
 		}
 	}
 }
+
+void Shadow::copyCache(CommandBuffer* commandBuffer) {
+	std::vector<VkImageCopy> regions;
+	for (uint32_t drawnTile : drawnTiles) {
+		const Viewport& tile = tiles[drawnTile];
+		VkImageCopy region = {};
+		region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		region.srcSubresource.mipLevel = 0;
+		region.srcSubresource.baseArrayLayer = 0;
+		region.srcSubresource.layerCount = 1;
+		region.srcOffset = { tile.scissor.offset.x, tile.scissor.offset.y, 0 };
+		region.dstSubresource = region.srcSubresource;
+		region.dstOffset = region.srcOffset;
+		region.extent = { tile.scissor.extent.width, tile.scissor.extent.height, 1 };
+		regions.push_back(region);
+	}
+
+	if (!regions.empty()) {
+		vkCmdCopyImage(commandBuffer->commandBuffer, cache.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, atlas.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+	}
+}
\ No newline at end of file
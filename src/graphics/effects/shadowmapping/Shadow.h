@@ -1,5 +1,6 @@
 #pragma once
 #include "vulkan/vulkan.hpp"
+#include "../../../../external/glm/glm/glm.hpp"
 #include "../../../utils/structs/RendererStructs.h"
 #include "../../pipelines/Viewport.h"
 #include "../../pipelines/GraphicsPipeline.h"
@@ -10,16 +11,53 @@
 #include "../../../utils/resources/BufferTools.h"
 #include "../../../utils/resources/ImageTools.h"
 
+// Shadow map of a slice of the camera frustum for a directional light, its light space is kept until it is fitted again
+struct ShadowCascade {
+	// Cascade of the light, -1 when the shadow map is not a cascade
+	int index;
+	glm::vec3 direction;
+	// Light direction and tile size of the last fit
+	glm::vec3 fittedDirection;
+	uint32_t fittedTileSize;
+	glm::mat4 lightSpace;
+	float texelSize;
+	// Fitted on this frame, otherwise its tile keeps the dynamic casters of the last frame it was drawn
+	bool fitted;
+};
+
 struct Shadow {
 	Viewport viewport;
 	GraphicsPipeline graphicsPipeline;
-	std::vector<Buffer> buffers;
-	std::vector<Image> images;
+	// In the frame uniforms
+	VkDeviceSize uniformOffset;
+	// Every shadow map is a tile of the atlas, packed again every frame
+	Image atlas;
+	uint32_t atlasSize;
 	RenderPass renderPass;
-	std::vector<std::vector<Framebuffer>> framebuffers;
-	Image defaultShadow;
+	Framebuffer framebuffer;
+	std::vector<float> coverages;
+	std::vector<Viewport> tiles;
 	int mapCount;
 
+	// Static casters of every shadow map, copied under the dynamic casters of the drawn tiles
+	// A tile of the cache is only rendered again when its light space, its place in the atlas or the static casters change
+	Image cache;
+	RenderPass cacheRenderPass;
+	Framebuffer cacheFramebuffer;
+	std::vector<glm::mat4> cachedLightSpaces;
+	std::vector<VkRect2D> cachedTiles;
+	std::vector<uint32_t> staleCaches;
+	// Tiles whose dynamic casters are drawn on this frame, the others keep their content in the atlas
+	std::vector<uint32_t> drawnTiles;
+
+	// One per shadow map, the farthest cascades are fitted every few frames and keep their light space and their cache in between
+	std::vector<ShadowCascade> cascades;
+	glm::vec4 cascadeSplits;
+	uint32_t cascadeFrame = 0;
+
 	void init();
 	void destroy();
+	void packAtlas();
+	void invalidateCaches(const glm::mat4* lightSpaces, bool staticCastersChanged);
+	void copyCache(CommandBuffer* commandBuffer);
 };
\ No newline at end of file
@@ -7,230 +7,78 @@
 void SSAO::init(Viewport fullscreenViewport) {
 	viewport.init(static_cast<uint32_t>(fullscreenViewport.viewport.width) / DOWNSCALE, static_cast<uint32_t>(fullscreenViewport.viewport.height) / DOWNSCALE);
 
-	{
-		std::vector<RenderPassAttachment> attachments;
-		attachments.push_back(RenderPassAttachment(AttachmentType::COLOR, physicalDevice.colorFormat, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+	ssaoComputePipeline.computeShaderPath = "../shaders/ssao.comp";
+	ssaoComputePipeline.init();
 
-		std::vector<SubpassDependency> dependencies;
-		dependencies.push_back({ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, VK_ACCESS_SHADER_READ_BIT, VK_DEPENDENCY_BY_REGION_BIT });
-		
-		colorRenderPass.init(attachments, dependencies);
-	}
-	
-	depthToNormalsGraphicsPipeline.vertexShaderPath = "../shaders/fullscreenTriangle.vert";
-	depthToNormalsGraphicsPipeline.fragmentShaderPath = "../shaders/depthToNormals.frag";
-	depthToNormalsGraphicsPipeline.renderPass = &colorRenderPass;
-	depthToNormalsGraphicsPipeline.viewport = &viewport;
-	depthToNormalsGraphicsPipeline.colorBlend = false;
-	depthToNormalsGraphicsPipeline.multiSample = false;
-	depthToNormalsGraphicsPipeline.backfaceCulling = false;
-	depthToNormalsGraphicsPipeline.init();
-
-	depthToPositionsGraphicsPipeline.vertexShaderPath = "../shaders/fullscreenTriangle.vert";
-	depthToPositionsGraphicsPipeline.fragmentShaderPath = "../shaders/depthToPositions.frag";
-	depthToPositionsGraphicsPipeline.renderPass = &colorRenderPass;
-	depthToPositionsGraphicsPipeline.viewport = &viewport;
-	depthToPositionsGraphicsPipeline.colorBlend = false;
-	depthToPositionsGraphicsPipeline.multiSample = false;
-	depthToPositionsGraphicsPipeline.backfaceCulling = false;
-	depthToPositionsGraphicsPipeline.init();
-
-	ssaoGraphicsPipeline.vertexShaderPath = "../shaders/fullscreenTriangle.vert";
-	ssaoGraphicsPipeline.fragmentShaderPath = "../shaders/ssao.frag";
-	ssaoGraphicsPipeline.renderPass = &colorRenderPass;
-	ssaoGraphicsPipeline.viewport = &viewport;
-	ssaoGraphicsPipeline.colorBlend = false;
-	ssaoGraphicsPipeline.multiSample = false;
-	ssaoGraphicsPipeline.backfaceCulling = false;
-	ssaoGraphicsPipeline.init();
-
-	ssaoBlurredGraphicsPipeline.vertexShaderPath = "../shaders/fullscreenTriangle.vert";
-	ssaoBlurredGraphicsPipeline.fragmentShaderPath = "../shaders/ssaoBlur.frag";
-	ssaoBlurredGraphicsPipeline.renderPass = &colorRenderPass;
-	ssaoBlurredGraphicsPipeline.viewport = &viewport;
-	ssaoBlurredGraphicsPipeline.colorBlend = false;
-	ssaoBlurredGraphicsPipeline.multiSample = false;
-	ssaoBlurredGraphicsPipeline.backfaceCulling = false;
-	ssaoBlurredGraphicsPipeline.init();
+	ssaoBlurComputePipeline.computeShaderPath = "../shaders/ssaoBlur.comp";
+	ssaoBlurComputePipeline.init();
 
 	BufferTools::createUniformBuffer(sampleKernel.buffer, sampleKernel.deviceMemory, SSAOSAMPLES * 4 * sizeof(float));
 
-	createRandomTexture();
-
-	createResources(fullscreenViewport);
+	createSampleKernel();
 }
 
 void SSAO::destroy() {
 	destroyResources();
 	sampleKernel.destroy();
-	randomTexture.destroy();
-	colorRenderPass.destroy();
-	depthToNormalsGraphicsPipeline.destroy();
-	depthToPositionsGraphicsPipeline.destroy();
-	ssaoGraphicsPipeline.destroy();
-	ssaoBlurredGraphicsPipeline.destroy();
+	ssaoComputePipeline.destroy();
+	ssaoBlurComputePipeline.destroy();
 }
 
 void SSAO::createResources(Viewport fullscreenViewport) {
 	viewport.init(static_cast<uint32_t>(fullscreenViewport.viewport.width) / DOWNSCALE, static_cast<uint32_t>(fullscreenViewport.viewport.height) / DOWNSCALE);
-	
-	// Images
-	ImageTools::createImage(&depthToPositionsImage.image, 1, static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthToPositionsImage.allocationId);
-	ImageTools::createImageView(&depthToPositionsImage.imageView, depthToPositionsImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-	ImageTools::createImageSampler(&depthToPositionsImage.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
-	ImageTools::transitionLayout(depthToPositionsImage.image, physicalDevice.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-
-	ImageTools::createImage(&depthToNormalsImage.image, 1, static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthToNormalsImage.allocationId);
-	ImageTools::createImageView(&depthToNormalsImage.imageView, depthToNormalsImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-	ImageTools::createImageSampler(&depthToNormalsImage.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
-	ImageTools::transitionLayout(depthToNormalsImage.image, physicalDevice.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-
-	ImageTools::createImage(&ssaoImage.image, 1, static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &ssaoImage.allocationId);
-	ImageTools::createImageView(&ssaoImage.imageView, ssaoImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-	ImageTools::createImageSampler(&ssaoImage.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
-	ImageTools::transitionLayout(ssaoImage.image, physicalDevice.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-
-	ImageTools::createImage(&ssaoBlurredImage.image, 1, static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1, VK_SAMPLE_COUNT_1_BIT, physicalDevice.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &ssaoBlurredImage.allocationId);
-	ImageTools::createImageView(&ssaoBlurredImage.imageView, ssaoBlurredImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-	ImageTools::createImageSampler(&ssaoBlurredImage.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
-	ImageTools::transitionLayout(ssaoBlurredImage.image, physicalDevice.colorFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
-
-	// Framebuffers
-	depthToPositionsFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	depthToNormalsFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	ssaoFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	ssaoBlurredFramebuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-	{
-		std::vector<std::vector<VkImageView>> framebufferAttachements;
-		framebufferAttachements.resize(MAX_FRAMES_IN_FLIGHT);
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			framebufferAttachements[i].push_back(depthToPositionsImage.imageView);
-			depthToPositionsFramebuffers[i].init(&colorRenderPass, framebufferAttachements[i], static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1);
-		}
-	}
-
-	{
-		std::vector<std::vector<VkImageView>> framebufferAttachements;
-		framebufferAttachements.resize(MAX_FRAMES_IN_FLIGHT);
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			framebufferAttachements[i].push_back(depthToNormalsImage.imageView);
-			depthToNormalsFramebuffers[i].init(&colorRenderPass, framebufferAttachements[i], static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1);
-		}
-	}
-
-	{
-		std::vector<std::vector<VkImageView>> framebufferAttachements;
-		framebufferAttachements.resize(MAX_FRAMES_IN_FLIGHT);
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			framebufferAttachements[i].push_back(ssaoImage.imageView);
-			ssaoFramebuffers[i].init(&colorRenderPass, framebufferAttachements[i], static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1);
-		}
-	}
-
-	{
-		std::vector<std::vector<VkImageView>> framebufferAttachements;
-		framebufferAttachements.resize(MAX_FRAMES_IN_FLIGHT);
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			framebufferAttachements[i].push_back(ssaoBlurredImage.imageView);
-			ssaoBlurredFramebuffers[i].init(&colorRenderPass, framebufferAttachements[i], static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height), 1);
-		}
-	}
-
-	// Descriptor sets
-	{
-		depthToPositionsAndNormalsDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			depthToPositionsAndNormalsDescriptorSets[i].init(&depthToNormalsGraphicsPipeline, 0);
-
-			VkDescriptorImageInfo depthPrepassInfo = {};
-			depthPrepassInfo.sampler = depthPrepass.image.imageSampler;
-			depthPrepassInfo.imageView = depthPrepass.image.imageView;
-			depthPrepassInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-
-			VkDescriptorBufferInfo cameraInfo = {};
-			cameraInfo.buffer = cameraBuffers[i].buffer;
-			cameraInfo.offset = 0;
-			cameraInfo.range = sizeof(CameraUniformBufferObject);
-
-			std::vector<VkWriteDescriptorSet> writesDescriptorSet;
-
-			VkWriteDescriptorSet depthPrepassWriteDescriptorSet = {};
-			depthPrepassWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			depthPrepassWriteDescriptorSet.pNext = nullptr;
-			depthPrepassWriteDescriptorSet.dstSet = depthToPositionsAndNormalsDescriptorSets[i].descriptorSet;
-			depthPrepassWriteDescriptorSet.dstBinding = 0;
-			depthPrepassWriteDescriptorSet.dstArrayElement = 0;
-			depthPrepassWriteDescriptorSet.descriptorCount = 1;
-			depthPrepassWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			depthPrepassWriteDescriptorSet.pImageInfo = &depthPrepassInfo;
-			depthPrepassWriteDescriptorSet.pBufferInfo = nullptr;
-			depthPrepassWriteDescriptorSet.pTexelBufferView = nullptr;
-			writesDescriptorSet.push_back(depthPrepassWriteDescriptorSet);
-
-			VkWriteDescriptorSet cameraWriteDescriptorSet = {};
-			cameraWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			cameraWriteDescriptorSet.pNext = nullptr;
-			cameraWriteDescriptorSet.dstSet = depthToPositionsAndNormalsDescriptorSets[i].descriptorSet;
-			cameraWriteDescriptorSet.dstBinding = 1;
-			cameraWriteDescriptorSet.dstArrayElement = 0;
-			cameraWriteDescriptorSet.descriptorCount = 1;
-			cameraWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			cameraWriteDescriptorSet.pImageInfo = nullptr;
-			cameraWriteDescriptorSet.pBufferInfo = &cameraInfo;
-			cameraWriteDescriptorSet.pTexelBufferView = nullptr;
-			writesDescriptorSet.push_back(cameraWriteDescriptorSet);
-
-			depthToPositionsAndNormalsDescriptorSets[i].update(writesDescriptorSet);
-		}
-	}
 
+	// Descriptor sets, the images are created by the render graph
 	{
 		ssaoDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			ssaoDescriptorSets[i].init(&ssaoGraphicsPipeline, 0);
+			ssaoDescriptorSets[i].init(&ssaoComputePipeline, 0);
 
-			VkDescriptorImageInfo positionInfo = {};
-			positionInfo.sampler = depthToPositionsImage.imageSampler;
-			positionInfo.imageView = depthToPositionsImage.imageView;
-			positionInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			VkDescriptorImageInfo depthInfo = {};
+			depthInfo.sampler = depthPrepass.image.imageSampler;
+			depthInfo.imageView = depthPrepass.image.imageView;
+			depthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
 			VkDescriptorImageInfo normalInfo = {};
-			normalInfo.sampler = depthToNormalsImage.imageSampler;
-			normalInfo.imageView = depthToNormalsImage.imageView;
+			normalInfo.sampler = depthPrepass.normalImage.imageSampler;
+			normalInfo.imageView = depthPrepass.normalImage.imageView;
 			normalInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			VkDescriptorImageInfo randomTextureInfo = {};
-			randomTextureInfo.sampler = randomTexture.imageSampler;
-			randomTextureInfo.imageView = randomTexture.imageView;
-			randomTextureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			VkDescriptorImageInfo historyInfo = {};
+			historyInfo.sampler = historyImage.imageSampler;
+			historyInfo.imageView = historyImage.imageView;
+			historyInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 			VkDescriptorBufferInfo sampleKernelInfo = {};
 			sampleKernelInfo.buffer = sampleKernel.buffer;
 			sampleKernelInfo.offset = 0;
 			sampleKernelInfo.range = SSAOSAMPLES * 4 * sizeof(float);
 
-			VkDescriptorBufferInfo cameraInfo = {};
-			cameraInfo.buffer = cameraBuffers[i].buffer;
-			cameraInfo.offset = 0;
-			cameraInfo.range = sizeof(CameraUniformBufferObject);
+			VkDescriptorBufferInfo ssaoUniformInfo = {};
+			ssaoUniformInfo.buffer = frameUniforms.buffer.buffer;
+			ssaoUniformInfo.offset = frameUniforms.offset(i, uniformOffset);
+			ssaoUniformInfo.range = sizeof(SSAOUniformBufferObject);
+
+			VkDescriptorImageInfo ssaoInfo = {};
+			ssaoInfo.sampler = VK_NULL_HANDLE;
+			ssaoInfo.imageView = ssaoImage.imageView;
+			ssaoInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
 			std::vector<VkWriteDescriptorSet> writesDescriptorSet;
 
-			VkWriteDescriptorSet positionWriteDescriptorSet = {};
-			positionWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			positionWriteDescriptorSet.pNext = nullptr;
-			positionWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
-			positionWriteDescriptorSet.dstBinding = 0;
-			positionWriteDescriptorSet.dstArrayElement = 0;
-			positionWriteDescriptorSet.descriptorCount = 1;
-			positionWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			positionWriteDescriptorSet.pImageInfo = &positionInfo;
-			positionWriteDescriptorSet.pBufferInfo = nullptr;
-			positionWriteDescriptorSet.pTexelBufferView = nullptr;
-			writesDescriptorSet.push_back(positionWriteDescriptorSet);
+			VkWriteDescriptorSet depthWriteDescriptorSet = {};
+			depthWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			depthWriteDescriptorSet.pNext = nullptr;
+			depthWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
+			depthWriteDescriptorSet.dstBinding = 0;
+			depthWriteDescriptorSet.dstArrayElement = 0;
+			depthWriteDescriptorSet.descriptorCount = 1;
+			depthWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			depthWriteDescriptorSet.pImageInfo = &depthInfo;
+			depthWriteDescriptorSet.pBufferInfo = nullptr;
+			depthWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(depthWriteDescriptorSet);
 
 			VkWriteDescriptorSet normalWriteDescriptorSet = {};
 			normalWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -245,18 +93,18 @@ void SSAO::createResources(Viewport fullscreenViewport) {
 			normalWriteDescriptorSet.pTexelBufferView = nullptr;
 			writesDescriptorSet.push_back(normalWriteDescriptorSet);
 
-			VkWriteDescriptorSet randomTextureWriteDescriptorSet = {};
-			randomTextureWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			randomTextureWriteDescriptorSet.pNext = nullptr;
-			randomTextureWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
-			randomTextureWriteDescriptorSet.dstBinding = 2;
-			randomTextureWriteDescriptorSet.dstArrayElement = 0;
-			randomTextureWriteDescriptorSet.descriptorCount = 1;
-			randomTextureWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			randomTextureWriteDescriptorSet.pImageInfo = &randomTextureInfo;
-			randomTextureWriteDescriptorSet.pBufferInfo = nullptr;
-			randomTextureWriteDescriptorSet.pTexelBufferView = nullptr;
-			writesDescriptorSet.push_back(randomTextureWriteDescriptorSet);
+			VkWriteDescriptorSet historyWriteDescriptorSet = {};
+			historyWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			historyWriteDescriptorSet.pNext = nullptr;
+			historyWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
+			historyWriteDescriptorSet.dstBinding = 2;
+			historyWriteDescriptorSet.dstArrayElement = 0;
+			historyWriteDescriptorSet.descriptorCount = 1;
+			historyWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			historyWriteDescriptorSet.pImageInfo = &historyInfo;
+			historyWriteDescriptorSet.pBufferInfo = nullptr;
+			historyWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(historyWriteDescriptorSet);
 
 			VkWriteDescriptorSet sampleKernelWriteDescriptorSet = {};
 			sampleKernelWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -271,97 +119,136 @@ void SSAO::createResources(Viewport fullscreenViewport) {
 			sampleKernelWriteDescriptorSet.pTexelBufferView = nullptr;
 			writesDescriptorSet.push_back(sampleKernelWriteDescriptorSet);
 
-			VkWriteDescriptorSet cameraWriteDescriptorSet = {};
-			cameraWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			cameraWriteDescriptorSet.pNext = nullptr;
-			cameraWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
-			cameraWriteDescriptorSet.dstBinding = 4;
-			cameraWriteDescriptorSet.dstArrayElement = 0;
-			cameraWriteDescriptorSet.descriptorCount = 1;
-			cameraWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			cameraWriteDescriptorSet.pImageInfo = nullptr;
-			cameraWriteDescriptorSet.pBufferInfo = &cameraInfo;
-			cameraWriteDescriptorSet.pTexelBufferView = nullptr;
-			writesDescriptorSet.push_back(cameraWriteDescriptorSet);
+			VkWriteDescriptorSet ssaoUniformWriteDescriptorSet = {};
+			ssaoUniformWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			ssaoUniformWriteDescriptorSet.pNext = nullptr;
+			ssaoUniformWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
+			ssaoUniformWriteDescriptorSet.dstBinding = 4;
+			ssaoUniformWriteDescriptorSet.dstArrayElement = 0;
+			ssaoUniformWriteDescriptorSet.descriptorCount = 1;
+			ssaoUniformWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			ssaoUniformWriteDescriptorSet.pImageInfo = nullptr;
+			ssaoUniformWriteDescriptorSet.pBufferInfo = &ssaoUniformInfo;
+			ssaoUniformWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(ssaoUniformWriteDescriptorSet);
+
+			VkWriteDescriptorSet ssaoWriteDescriptorSet = {};
+			ssaoWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			ssaoWriteDescriptorSet.pNext = nullptr;
+			ssaoWriteDescriptorSet.dstSet = ssaoDescriptorSets[i].descriptorSet;
+			ssaoWriteDescriptorSet.dstBinding = 5;
+			ssaoWriteDescriptorSet.dstArrayElement = 0;
+			ssaoWriteDescriptorSet.descriptorCount = 1;
+			ssaoWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			ssaoWriteDescriptorSet.pImageInfo = &ssaoInfo;
+			ssaoWriteDescriptorSet.pBufferInfo = nullptr;
+			ssaoWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(ssaoWriteDescriptorSet);
 
 			ssaoDescriptorSets[i].update(writesDescriptorSet);
 		}
+	}
 
-		{
-			ssaoBlurredDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-
-			for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-				ssaoBlurredDescriptorSets[i].init(&ssaoBlurredGraphicsPipeline, 0);
-
-				VkDescriptorImageInfo ssaoInfo = {};
-				ssaoInfo.sampler = ssaoImage.imageSampler;
-				ssaoInfo.imageView = ssaoImage.imageView;
-				ssaoInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-				std::vector<VkWriteDescriptorSet> writesDescriptorSet;
-
-				VkWriteDescriptorSet ssaoWriteDescriptorSet = {};
-				ssaoWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				ssaoWriteDescriptorSet.pNext = nullptr;
-				ssaoWriteDescriptorSet.dstSet = ssaoBlurredDescriptorSets[i].descriptorSet;
-				ssaoWriteDescriptorSet.dstBinding = 0;
-				ssaoWriteDescriptorSet.dstArrayElement = 0;
-				ssaoWriteDescriptorSet.descriptorCount = 1;
-				ssaoWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				ssaoWriteDescriptorSet.pImageInfo = &ssaoInfo;
-				ssaoWriteDescriptorSet.pBufferInfo = nullptr;
-				ssaoWriteDescriptorSet.pTexelBufferView = nullptr;
-				writesDescriptorSet.push_back(ssaoWriteDescriptorSet);
-
-				ssaoBlurredDescriptorSets[i].update(writesDescriptorSet);
-			}
+	// Both blur directions bind the history, only the horizontal one stores to it
+	{
+		VkDescriptorImageInfo historyInfo = {};
+		historyInfo.sampler = VK_NULL_HANDLE;
+		historyInfo.imageView = historyImage.imageView;
+		historyInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		// Horizontal then vertical
+		std::vector<Image*> inputs = { &ssaoImage, &ssaoBlurHorizontalImage };
+		std::vector<Image*> outputs = { &ssaoBlurHorizontalImage, &ssaoBlurredImage };
+		ssaoBlurDescriptorSets.resize(2);
+
+		for (size_t i = 0; i < 2; i++) {
+			DescriptorSet* descriptorSet = &ssaoBlurDescriptorSets[i];
+			descriptorSet->init(&ssaoBlurComputePipeline, 0);
+
+			VkDescriptorImageInfo inputInfo = {};
+			inputInfo.sampler = inputs[i]->imageSampler;
+			inputInfo.imageView = inputs[i]->imageView;
+			inputInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			VkDescriptorImageInfo outputInfo = {};
+			outputInfo.sampler = VK_NULL_HANDLE;
+			outputInfo.imageView = outputs[i]->imageView;
+			outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			std::vector<VkWriteDescriptorSet> writesDescriptorSet;
+
+			VkWriteDescriptorSet inputWriteDescriptorSet = {};
+			inputWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			inputWriteDescriptorSet.pNext = nullptr;
+			inputWriteDescriptorSet.dstSet = descriptorSet->descriptorSet;
+			inputWriteDescriptorSet.dstBinding = 0;
+			inputWriteDescriptorSet.dstArrayElement = 0;
+			inputWriteDescriptorSet.descriptorCount = 1;
+			inputWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			inputWriteDescriptorSet.pImageInfo = &inputInfo;
+			inputWriteDescriptorSet.pBufferInfo = nullptr;
+			inputWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(inputWriteDescriptorSet);
+
+			VkWriteDescriptorSet outputWriteDescriptorSet = {};
+			outputWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			outputWriteDescriptorSet.pNext = nullptr;
+			outputWriteDescriptorSet.dstSet = descriptorSet->descriptorSet;
+			outputWriteDescriptorSet.dstBinding = 1;
+			outputWriteDescriptorSet.dstArrayElement = 0;
+			outputWriteDescriptorSet.descriptorCount = 1;
+			outputWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			outputWriteDescriptorSet.pImageInfo = &outputInfo;
+			outputWriteDescriptorSet.pBufferInfo = nullptr;
+			outputWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(outputWriteDescriptorSet);
+
+			VkWriteDescriptorSet historyWriteDescriptorSet = {};
+			historyWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			historyWriteDescriptorSet.pNext = nullptr;
+			historyWriteDescriptorSet.dstSet = descriptorSet->descriptorSet;
+			historyWriteDescriptorSet.dstBinding = 2;
+			historyWriteDescriptorSet.dstArrayElement = 0;
+			historyWriteDescriptorSet.descriptorCount = 1;
+			historyWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			historyWriteDescriptorSet.pImageInfo = &historyInfo;
+			historyWriteDescriptorSet.pBufferInfo = nullptr;
+			historyWriteDescriptorSet.pTexelBufferView = nullptr;
+			writesDescriptorSet.push_back(historyWriteDescriptorSet);
+
+			descriptorSet->update(writesDescriptorSet);
 		}
 	}
 }
 
 void SSAO::destroyResources() {
-	depthToPositionsImage.destroy();
-	depthToNormalsImage.destroy();
-	ssaoImage.destroy();
-	ssaoBlurredImage.destroy();
-	for (Framebuffer& framebuffer : depthToPositionsFramebuffers) {
-		framebuffer.destroy();
-	}
-	depthToPositionsFramebuffers.clear();
-	depthToPositionsFramebuffers.shrink_to_fit();
-	for (Framebuffer& framebuffer : depthToNormalsFramebuffers) {
-		framebuffer.destroy();
+	for (DescriptorSet& descriptorSet : ssaoDescriptorSets) {
+		descriptorSet.destroy();
 	}
-	depthToNormalsFramebuffers.clear();
-	depthToNormalsFramebuffers.shrink_to_fit();
-	for (Framebuffer& framebuffer : ssaoFramebuffers) {
-		framebuffer.destroy();
+	ssaoDescriptorSets.clear();
+	ssaoDescriptorSets.shrink_to_fit();
+	for (DescriptorSet& descriptorSet : ssaoBlurDescriptorSets) {
+		descriptorSet.destroy();
 	}
-	ssaoFramebuffers.clear();
-	ssaoFramebuffers.shrink_to_fit();
-	for (Framebuffer& framebuffer : ssaoBlurredFramebuffers) {
-		framebuffer.destroy();
-	}
-	ssaoBlurredFramebuffers.clear();
-	ssaoBlurredFramebuffers.shrink_to_fit();
+	ssaoBlurDescriptorSets.clear();
+	ssaoBlurDescriptorSets.shrink_to_fit();
+	historyImage.destroy();
 }
 
-void SSAO::createRandomTexture() {
+void SSAO::createSampleKernel() {
 	std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
 	std::default_random_engine gen;
 
 	std::vector<glm::vec4> samples;
-	float randomRotations[64];
 
 	for (unsigned char i = 0; i < SSAOSAMPLES; i++) {
-		// Sample kernel
 		glm::vec3 sample{ randomFloats(gen) * 2.0f - 1.0f,
 		randomFloats(gen) * 2.0f - 1.0f,
 		randomFloats(gen) };
 		sample = glm::normalize(sample);
 		sample *= randomFloats(gen);
 
-		float scale = static_cast<float>(i) / 64.0f;
+		float scale = static_cast<float>(i) / static_cast<float>(SSAOSAMPLES);
 		// Lerp
 		scale = 0.1f + (scale * scale) * (1.0f - 0.1f);
 
@@ -375,61 +262,79 @@ void SSAO::createRandomTexture() {
 	sampleKernel.map(0, size, &data);
 	memcpy(data, samples.data(), size);
 	sampleKernel.unmap();
-
-	for (unsigned char i = 0; i < 16; i++) {
-		// Random rotation
-		randomRotations[(i * 4) + 0] = randomFloats(gen) * 2.0f - 1.0f;
-		randomRotations[(i * 4) + 1] = randomFloats(gen) * 2.0f - 1.0f;
-		randomRotations[(i * 4) + 2] = 0.0f;
-		randomRotations[(i * 4) + 3] = 1.0f;
-	}
-
-	ImageTools::loadColorArray(randomRotations, &randomTexture.image, 4, 4, physicalDevice.colorFormat, &randomTexture.mipmapLevels, &randomTexture.allocationId);
-	ImageTools::createImageView(&randomTexture.imageView, randomTexture.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, physicalDevice.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
-	ImageTools::createImageSampler(&randomTexture.imageSampler, 1, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
 }
 
-void SSAO::draw(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
-	// Depth to positions
-	colorRenderPass.begin(commandBuffer, depthToPositionsFramebuffers[frameInFlightIndex].framebuffer, { static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height) });
-
-	depthToPositionsGraphicsPipeline.bind(commandBuffer);
-	depthToPositionsAndNormalsDescriptorSets[frameInFlightIndex].bind(commandBuffer, 0);
-
-	vkCmdDraw(commandBuffer->commandBuffer, 3, 1, 0, 0);
-
-	colorRenderPass.end(commandBuffer);
+void SSAO::updateData(uint32_t frameInFlightIndex, const glm::mat4& view, const glm::mat4& projection) {
+	// The kernel is rotated differently every frame, the history is undefined until a frame wrote it
+	SSAOUniformBufferObject subo = {};
+	subo.projection = projection;
+	subo.inverseProjection = glm::inverse(projection);
+	subo.reprojection = previousViewProjection * glm::inverse(view);
+	subo.temporal = glm::vec4(historyValid ? SSAO_HISTORY_WEIGHT : 0.0f, static_cast<float>(frame % 64), 0.0f, 0.0f);
 
-	// Depth to normals
-	colorRenderPass.begin(commandBuffer, depthToNormalsFramebuffers[frameInFlightIndex].framebuffer, { static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height) });
+	frameUniforms.write(frameInFlightIndex, uniformOffset, &subo, sizeof(SSAOUniformBufferObject));
 
-	depthToNormalsGraphicsPipeline.bind(commandBuffer);
-	depthToPositionsAndNormalsDescriptorSets[frameInFlightIndex].bind(commandBuffer, 0);
-
-	vkCmdDraw(commandBuffer->commandBuffer, 3, 1, 0, 0);
-
-	colorRenderPass.end(commandBuffer);
+	previousViewProjection = projection * view;
+	historyValid = true;
+	frame++;
+}
 
-	// SSAO
-	glm::vec2 imageSize = {viewport.viewport.width, viewport.viewport.height};
+uint32_t SSAO::addToRenderGraph(RenderGraph* renderGraph, Viewport fullscreenViewport, uint32_t depthImage, uint32_t normalImage) {
+	viewport.init(static_cast<uint32_t>(fullscreenViewport.viewport.width) / DOWNSCALE, static_cast<uint32_t>(fullscreenViewport.viewport.height) / DOWNSCALE);
+	uint32_t width = static_cast<uint32_t>(viewport.viewport.width);
+	uint32_t height = static_cast<uint32_t>(viewport.viewport.height);
+
+	// The history is kept across frames, it is imported and recreated with the render graph
+	ImageTools::createImage(&historyImage.image, 1, width, height, 1, VK_SAMPLE_COUNT_1_BIT, SSAO_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &historyImage.allocationId);
+	ImageTools::createImageView(&historyImage.imageView, historyImage.image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, SSAO_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+	ImageTools::createImageSampler(&historyImage.imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
+	historyImage.width = width;
+	historyImage.height = height;
+	historyImage.mipmapLevels = 1;
+	historyValid = false;
+
+	uint32_t history = renderGraph->importImage("ssaoHistory", &historyImage, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+	uint32_t ssao = renderGraph->createImage("ssao", &ssaoImage, width, height, SSAO_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	uint32_t ssaoBlurHorizontal = renderGraph->createImage("ssaoBlurHorizontal", &ssaoBlurHorizontalImage, width, height, SSAO_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	uint32_t ssaoBlurred = renderGraph->createImage("ssaoBlurred", &ssaoBlurredImage, width, height, SSAO_FORMAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	// Storage images stay in the general layout
+	uint32_t pass = renderGraph->addPass("ssao", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { dispatchSSAO(commandBuffer, frameInFlightIndex); });
+	renderGraph->addRead(pass, depthImage, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph->addRead(pass, normalImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph->addRead(pass, history, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph->addWrite(pass, ssao, true, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+	// The horizontal blur also stores the unblurred accumulation as the history of the next frame
+	pass = renderGraph->addPass("ssaoBlurHorizontal", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { dispatchBlur(commandBuffer, false); });
+	renderGraph->addRead(pass, ssao, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph->addWrite(pass, ssaoBlurHorizontal, true, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+	renderGraph->addWrite(pass, history, true, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+	pass = renderGraph->addPass("ssaoBlurVertical", false, [this](CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) { dispatchBlur(commandBuffer, true); });
+	renderGraph->addRead(pass, ssaoBlurHorizontal, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	renderGraph->addWrite(pass, ssaoBlurred, true, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+	return ssaoBlurred;
+}
 
-	colorRenderPass.begin(commandBuffer, ssaoFramebuffers[frameInFlightIndex].framebuffer, { static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height) });
+void SSAO::dispatchSSAO(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
+	uint32_t width = static_cast<uint32_t>(viewport.viewport.width);
+	uint32_t height = static_cast<uint32_t>(viewport.viewport.height);
 
-	ssaoGraphicsPipeline.bind(commandBuffer);
+	ssaoComputePipeline.bind(commandBuffer);
 	ssaoDescriptorSets[frameInFlightIndex].bind(commandBuffer, 0);
-	ssaoGraphicsPipeline.pushConstant(commandBuffer, VK_SHADER_STAGE_FRAGMENT_BIT, 0, 2 * sizeof(float), &imageSize);
-
-	vkCmdDraw(commandBuffer->commandBuffer, 3, 1, 0, 0);
-
-	colorRenderPass.end(commandBuffer);
-
-	// SSAO blurred
-	colorRenderPass.begin(commandBuffer, ssaoBlurredFramebuffers[frameInFlightIndex].framebuffer, { static_cast<uint32_t>(viewport.viewport.width), static_cast<uint32_t>(viewport.viewport.height) });
-
-	ssaoBlurredGraphicsPipeline.bind(commandBuffer);
-	ssaoBlurredDescriptorSets[frameInFlightIndex].bind(commandBuffer, 0);
+	ssaoComputePipeline.dispatch(commandBuffer, (width + SSAO_GROUP_SIZE - 1) / SSAO_GROUP_SIZE, (height + SSAO_GROUP_SIZE - 1) / SSAO_GROUP_SIZE, 1);
+}
 
-	vkCmdDraw(commandBuffer->commandBuffer, 3, 1, 0, 0);
+void SSAO::dispatchBlur(CommandBuffer* commandBuffer, bool vertical) {
+	// A workgroup filters a segment of a line, the lines are rows or columns
+	glm::ivec2 direction = vertical ? glm::ivec2(0, 1) : glm::ivec2(1, 0);
+	uint32_t lineLength = static_cast<uint32_t>(vertical ? viewport.viewport.height : viewport.viewport.width);
+	uint32_t lineCount = static_cast<uint32_t>(vertical ? viewport.viewport.width : viewport.viewport.height);
 
-	colorRenderPass.end(commandBuffer);
+	ssaoBlurComputePipeline.bind(commandBuffer);
+	ssaoBlurDescriptorSets[vertical ? 1 : 0].bind(commandBuffer, 0);
+	ssaoBlurComputePipeline.pushConstant(commandBuffer, 0, sizeof(glm::ivec2), &direction);
+	ssaoBlurComputePipeline.dispatch(commandBuffer, (lineLength + SSAO_BLUR_GROUP_SIZE - 1) / SSAO_BLUR_GROUP_SIZE, lineCount, 1);
 }
\ No newline at end of file
@@ -4,51 +4,52 @@
 #include "../../commands/CommandBuffer.h"
 #include "../../resources/Buffer.h"
 #include "../../resources/Image.h"
-#include "../../renderpasses/Framebuffer.h"
-#include "../../renderpasses/RenderPass.h"
 #include "../../pipelines/DescriptorSet.h"
-#include "../../pipelines/GraphicsPipeline.h"
+#include "../../pipelines/ComputePipeline.h"
 #include "../../pipelines/Viewport.h"
+#include "../../rendergraph/RenderGraph.h"
 #include <numeric>
 #include <vector>
 #include <random>
 
 #define DOWNSCALE 4
-#define SSAOSAMPLES 64
+#define SSAOSAMPLES 16
+// Storage and linear filtering of this format are supported by every device
+#define SSAO_FORMAT VK_FORMAT_R16G16B16A16_SFLOAT
+#define SSAO_GROUP_SIZE 8
+#define SSAO_BLUR_GROUP_SIZE 64
+// Part of the reprojected history kept every frame
+#define SSAO_HISTORY_WEIGHT 0.9f
 
 struct SSAO {
 	Viewport viewport;
-	RenderPass colorRenderPass;
-
-	// Depth to positions and normals
-	GraphicsPipeline depthToPositionsGraphicsPipeline;
-	GraphicsPipeline depthToNormalsGraphicsPipeline;
-	std::vector<DescriptorSet> depthToPositionsAndNormalsDescriptorSets;
-	Image depthToPositionsImage;
-	Image depthToNormalsImage;
-	std::vector<Framebuffer> depthToPositionsFramebuffers;
-	std::vector<Framebuffer> depthToNormalsFramebuffers;
+	VkDeviceSize uniformOffset;
 
 	// Sample kernel
 	Buffer sampleKernel;
-	Image randomTexture;
 
-	// SSAO
-	GraphicsPipeline ssaoGraphicsPipeline;
+	// SSAO, accumulated with the reprojected result of the previous frame
+	ComputePipeline ssaoComputePipeline;
 	std::vector<DescriptorSet> ssaoDescriptorSets;
 	Image ssaoImage;
-	std::vector<Framebuffer> ssaoFramebuffers;
+	Image historyImage;
+	bool historyValid = false;
+	glm::mat4 previousViewProjection;
+	uint32_t frame = 0;
 
-	// SSAO blurred
-	GraphicsPipeline ssaoBlurredGraphicsPipeline;
-	std::vector<DescriptorSet> ssaoBlurredDescriptorSets;
+	// Separable bilateral blur, horizontal then vertical
+	ComputePipeline ssaoBlurComputePipeline;
+	std::vector<DescriptorSet> ssaoBlurDescriptorSets;
+	Image ssaoBlurHorizontalImage;
 	Image ssaoBlurredImage;
-	std::vector<Framebuffer> ssaoBlurredFramebuffers;
 
 	void init(Viewport fullscreenViewport);
 	void destroy();
 	void createResources(Viewport fullscreenViewport);
 	void destroyResources();
-	void createRandomTexture();
-	void draw(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex);
+	void createSampleKernel();
+	void updateData(uint32_t frameInFlightIndex, const glm::mat4& view, const glm::mat4& projection);
+	uint32_t addToRenderGraph(RenderGraph* renderGraph, Viewport fullscreenViewport, uint32_t depthImage, uint32_t normalImage);
+	void dispatchSSAO(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex);
+	void dispatchBlur(CommandBuffer* commandBuffer, bool vertical);
 };
\ No newline at end of file
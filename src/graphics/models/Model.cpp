@@ -7,6 +7,8 @@ void Model::init(std::string filePath) {
 	std::vector<uint32_t> indices;
 
 	ModelLoader::load(filePath, &vertices, &indices, &meshes);
+	vertexCount = static_cast<uint32_t>(vertices.size());
+	indexCount = static_cast<uint32_t>(indices.size());
 
 	Buffer stagingVertexBuffer;
 	VkDeviceSize size = vertices.size() * sizeof(Vertex);
@@ -15,7 +17,7 @@ void Model::init(std::string filePath) {
 	stagingVertexBuffer.map(0, size, &vertexData);
 	memcpy(vertexData, vertices.data(), static_cast<size_t>(size));
 	stagingVertexBuffer.unmap();
-	BufferTools::createBuffer(vertexBuffer.buffer, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &vertexBuffer.allocationId);
+	BufferTools::createBuffer(vertexBuffer.buffer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &vertexBuffer.allocationId);
 	BufferTools::copyBuffer(stagingVertexBuffer.buffer, vertexBuffer.buffer, size);
 	stagingVertexBuffer.destroy();
 
@@ -26,11 +28,16 @@ void Model::init(std::string filePath) {
 	stagingIndexBuffer.map(0, size, &indexData);
 	memcpy(indexData, indices.data(), static_cast<size_t>(size));
 	stagingIndexBuffer.unmap();
-	BufferTools::createBuffer(indexBuffer.buffer, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &indexBuffer.allocationId);
+	BufferTools::createBuffer(indexBuffer.buffer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &indexBuffer.allocationId);
 	BufferTools::copyBuffer(stagingIndexBuffer.buffer, indexBuffer.buffer, size);
 	stagingIndexBuffer.destroy();
 
 	for (Mesh& mesh : meshes) {
+		primitiveCount += static_cast<uint32_t>(mesh.primitives.size());
+		aabb.min = glm::min(aabb.min, mesh.aabb.min);
+		aabb.max = glm::max(aabb.max, mesh.aabb.max);
+		skinned |= !mesh.boneList.empty();
+
 		mesh.boneBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
 		for (Buffer& buffer : mesh.boneBuffers) {
@@ -50,6 +57,11 @@ void Model::init(std::string filePath) {
 			buffer.unmap();
 		}
 	}
+
+	boundingSphere.center = (aabb.min + aabb.max) * 0.5f;
+	for (Mesh& mesh : meshes) {
+		boundingSphere.radius = std::max(boundingSphere.radius, glm::length(mesh.boundingSphere.center - boundingSphere.center) + mesh.boundingSphere.radius);
+	}
 }
 
 void Model::destroy() {
@@ -62,17 +74,45 @@ void Model::destroy() {
 	}
 }
 
-void Model::draw(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures) {
-	VkDeviceSize offset = 0;
-	vkCmdBindVertexBuffers(commandBuffer->commandBuffer, 0, 1, &vertexBuffer.buffer, &offset);
-	vkCmdBindIndexBuffer(commandBuffer->commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+void Model::draw(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures, uint32_t firstInstance, uint32_t instanceCount, const uint8_t* primitiveVisibility) {
+	commandBuffer->bindVertexBuffer(vertexBuffer.buffer);
+	commandBuffer->bindIndexBuffer(indexBuffer.buffer);
 
+	uint32_t primitiveIndex = 0;
 	for (Mesh& mesh : meshes) {
 		for (size_t i = 0; i < mesh.primitives.size(); i++) {
+			if (primitiveVisibility != nullptr && primitiveVisibility[primitiveIndex++] == 0) {
+				continue;
+			}
 			if (bindTextures) {
 				mesh.descriptorSets.at(graphicsPipeline).at(i).at(frameInFlightIndex).bind(commandBuffer, 1);
 			}
-			vkCmdDrawIndexed(commandBuffer->commandBuffer, mesh.primitives[i].indexCount, 1, mesh.indexOffset + mesh.primitives[i].firstIndex, mesh.vertexOffset + mesh.primitives[i].vertexOffset, 0);
+			vkCmdDrawIndexed(commandBuffer->commandBuffer, mesh.primitives[i].indexCount, instanceCount, mesh.indexOffset + mesh.primitives[i].firstIndex, mesh.vertexOffset + mesh.primitives[i].vertexOffset, firstInstance);
+		}
+	}
+}
+
+void Model::createDrawCommands(uint32_t firstInstance, uint32_t instanceCount, std::vector<VkDrawIndexedIndirectCommand>* drawCommands) {
+	for (Mesh& mesh : meshes) {
+		for (size_t i = 0; i < mesh.primitives.size(); i++) {
+			VkDrawIndexedIndirectCommand drawCommand = {};
+			drawCommand.indexCount = mesh.primitives[i].indexCount;
+			drawCommand.instanceCount = instanceCount;
+			drawCommand.firstIndex = mesh.indexOffset + mesh.primitives[i].firstIndex;
+			drawCommand.vertexOffset = mesh.vertexOffset + mesh.primitives[i].vertexOffset;
+			drawCommand.firstInstance = firstInstance;
+			drawCommands->push_back(drawCommand);
+		}
+	}
+}
+
+void Model::drawIndirect(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, VkBuffer indirectBuffer, uint32_t firstDrawCommand) {
+	uint32_t drawCommand = firstDrawCommand;
+	for (Mesh& mesh : meshes) {
+		for (size_t i = 0; i < mesh.primitives.size(); i++) {
+			mesh.descriptorSets.at(graphicsPipeline).at(i).at(frameInFlightIndex).bind(commandBuffer, 1);
+			vkCmdDrawIndexedIndirect(commandBuffer->commandBuffer, indirectBuffer, drawCommand * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+			drawCommand++;
 		}
 	}
 }
@@ -13,9 +13,24 @@ struct Model {
 	std::vector<Mesh> meshes;
 	Buffer vertexBuffer;
 	Buffer indexBuffer;
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	// Offsets of the model in the geometry buffers shared by the GPU-driven draws
+	uint32_t geometryVertexOffset = 0;
+	uint32_t geometryIndexOffset = 0;
+	uint32_t primitiveCount = 0;
+	// Model space bounds, skinned models are never culled as their bounds are only valid in bind pose
+	AABB aabb;
+	BoundingSphere boundingSphere;
+	bool skinned = false;
 
 	void init(std::string filePath);
 	void destroy();
-	void draw(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures);
+	// primitiveVisibility has one entry per primitive, every primitive is drawn when it is nullptr
+	void draw(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, bool bindTextures, uint32_t firstInstance, uint32_t instanceCount, const uint8_t* primitiveVisibility);
+	// One draw command per primitive, in drawing order
+	void createDrawCommands(uint32_t firstInstance, uint32_t instanceCount, std::vector<VkDrawIndexedIndirectCommand>* drawCommands);
+	// The shared geometry buffers are bound by the caller, one indirect draw per primitive as each binds its own material
+	void drawIndirect(CommandBuffer* commandBuffer, GraphicsPipeline* graphicsPipeline, uint32_t frameInFlightIndex, VkBuffer indirectBuffer, uint32_t firstDrawCommand);
 	void createDescriptorSets(GraphicsPipeline* graphicsPipeline);
 };
\ No newline at end of file
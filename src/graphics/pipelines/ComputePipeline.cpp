@@ -0,0 +1,138 @@
+#include "ComputePipeline.h"
+#include "../resources/RendererResources.h"
+#include "../resources/ShaderResources.h"
+
+void ComputePipeline::init() {
+	Shader shader;
+	std::unordered_map<std::string, Shader>::const_iterator mapSearch = shaders.find(computeShaderPath);
+	if (mapSearch == shaders.end()) {
+		shader.init(computeShaderPath);
+		shaders.emplace(computeShaderPath, shader);
+	}
+	else {
+		shader = shaders[computeShaderPath];
+	}
+	NEIGE_ASSERT(shader.type == ShaderType::COMPUTE, "Compute shader in pipeline is not a compute shader.");
+
+	VkPipelineShaderStageCreateInfo computeShaderCreateInfo = {};
+	computeShaderCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computeShaderCreateInfo.pNext = nullptr;
+	computeShaderCreateInfo.flags = 0;
+	computeShaderCreateInfo.stage = shader.shaderTypeToVkShaderFlagBits();
+	computeShaderCreateInfo.module = shader.module;
+	computeShaderCreateInfo.pName = "main";
+	computeShaderCreateInfo.pSpecializationInfo = nullptr;
+
+	sets = shader.sets;
+	pushConstantRanges = shader.pushConstantRanges;
+
+	// Sort sets
+	std::sort(sets.begin(), sets.end(), [](Set a, Set b) { return a.set < b.set; });
+	for (size_t i = 0; i < sets.size(); i++) {
+		// Sort bindings
+		std::sort(sets[i].bindings.begin(), sets[i].bindings.end(), [](Binding a, Binding b) { return a.binding.binding < b.binding.binding; });
+	}
+
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings;
+	setBindings.resize(sets.size());
+	for (size_t i = 0; i < sets.size(); i++) {
+		for (size_t j = 0; j < sets[i].bindings.size(); j++) {
+			setBindings[i].push_back(sets[i].bindings[j].binding);
+		}
+	}
+
+	// Descriptor set layouts
+	descriptorSetLayouts.resize(sets.size());
+	for (size_t i = 0; i < sets.size(); i++) {
+		if (descriptorSetLayouts[i] == VK_NULL_HANDLE) {
+			VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+			descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			descriptorSetLayoutCreateInfo.pNext = nullptr;
+			descriptorSetLayoutCreateInfo.flags = 0;
+			descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(setBindings[i].size());
+			descriptorSetLayoutCreateInfo.pBindings = setBindings[i].data();
+			NEIGE_VK_CHECK(vkCreateDescriptorSetLayout(logicalDevice.device, &descriptorSetLayoutCreateInfo, nullptr, &descriptorSetLayouts[i]));
+		}
+	}
+
+	// Descriptor pool
+	if (descriptorPool == VK_NULL_HANDLE) {
+		std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
+		for (std::set<VkDescriptorType>::iterator it = shader.uniqueDescriptorTypes.begin(); it != shader.uniqueDescriptorTypes.end(); it++) {
+			VkDescriptorPoolSize descriptorPoolSize = {};
+			descriptorPoolSize.type = *it;
+			descriptorPoolSize.descriptorCount = 64;
+			descriptorPoolSizes.push_back(descriptorPoolSize);
+		}
+
+		if (descriptorPoolSizes.size() != 0) {
+			VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+			descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			descriptorPoolCreateInfo.pNext = nullptr;
+			descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+			descriptorPoolCreateInfo.maxSets = 32;
+			descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size());
+			descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+			NEIGE_VK_CHECK(vkCreateDescriptorPool(logicalDevice.device, &descriptorPoolCreateInfo, nullptr, &descriptorPool));
+		}
+	}
+
+	// Pipeline layout
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.pNext = nullptr;
+	pipelineLayoutCreateInfo.flags = 0;
+	pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+	pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
+	pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
+	NEIGE_VK_CHECK(vkCreatePipelineLayout(logicalDevice.device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout));
+
+	// Pipeline
+	VkComputePipelineCreateInfo computePipelineCreateInfo = {};
+	computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineCreateInfo.pNext = nullptr;
+	computePipelineCreateInfo.flags = 0;
+	computePipelineCreateInfo.stage = computeShaderCreateInfo;
+	computePipelineCreateInfo.layout = pipelineLayout;
+	computePipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	computePipelineCreateInfo.basePipelineIndex = -1;
+	NEIGE_VK_CHECK(vkCreateComputePipelines(logicalDevice.device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &pipeline));
+}
+
+void ComputePipeline::destroy() {
+	if (descriptorPool != VK_NULL_HANDLE) {
+		vkDestroyDescriptorPool(logicalDevice.device, descriptorPool, nullptr);
+		descriptorPool = VK_NULL_HANDLE;
+	}
+	for (VkDescriptorSetLayout descriptorSetLayout : descriptorSetLayouts) {
+		if (descriptorSetLayout != VK_NULL_HANDLE) {
+			vkDestroyDescriptorSetLayout(logicalDevice.device, descriptorSetLayout, nullptr);
+			descriptorSetLayout = VK_NULL_HANDLE;
+		}
+	}
+	destroyPipeline();
+}
+
+void ComputePipeline::bind(CommandBuffer* commandBuffer) {
+	vkCmdBindPipeline(commandBuffer->commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+}
+
+void ComputePipeline::pushConstant(CommandBuffer* commandBuffer, uint32_t offset, uint32_t size, const void* data) {
+	vkCmdPushConstants(commandBuffer->commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
+}
+
+void ComputePipeline::dispatch(CommandBuffer* commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	vkCmdDispatch(commandBuffer->commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void ComputePipeline::destroyPipeline() {
+	if (pipelineLayout != VK_NULL_HANDLE) {
+		vkDestroyPipelineLayout(logicalDevice.device, pipelineLayout, nullptr);
+		pipelineLayout = VK_NULL_HANDLE;
+	}
+	if (pipeline != VK_NULL_HANDLE) {
+		vkDestroyPipeline(logicalDevice.device, pipeline, nullptr);
+		pipeline = VK_NULL_HANDLE;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include "vulkan/vulkan.hpp"
+#include "../../utils/NeigeDefines.h"
+#include "../../utils/structs/ShaderStructs.h"
+#include "../commands/CommandBuffer.h"
+#include "Shader.h"
+#include <vector>
+
+struct ComputePipeline {
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	std::string computeShaderPath;
+	std::vector<Set> sets;
+	std::vector<VkPushConstantRange> pushConstantRanges;
+
+	void init();
+	void destroy();
+	void bind(CommandBuffer* commandBuffer);
+	void pushConstant(CommandBuffer* commandBuffer, uint32_t offset, uint32_t size, const void* data);
+	void dispatch(CommandBuffer* commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+	void destroyPipeline();
+};
\ No newline at end of file
@@ -14,14 +14,36 @@ void DescriptorSet::init(GraphicsPipeline* associatedGraphicsPipeline, uint32_t
 	NEIGE_VK_CHECK(vkAllocateDescriptorSets(logicalDevice.device, &descriptorSetAllocateInfo, &descriptorSet));
 }
 
+void DescriptorSet::init(ComputePipeline* associatedComputePipeline, uint32_t set) {
+	computePipeline = associatedComputePipeline;
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.pNext = nullptr;
+	descriptorSetAllocateInfo.descriptorPool = computePipeline->descriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = 1;
+	descriptorSetAllocateInfo.pSetLayouts = &computePipeline->descriptorSetLayouts[set];
+	NEIGE_VK_CHECK(vkAllocateDescriptorSets(logicalDevice.device, &descriptorSetAllocateInfo, &descriptorSet));
+}
+
 void DescriptorSet::update(const std::vector<VkWriteDescriptorSet> writesDescriptorSet) {
 	vkUpdateDescriptorSets(logicalDevice.device, static_cast<uint32_t>(writesDescriptorSet.size()), writesDescriptorSet.data(), 0, nullptr);
 }
 
 void DescriptorSet::destroy() {
-	vkFreeDescriptorSets(logicalDevice.device, graphicsPipeline->descriptorPool, 1, &descriptorSet);
+	if (computePipeline != nullptr) {
+		vkFreeDescriptorSets(logicalDevice.device, computePipeline->descriptorPool, 1, &descriptorSet);
+	}
+	else {
+		vkFreeDescriptorSets(logicalDevice.device, graphicsPipeline->descriptorPool, 1, &descriptorSet);
+	}
 }
 
 void DescriptorSet::bind(CommandBuffer* commandBuffer, uint32_t set) {
-	vkCmdBindDescriptorSets(commandBuffer->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->pipelineLayout, set, 1, &descriptorSet, 0, nullptr);
+	if (computePipeline != nullptr) {
+		vkCmdBindDescriptorSets(commandBuffer->commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline->pipelineLayout, set, 1, &descriptorSet, 0, nullptr);
+	}
+	else if (commandBuffer->stateTracker.setDescriptorSet(graphicsPipeline->pipelineLayout, set, descriptorSet)) {
+		vkCmdBindDescriptorSets(commandBuffer->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->pipelineLayout, set, 1, &descriptorSet, 0, nullptr);
+	}
 }
\ No newline at end of file
@@ -1,13 +1,16 @@
 #pragma once
 #include "vulkan/vulkan.hpp"
 #include "GraphicsPipeline.h"
+#include "ComputePipeline.h"
 #include "../commands/CommandBuffer.h"
 
 struct DescriptorSet {
 	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
-	GraphicsPipeline* graphicsPipeline;
+	GraphicsPipeline* graphicsPipeline = nullptr;
+	ComputePipeline* computePipeline = nullptr;
 
 	void init(GraphicsPipeline* graphicsPipeline, uint32_t set);
+	void init(ComputePipeline* computePipeline, uint32_t set);
 	void update(const std::vector<VkWriteDescriptorSet> writeDescriptorSets);
 	void destroy();
 	void bind(CommandBuffer* commandBuffer, uint32_t set);
@@ -311,7 +311,7 @@ void GraphicsPipeline::init() {
 	rasterizationCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizationCreateInfo.pNext = nullptr;
 	rasterizationCreateInfo.flags = 0;
-	rasterizationCreateInfo.depthClampEnable = VK_FALSE;
+	rasterizationCreateInfo.depthClampEnable = depthClamp ? VK_TRUE : VK_FALSE;
 	rasterizationCreateInfo.rasterizerDiscardEnable = VK_FALSE;
 	rasterizationCreateInfo.polygonMode = topology != Topology::WIREFRAME ? VK_POLYGON_MODE_FILL : VK_POLYGON_MODE_LINE;
 	rasterizationCreateInfo.cullMode = !backfaceCulling ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
@@ -428,6 +428,10 @@ void GraphicsPipeline::destroy() {
 }
 
 void GraphicsPipeline::bind(CommandBuffer* commandBuffer) {
+	if (!commandBuffer->stateTracker.setPipeline(pipeline)) {
+		return;
+	}
+
 	vkCmdBindPipeline(commandBuffer->commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 	viewport->setViewport(commandBuffer);
 	viewport->setScissor(commandBuffer);
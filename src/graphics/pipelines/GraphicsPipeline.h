@@ -30,6 +30,7 @@ struct GraphicsPipeline {
 	bool colorBlend = true;
 	bool multiSample = false;
 	bool depthWrite = true;
+	bool depthClamp = false;
 	Compare depthCompare = LESS_OR_EQUAL;
 	bool backfaceCulling = true;
 	std::vector<Set> sets;
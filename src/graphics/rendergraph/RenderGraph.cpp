@@ -0,0 +1,254 @@
+#include "RenderGraph.h"
+#include "../../utils/resources/ImageTools.h"
+#include "../resources/RendererResources.h"
+#include <algorithm>
+
+uint32_t RenderGraph::importImage(const std::string& name, Image* image, VkImageAspectFlags aspect, VkImageLayout layout) {
+	images.push_back({ name, image, false, image->width, image->height, VK_FORMAT_UNDEFINED, 0, aspect, UINT32_MAX, 0, RENDER_GRAPH_NO_SLOT, static_cast<uint32_t>(states.size()) });
+	states.push_back({ layout, 0, 0, 0 });
+
+	return static_cast<uint32_t>(images.size() - 1);
+}
+
+uint32_t RenderGraph::createImage(const std::string& name, Image* image, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect) {
+	images.push_back({ name, image, true, width, height, format, usage, aspect, UINT32_MAX, 0, RENDER_GRAPH_NO_SLOT, 0 });
+
+	return static_cast<uint32_t>(images.size() - 1);
+}
+
+uint32_t RenderGraph::addPass(const std::string& name, bool output, std::function<void(CommandBuffer*, uint32_t)> record) {
+	passes.push_back({ name, {}, record, output, false });
+
+	return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::addRead(uint32_t pass, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags accesses) {
+	passes[pass].accesses.push_back({ image, false, false, layout, layout, stages, accesses });
+}
+
+void RenderGraph::addWrite(uint32_t pass, uint32_t image, bool discard, VkImageLayout layout, VkImageLayout finalLayout, VkPipelineStageFlags stages, VkAccessFlags accesses) {
+	passes[pass].accesses.push_back({ image, true, discard, layout, finalLayout, stages, accesses });
+}
+
+void RenderGraph::compile() {
+	cullPasses();
+
+	// Lifetimes
+	for (uint32_t i = 0; i < static_cast<uint32_t>(passes.size()); i++) {
+		if (passes[i].culled) {
+			continue;
+		}
+
+		for (const RenderGraphAccess& access : passes[i].accesses) {
+			RenderGraphImage& image = images[access.image];
+			if (image.firstPass == UINT32_MAX) {
+				NEIGE_ASSERT(!image.transient || (access.write && access.discard), "Transient image \"" + image.name + "\" is not written by its first pass \"" + passes[i].name + "\".");
+				image.firstPass = i;
+			}
+			image.lastPass = i;
+		}
+	}
+
+	assignMemorySlots();
+}
+
+void RenderGraph::cullPasses() {
+	// From the last pass, a pass is needed when it writes an image a following needed pass reads
+	std::vector<bool> neededImages(images.size(), false);
+	for (uint32_t i = static_cast<uint32_t>(passes.size()); i-- > 0;) {
+		RenderGraphPass& pass = passes[i];
+
+		pass.culled = !pass.output;
+		for (const RenderGraphAccess& access : pass.accesses) {
+			if (access.write && neededImages[access.image]) {
+				pass.culled = false;
+			}
+		}
+
+		if (pass.culled) {
+			NEIGE_INFO("Render graph pass \"" + pass.name + "\" culled.");
+			continue;
+		}
+
+		// Previous content is only needed if it is not discarded
+		for (const RenderGraphAccess& access : pass.accesses) {
+			if (access.write && access.discard) {
+				neededImages[access.image] = false;
+			}
+		}
+		for (const RenderGraphAccess& access : pass.accesses) {
+			if (!access.write || !access.discard) {
+				neededImages[access.image] = true;
+			}
+		}
+	}
+}
+
+void RenderGraph::assignMemorySlots() {
+	// Transient images by creation order
+	std::vector<uint32_t> transientImages;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(images.size()); i++) {
+		if (images[i].transient) {
+			transientImages.push_back(i);
+		}
+	}
+	std::stable_sort(transientImages.begin(), transientImages.end(), [this](uint32_t a, uint32_t b) {
+		return images[a].firstPass < images[b].firstPass;
+	});
+
+	for (uint32_t imageIndex : transientImages) {
+		RenderGraphImage& image = images[imageIndex];
+		ImageTools::createUnboundImage(&image.image->image, 1, image.width, image.height, 1, VK_SAMPLE_COUNT_1_BIT, image.format, image.usage);
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(logicalDevice.device, image.image->image, &memoryRequirements);
+
+		// Smallest slot large enough, or else the largest one, among the ones whose images are all dead
+		uint32_t bestSlot = RENDER_GRAPH_NO_SLOT;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(memorySlots.size()); i++) {
+			const RenderGraphMemorySlot& memorySlot = memorySlots[i];
+			if (memorySlot.lastPass >= image.firstPass || (memorySlot.memoryRequirements.memoryTypeBits & memoryRequirements.memoryTypeBits) == 0) {
+				continue;
+			}
+
+			if (bestSlot == RENDER_GRAPH_NO_SLOT) {
+				bestSlot = i;
+				continue;
+			}
+			VkDeviceSize slotSize = memorySlot.memoryRequirements.size;
+			VkDeviceSize bestSize = memorySlots[bestSlot].memoryRequirements.size;
+			bool fits = slotSize >= memoryRequirements.size;
+			bool bestFits = bestSize >= memoryRequirements.size;
+			if ((fits && (!bestFits || slotSize < bestSize)) || (!fits && !bestFits && slotSize > bestSize)) {
+				bestSlot = i;
+			}
+		}
+
+		if (bestSlot == RENDER_GRAPH_NO_SLOT) {
+			memorySlots.push_back({ memoryRequirements, image.lastPass, VK_NULL_HANDLE, 0, 0, static_cast<uint32_t>(states.size()) });
+			states.push_back({ VK_IMAGE_LAYOUT_UNDEFINED, 0, 0, 0 });
+			bestSlot = static_cast<uint32_t>(memorySlots.size() - 1);
+		}
+		else {
+			RenderGraphMemorySlot& memorySlot = memorySlots[bestSlot];
+			memorySlot.memoryRequirements.size = std::max(memorySlot.memoryRequirements.size, memoryRequirements.size);
+			memorySlot.memoryRequirements.alignment = std::max(memorySlot.memoryRequirements.alignment, memoryRequirements.alignment);
+			memorySlot.memoryRequirements.memoryTypeBits &= memoryRequirements.memoryTypeBits;
+			memorySlot.lastPass = std::max(memorySlot.lastPass, image.lastPass);
+		}
+		image.memorySlot = bestSlot;
+		image.state = memorySlots[bestSlot].state;
+	}
+
+	for (RenderGraphMemorySlot& memorySlot : memorySlots) {
+		memorySlot.allocationId = memoryAllocator.allocate(memorySlot.memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memorySlot.memory, &memorySlot.offset);
+	}
+
+	for (uint32_t imageIndex : transientImages) {
+		RenderGraphImage& image = images[imageIndex];
+		const RenderGraphMemorySlot& memorySlot = memorySlots[image.memorySlot];
+		NEIGE_VK_CHECK(vkBindImageMemory(logicalDevice.device, image.image->image, memorySlot.memory, memorySlot.offset));
+
+		ImageTools::createImageView(&image.image->imageView, image.image->image, 0, 1, 0, 1, VK_IMAGE_VIEW_TYPE_2D, image.format, image.aspect);
+		ImageTools::createImageSampler(&image.image->imageSampler, 1, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_ALWAYS);
+		image.image->width = image.width;
+		image.image->height = image.height;
+		image.image->mipmapLevels = 1;
+		image.image->allocationId = memorySlot.allocationId;
+	}
+
+	NEIGE_INFO("Render graph : " + std::to_string(transientImages.size()) + " transient images in " + std::to_string(memorySlots.size()) + " memory slots.");
+}
+
+void RenderGraph::execute(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex) {
+	for (RenderGraphPass& pass : passes) {
+		if (pass.culled) {
+			continue;
+		}
+
+		// Barriers against the previous accesses, the state is kept from the previous frame
+		imageBarriers.clear();
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		for (const RenderGraphAccess& access : pass.accesses) {
+			const RenderGraphImage& image = images[access.image];
+			RenderGraphState& state = states[image.state];
+
+			VkImageLayout oldLayout = access.discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+			VkPipelineStageFlags waitedStages = state.writeStages;
+			VkAccessFlags waitedAccesses = state.writeAccesses;
+			if (access.write) {
+				waitedStages |= state.readStages;
+			}
+			else if ((state.readStages & access.stages) == access.stages && oldLayout == access.layout) {
+				// Already synchronized with the last write by a previous read
+				waitedStages = 0;
+			}
+
+			if (waitedStages != 0 || oldLayout != access.layout) {
+				VkImageAspectFlags aspect = image.aspect;
+				if ((aspect & VK_IMAGE_ASPECT_DEPTH_BIT) && physicalDevice.depthFormat != VK_FORMAT_D32_SFLOAT) {
+					aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+				}
+
+				VkImageMemoryBarrier imageMemoryBarrier = {};
+				imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageMemoryBarrier.pNext = nullptr;
+				imageMemoryBarrier.srcAccessMask = waitedAccesses;
+				imageMemoryBarrier.dstAccessMask = access.accesses;
+				imageMemoryBarrier.oldLayout = oldLayout;
+				imageMemoryBarrier.newLayout = access.layout;
+				imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageMemoryBarrier.image = image.image->image;
+				imageMemoryBarrier.subresourceRange.aspectMask = aspect;
+				imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+				imageMemoryBarrier.subresourceRange.levelCount = 1;
+				imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+				imageMemoryBarrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(imageMemoryBarrier);
+
+				srcStages |= (waitedStages != 0) ? waitedStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+				dstStages |= access.stages;
+			}
+
+			if (access.write) {
+				state.writeStages = access.stages;
+				state.writeAccesses = access.accesses;
+				state.readStages = 0;
+			}
+			else {
+				state.readStages |= access.stages;
+			}
+			state.layout = access.finalLayout;
+		}
+
+		if (!imageBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer->commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+		}
+
+		pass.record(commandBuffer, frameInFlightIndex);
+	}
+}
+
+void RenderGraph::destroy() {
+	for (RenderGraphImage& image : images) {
+		if (!image.transient || image.image->image == VK_NULL_HANDLE) {
+			continue;
+		}
+
+		vkDestroySampler(logicalDevice.device, image.image->imageSampler, nullptr);
+		vkDestroyImageView(logicalDevice.device, image.image->imageView, nullptr);
+		vkDestroyImage(logicalDevice.device, image.image->image, nullptr);
+		image.image->imageSampler = VK_NULL_HANDLE;
+		image.image->imageView = VK_NULL_HANDLE;
+		image.image->image = VK_NULL_HANDLE;
+	}
+	for (RenderGraphMemorySlot& memorySlot : memorySlots) {
+		memoryAllocator.deallocate(memorySlot.allocationId);
+	}
+	images.clear();
+	passes.clear();
+	memorySlots.clear();
+	states.clear();
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "vulkan/vulkan.hpp"
+#include "../../utils/NeigeDefines.h"
+#include "../commands/CommandBuffer.h"
+#include "../resources/Image.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+#define RENDER_GRAPH_NO_SLOT UINT32_MAX
+
+// Use of an image by a pass
+struct RenderGraphAccess {
+	uint32_t image;
+	bool write;
+	// The previous content is not needed, the image is transitioned from an undefined layout
+	bool discard;
+	// Layout the pass uses the image in and layout it leaves it in, render passes may transition their attachments themselves
+	VkImageLayout layout;
+	VkImageLayout finalLayout;
+	VkPipelineStageFlags stages;
+	VkAccessFlags accesses;
+};
+
+struct RenderGraphPass {
+	std::string name;
+	std::vector<RenderGraphAccess> accesses;
+	std::function<void(CommandBuffer*, uint32_t)> record;
+	// The results are used outside of the graph, the pass is never culled
+	bool output;
+	bool culled;
+};
+
+// Synchronization state of an image, transient images sharing memory share their state
+struct RenderGraphState {
+	VkImageLayout layout;
+	VkPipelineStageFlags writeStages;
+	VkAccessFlags writeAccesses;
+	// Stages reading the image since its last write
+	VkPipelineStageFlags readStages;
+};
+
+// Image of the graph, transient images are created by the graph and alias the memory of the ones they do not live alongside
+struct RenderGraphImage {
+	std::string name;
+	Image* image;
+	bool transient;
+	uint32_t width;
+	uint32_t height;
+	VkFormat format;
+	VkImageUsageFlags usage;
+	VkImageAspectFlags aspect;
+	// Lifetime, in passes
+	uint32_t firstPass;
+	uint32_t lastPass;
+	uint32_t memorySlot;
+	uint32_t state;
+};
+
+struct RenderGraphMemorySlot {
+	VkMemoryRequirements memoryRequirements;
+	uint32_t lastPass;
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize allocationId;
+	uint32_t state;
+};
+
+struct RenderGraph {
+	std::vector<RenderGraphImage> images;
+	std::vector<RenderGraphPass> passes;
+	std::vector<RenderGraphMemorySlot> memorySlots;
+	std::vector<RenderGraphState> states;
+	std::vector<VkImageMemoryBarrier> imageBarriers;
+
+	uint32_t importImage(const std::string& name, Image* image, VkImageAspectFlags aspect, VkImageLayout layout);
+	uint32_t createImage(const std::string& name, Image* image, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect);
+	uint32_t addPass(const std::string& name, bool output, std::function<void(CommandBuffer*, uint32_t)> record);
+	void addRead(uint32_t pass, uint32_t image, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags accesses);
+	void addWrite(uint32_t pass, uint32_t image, bool discard, VkImageLayout layout, VkImageLayout finalLayout, VkPipelineStageFlags stages, VkAccessFlags accesses);
+	void compile();
+	void execute(CommandBuffer* commandBuffer, uint32_t frameInFlightIndex);
+	void destroy();
+	void cullPasses();
+	void assignMemorySlots();
+};
\ No newline at end of file
@@ -67,7 +67,7 @@ void RenderPass::destroy() {
 	vkDestroyRenderPass(logicalDevice.device, renderPass, nullptr);
 }
 
-void RenderPass::begin(CommandBuffer* commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent) {
+void RenderPass::begin(CommandBuffer* commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent, VkSubpassContents subpassContents) {
 	VkRenderPassBeginInfo renderPassBeginInfo = {};
 	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassBeginInfo.pNext = nullptr;
@@ -77,7 +77,7 @@ void RenderPass::begin(CommandBuffer* commandBuffer, VkFramebuffer framebuffer,
 	renderPassBeginInfo.renderArea.extent = extent;
 	renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 	renderPassBeginInfo.pClearValues = clearValues.data();
-	vkCmdBeginRenderPass(commandBuffer->commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(commandBuffer->commandBuffer, &renderPassBeginInfo, subpassContents);
 }
 
 void RenderPass::end(CommandBuffer* commandBuffer) {
@@ -19,6 +19,6 @@ struct RenderPass {
 
 	void init(std::vector<RenderPassAttachment> attachments, std::vector<SubpassDependency> subpassDependencies);
 	void destroy();
-	void begin(CommandBuffer* commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent);
+	void begin(CommandBuffer* commandBuffer, VkFramebuffer framebuffer, VkExtent2D extent, VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE);
 	void end(CommandBuffer* commandBuffer);
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "../resources/RendererResources.h"
 
 void Buffer::destroy() {
+	mappedMemory = nullptr;
 	if (deviceMemory != VK_NULL_HANDLE) {
 		vkFreeMemory(logicalDevice.device, deviceMemory, nullptr);
 		deviceMemory = VK_NULL_HANDLE;
@@ -7,6 +7,9 @@ struct Buffer {
 
 	VkDeviceSize allocationId;
 
+	// Set when the buffer stays mapped
+	void* mappedMemory = nullptr;
+
 	void destroy();
 	void map(VkDeviceSize offset, VkDeviceSize size, void** data);
 	void unmap();
@@ -0,0 +1,36 @@
+#include "RingBuffer.h"
+#include "RendererResources.h"
+#include "../../utils/resources/BufferTools.h"
+#include <cstring>
+
+VkDeviceSize RingBuffer::reserve(VkDeviceSize size) {
+	NEIGE_ASSERT(buffer.buffer == VK_NULL_HANDLE, "Ring buffer allocations must be reserved before its initialization.");
+
+	VkDeviceSize alignment = physicalDevice.properties.limits.minUniformBufferOffsetAlignment;
+	VkDeviceSize allocationOffset = (frameSize + alignment - 1) & ~(alignment - 1);
+	frameSize = allocationOffset + size;
+
+	return allocationOffset;
+}
+
+void RingBuffer::init() {
+	// Regions start on an aligned offset too
+	VkDeviceSize alignment = physicalDevice.properties.limits.minUniformBufferOffsetAlignment;
+	frameSize = (frameSize + alignment - 1) & ~(alignment - 1);
+
+	BufferTools::createUniformBuffer(buffer.buffer, buffer.deviceMemory, frameSize * MAX_FRAMES_IN_FLIGHT);
+	buffer.map(0, VK_WHOLE_SIZE, &buffer.mappedMemory);
+}
+
+void RingBuffer::destroy() {
+	buffer.destroy();
+	frameSize = 0;
+}
+
+VkDeviceSize RingBuffer::offset(uint32_t frameInFlightIndex, VkDeviceSize allocationOffset) const {
+	return (frameSize * frameInFlightIndex) + allocationOffset;
+}
+
+void RingBuffer::write(uint32_t frameInFlightIndex, VkDeviceSize allocationOffset, const void* data, size_t size) {
+	memcpy(static_cast<uint8_t*>(buffer.mappedMemory) + offset(frameInFlightIndex, allocationOffset), data, size);
+}
\ No newline at end of file
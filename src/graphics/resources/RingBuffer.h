@@ -0,0 +1,19 @@
+#pragma once
+#include "vulkan/vulkan.hpp"
+#include "../../utils/NeigeDefines.h"
+#include "Buffer.h"
+
+// Uniform buffer mapped for its whole lifetime, with one region per frame in flight used in turn
+// Regions are sub-allocated linearly before initialization and share the same layout
+struct RingBuffer {
+	Buffer buffer;
+	VkDeviceSize frameSize = 0;
+
+	// Returns the offset of the allocation in a region
+	VkDeviceSize reserve(VkDeviceSize size);
+	void init();
+	void destroy();
+	// Offset from the start of the buffer
+	VkDeviceSize offset(uint32_t frameInFlightIndex, VkDeviceSize allocationOffset) const;
+	void write(uint32_t frameInFlightIndex, VkDeviceSize allocationOffset, const void* data, size_t size);
+};
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "../effects/ssao/SSAO.h"
 #include "../../ecs/ECS.h"
 #include "Image.h"
+#include "RingBuffer.h"
 #include <string>
 #include <unordered_map>
 
@@ -16,10 +17,12 @@ inline std::unordered_map<std::string, Image> textures;
 inline std::vector<Material> materials;
 inline std::unordered_map<std::string, Shader> shaders;
 inline Entity camera;
-inline std::vector<Buffer> cameraBuffers;
-inline std::set<Entity> lights;
-inline std::vector<Buffer> lightingBuffers;
-inline std::vector<Buffer> timeBuffers;
+inline EntitySet lights;
+// Per frame uniforms, offsets are in a frame region
+inline RingBuffer frameUniforms;
+inline VkDeviceSize cameraUniformOffset;
+inline VkDeviceSize lightingUniformOffset;
+inline VkDeviceSize timeUniformOffset;
 inline Image colorImage;
 inline DepthPrepass depthPrepass;
 inline Envmap envmap;
@@ -5,14 +5,16 @@
 extern ECS ecs;
 
 void Physics::update(double deltaTime) {
-	for (const auto& entity : entities) {
-		auto& entityRigidbody = ecs.getComponent<Rigidbody>(entity);
-
-		if (entityRigidbody.affectedByGravity) {
-			auto& entityTransform = ecs.getComponent<Transform>(entity);
-
-			entityTransform.position += entityRigidbody.velocity * static_cast<float>(deltaTime);
-			entityRigidbody.velocity += gravity * static_cast<float>(deltaTime);
-		}
-	}
+	// Bodies at rest are only read, the integrating ones are written through getComponent which marks them as changed
+	View<const Rigidbody, const Transform>& rigidbodies = ecs.view<const Rigidbody, const Transform>();
+	threadPool->parallelFor(rigidbodies.getChunkCount(), [&](uint32_t chunk) {
+		rigidbodies.eachInChunk(chunk, [&](Entity entity, const Rigidbody& entityRigidbody, const Transform&) {
+			if (entityRigidbody.affectedByGravity) {
+				Rigidbody& integratedRigidbody = ecs.getComponent<Rigidbody>(entity);
+				Transform& integratedTransform = ecs.getComponent<Transform>(entity);
+				integratedTransform.position += integratedRigidbody.velocity * static_cast<float>(deltaTime);
+				integratedRigidbody.velocity += gravity * static_cast<float>(deltaTime);
+			}
+		});
+	});
 }
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Logging and assertions, without any graphics dependency so headless targets can use them
+#define NEIGE_WARNING(m) \
+	do { \
+		std::cerr << "\033[1m\033[33mNEIGE WARNING : \033[39m\033[0m" << m << std::endl; \
+	} while(0)
+
+#define NEIGE_ERROR(m) \
+	do { \
+		std::cerr << "\033[1m\033[31mNEIGE ERROR : \033[39m\033[0m" << m << std::endl; \
+		exit(2); \
+	} while(0)
+
+#ifndef NDEBUG
+#define NEIGE_INFO(m) \
+	do { \
+		std::cout << "\033[1m\033[36mNEIGE INFO : \033[39m\033[0m" << m << std::endl; \
+	} while(0)
+#else
+#define NEIGE_INFO(m)
+#endif
+
+#ifndef NDEBUG
+#define NEIGE_ASSERT(c, m) \
+		do { \
+			if (!(c)) { \
+				std::cerr << "\033[1m\033[35mNEIGE ASSERT : \033[39m\033[0m" << m << std::endl; \
+				exit(3); \
+			} \
+		} while(0)
+#else
+#define NEIGE_ASSERT(c, m)
+#endif
+
+#ifndef NDEBUG
+const bool NEIGE_DEBUG = true;
+#else
+const bool NEIGE_DEBUG = false;
+#endif
\ No newline at end of file
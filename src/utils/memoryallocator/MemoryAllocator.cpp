@@ -95,53 +95,37 @@ void MemoryAllocator::destroy() {
 VkDeviceSize MemoryAllocator::allocate(VkBuffer* bufferToAllocate, VkMemoryPropertyFlags flags) {
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(logicalDevice.device, *bufferToAllocate, &memRequirements);
-	int32_t properties = findProperties(memRequirements.memoryTypeBits, flags);
-
-	// Look for the first block with enough space
-	for (Chunk& chunk : chunks) {
-		if (chunk.type == properties) {
-			VkDeviceSize offset;
-			offset = chunk.allocate(memRequirements, &allocationNumber);
-
-			if (offset != -1) {
-				vkBindBufferMemory(logicalDevice.device, *bufferToAllocate, chunk.memory, offset);
-				return allocationNumber - 1;
-			}
-		}
-	}
 
-	// No block has been found, create a new chunk
-	Chunk newChunk = Chunk(properties, std::max((VkDeviceSize)CHUNK_SIZE, memRequirements.size));
-
-	// Add to this chunk
+	VkDeviceMemory memory;
 	VkDeviceSize offset;
-	offset = newChunk.allocate(memRequirements, &allocationNumber);
+	VkDeviceSize allocationId = allocate(memRequirements, flags, &memory, &offset);
+	vkBindBufferMemory(logicalDevice.device, *bufferToAllocate, memory, offset);
 
-	if (offset == -1) {
-		NEIGE_ERROR("Unable to allocate memory (buffer).");
-	}
-
-	vkBindBufferMemory(logicalDevice.device, *bufferToAllocate, newChunk.memory, offset);
-
-	chunks.push_back(newChunk);
-
-	NEIGE_INFO("New memory chunk allocated.");
-	return allocationNumber - 1;
+	return allocationId;
 }
 
 VkDeviceSize MemoryAllocator::allocate(VkImage* imageToAllocate, VkMemoryPropertyFlags flags) {
 	VkMemoryRequirements memRequirements;
 	vkGetImageMemoryRequirements(logicalDevice.device, *imageToAllocate, &memRequirements);
+
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize allocationId = allocate(memRequirements, flags, &memory, &offset);
+	vkBindImageMemory(logicalDevice.device, *imageToAllocate, memory, offset);
+
+	return allocationId;
+}
+
+VkDeviceSize MemoryAllocator::allocate(VkMemoryRequirements memRequirements, VkMemoryPropertyFlags flags, VkDeviceMemory* memory, VkDeviceSize* offset) {
 	int32_t properties = findProperties(memRequirements.memoryTypeBits, flags);
 
 	// Look for the first block with enough space
 	for (Chunk& chunk : chunks) {
 		if (chunk.type == properties) {
-			VkDeviceSize offset;
-			offset = chunk.allocate(memRequirements, &allocationNumber);
+			*offset = chunk.allocate(memRequirements, &allocationNumber);
 
-			if (offset != -1) {
-				vkBindImageMemory(logicalDevice.device, *imageToAllocate, chunk.memory, offset);
+			if (*offset != -1) {
+				*memory = chunk.memory;
 				return allocationNumber - 1;
 			}
 		}
@@ -151,14 +135,13 @@ VkDeviceSize MemoryAllocator::allocate(VkImage* imageToAllocate, VkMemoryPropert
 	Chunk newChunk = Chunk(properties, std::max((VkDeviceSize)CHUNK_SIZE, memRequirements.size));
 
 	// Add to this chunk
-	VkDeviceSize offset;
-	offset = newChunk.allocate(memRequirements, &allocationNumber);
+	*offset = newChunk.allocate(memRequirements, &allocationNumber);
 
-	if (offset == -1) {
-		NEIGE_ERROR("Unable to allocate memory (image).");
+	if (*offset == -1) {
+		NEIGE_ERROR("Unable to allocate memory.");
 	}
 
-	vkBindImageMemory(logicalDevice.device, *imageToAllocate, newChunk.memory, offset);
+	*memory = newChunk.memory;
 
 	chunks.push_back(newChunk);
 
@@ -35,6 +35,8 @@ struct MemoryAllocator {
 	void destroy();
 	VkDeviceSize allocate(VkBuffer* bufferToAllocate, VkMemoryPropertyFlags flags);
 	VkDeviceSize allocate(VkImage* imageToAllocate, VkMemoryPropertyFlags flags);
+	// Memory the caller binds itself, several resources can be bound to it
+	VkDeviceSize allocate(VkMemoryRequirements memRequirements, VkMemoryPropertyFlags flags, VkDeviceMemory* memory, VkDeviceSize* offset);
 	void deallocate(VkDeviceSize allocationId);
 	int32_t findProperties(uint32_t memoryTypeBitsRequirement, VkMemoryPropertyFlags requiredProperties);
 	void memoryAnalyzer();
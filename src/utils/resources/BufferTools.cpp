@@ -42,6 +42,30 @@ void BufferTools::createStagingBuffer(VkBuffer& buffer,
 	vkBindBufferMemory(logicalDevice.device, buffer, deviceMemory, 0);
 }
 
+void BufferTools::createReadbackBuffer(VkBuffer& buffer,
+	VkDeviceMemory& deviceMemory,
+	VkDeviceSize size) {
+	VkBufferCreateInfo bufferCreateInfo = {};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.pNext = nullptr;
+	bufferCreateInfo.flags = 0;
+	bufferCreateInfo.size = size;
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	NEIGE_VK_CHECK(vkCreateBuffer(logicalDevice.device, &bufferCreateInfo, nullptr, &buffer));
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(logicalDevice.device, buffer, &memoryRequirements);
+	VkMemoryAllocateInfo memoryAllocateInfo = {};
+	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.pNext = nullptr;
+	memoryAllocateInfo.allocationSize = memoryRequirements.size;
+	memoryAllocateInfo.memoryTypeIndex = memoryAllocator.findProperties(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	NEIGE_VK_CHECK(vkAllocateMemory(logicalDevice.device, &memoryAllocateInfo, nullptr, &deviceMemory));
+
+	vkBindBufferMemory(logicalDevice.device, buffer, deviceMemory, 0);
+}
+
 void BufferTools::createUniformBuffer(VkBuffer& buffer,
 	VkDeviceMemory& deviceMemory,
 	VkDeviceSize size) {
@@ -66,9 +90,34 @@ void BufferTools::createUniformBuffer(VkBuffer& buffer,
 	vkBindBufferMemory(logicalDevice.device, buffer, deviceMemory, 0);
 }
 
+void BufferTools::createStorageBuffer(VkBuffer& buffer,
+	VkDeviceMemory& deviceMemory,
+	VkDeviceSize size) {
+	VkBufferCreateInfo bufferCreateInfo = {};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.pNext = nullptr;
+	bufferCreateInfo.flags = 0;
+	bufferCreateInfo.size = size;
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	NEIGE_VK_CHECK(vkCreateBuffer(logicalDevice.device, &bufferCreateInfo, nullptr, &buffer));
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(logicalDevice.device, buffer, &memoryRequirements);
+	VkMemoryAllocateInfo memoryAllocateInfo = {};
+	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocateInfo.pNext = nullptr;
+	memoryAllocateInfo.allocationSize = memoryRequirements.size;
+	memoryAllocateInfo.memoryTypeIndex = memoryAllocator.findProperties(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	NEIGE_VK_CHECK(vkAllocateMemory(logicalDevice.device, &memoryAllocateInfo, nullptr, &deviceMemory));
+
+	vkBindBufferMemory(logicalDevice.device, buffer, deviceMemory, 0);
+}
+
 void BufferTools::copyBuffer(VkBuffer srcBuffer,
 	VkBuffer dstBuffer,
-	VkDeviceSize size) {
+	VkDeviceSize size,
+	VkDeviceSize dstOffset) {
 	CommandPool commandPool;
 	commandPool.init();
 	CommandBuffer commandBuffer;
@@ -77,7 +126,7 @@ void BufferTools::copyBuffer(VkBuffer srcBuffer,
 
 	VkBufferCopy bufferCopy = {};
 	bufferCopy.srcOffset = 0;
-	bufferCopy.dstOffset = 0;
+	bufferCopy.dstOffset = dstOffset;
 	bufferCopy.size = size;
 	vkCmdCopyBuffer(commandBuffer.commandBuffer, srcBuffer, dstBuffer, 1, &bufferCopy);
 
@@ -13,12 +13,20 @@ struct BufferTools {
 	static void createStagingBuffer(VkBuffer& buffer,
 		VkDeviceMemory& deviceMemory,
 		VkDeviceSize size);
+	// Host visible copy destination, to read device local buffers back
+	static void createReadbackBuffer(VkBuffer& buffer,
+		VkDeviceMemory& deviceMemory,
+		VkDeviceSize size);
 	static void createUniformBuffer(VkBuffer& buffer,
 		VkDeviceMemory& deviceMemory,
 		VkDeviceSize size);
+	static void createStorageBuffer(VkBuffer& buffer,
+		VkDeviceMemory& deviceMemory,
+		VkDeviceSize size);
 	static void copyBuffer(VkBuffer srcBuffer,
 		VkBuffer dstBuffer,
-		VkDeviceSize size);
+		VkDeviceSize size,
+		VkDeviceSize dstOffset = 0);
 	static void copyToImage(VkBuffer srcBuffer,
 		VkImage dstImage,
 		uint32_t width,
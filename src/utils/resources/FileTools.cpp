@@ -1,4 +1,12 @@
 #include "FileTools.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 std::string FileTools::readAscii(const std::string& filePath) {
     std::ifstream file(filePath, std::ios::in | std::ios::ate);
@@ -43,3 +51,65 @@ std::string FileTools::fileGetDirectory(const std::string& filePath) {
     }
     return filePath.substr(0, slashPosition + 1);
 }
+
+void MappedFile::map(const std::string& filePath) {
+#ifdef _WIN32
+    fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        NEIGE_ERROR("File \"" + filePath + "\" could not be opened (Mapped).");
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) {
+        return;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL) {
+        NEIGE_ERROR("File \"" + filePath + "\" could not be mapped.");
+    }
+    data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+    fileDescriptor = open(filePath.c_str(), O_RDONLY);
+    if (fileDescriptor == -1) {
+        NEIGE_ERROR("File \"" + filePath + "\" could not be opened (Mapped).");
+    }
+    struct stat fileStat;
+    fstat(fileDescriptor, &fileStat);
+    size = static_cast<size_t>(fileStat.st_size);
+    if (size == 0) {
+        return;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        NEIGE_ERROR("File \"" + filePath + "\" could not be mapped.");
+    }
+    data = static_cast<const char*>(mapping);
+#endif
+}
+
+void MappedFile::unmap() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle && fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+    if (fileDescriptor != -1) {
+        close(fileDescriptor);
+    }
+    fileDescriptor = -1;
+#endif
+    data = nullptr;
+    size = 0;
+}
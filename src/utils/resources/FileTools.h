@@ -10,4 +10,19 @@ struct FileTools {
 	static std::string filename(const std::string& filePath);
 	static std::string extension(const std::string& filePath);
 	static std::string fileGetDirectory(const std::string& filePath);
+};
+
+// Read-only memory mapping of a whole file
+struct MappedFile {
+	const char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+
+	void map(const std::string& filePath);
+	void unmap();
 };
\ No newline at end of file
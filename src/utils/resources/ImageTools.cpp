@@ -13,6 +13,19 @@ void ImageTools::createImage(VkImage* image,
 	VkImageUsageFlags usage,
 	VkMemoryPropertyFlags memoryProperties,
 	VkDeviceSize* allocationId) {
+	createUnboundImage(image, arrayLayers, width, height, mipLevels, msaaSamples, format, usage);
+
+	*allocationId = memoryAllocator.allocate(image, memoryProperties);
+}
+
+void ImageTools::createUnboundImage(VkImage* image,
+	uint32_t arrayLayers,
+	uint32_t width,
+	uint32_t height,
+	uint32_t mipLevels,
+	VkSampleCountFlagBits msaaSamples,
+	VkFormat format,
+	VkImageUsageFlags usage) {
 	VkImageCreateInfo imageCreateInfo = {};
 	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageCreateInfo.pNext = nullptr;
@@ -30,8 +43,6 @@ void ImageTools::createImage(VkImage* image,
 	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	NEIGE_VK_CHECK(vkCreateImage(logicalDevice.device, &imageCreateInfo, nullptr, image));
-
-	*allocationId = memoryAllocator.allocate(image, memoryProperties);
 }
 
 void ImageTools::createImageView(VkImageView* imageView,
@@ -19,6 +19,15 @@ struct ImageTools {
 		VkImageUsageFlags usage,
 		VkMemoryPropertyFlags memoryProperties,
 		VkDeviceSize* allocationId);
+	// Image without memory, for the caller to bind
+	static void createUnboundImage(VkImage* image,
+		uint32_t arrayLayers,
+		uint32_t width,
+		uint32_t height,
+		uint32_t mipLevels,
+		VkSampleCountFlagBits msaaSamples,
+		VkFormat format,
+		VkImageUsageFlags usage);
 	static void createImageView(VkImageView* imageView,
 		VkImage image,
 		uint32_t baseArrayLayer,
@@ -207,6 +207,25 @@ void ModelLoader::loadglTFNode(const std::string& filePath, cgltf_node* node, ui
 			}
 			vertexCount += static_cast<int32_t>(primitiveVertices.size());
 
+			// Bounds
+			AABB primitiveAABB;
+			BoundingSphere primitiveBoundingSphere;
+			if (!primitiveVertices.empty()) {
+				for (const Vertex& vertex : primitiveVertices) {
+					primitiveAABB.min = glm::min(primitiveAABB.min, vertex.position);
+					primitiveAABB.max = glm::max(primitiveAABB.max, vertex.position);
+				}
+
+				primitiveBoundingSphere.center = (primitiveAABB.min + primitiveAABB.max) * 0.5f;
+				for (const Vertex& vertex : primitiveVertices) {
+					primitiveBoundingSphere.radius = std::max(primitiveBoundingSphere.radius, glm::length(vertex.position - primitiveBoundingSphere.center));
+				}
+			}
+			else {
+				primitiveAABB.min = glm::vec3(0.0f);
+				primitiveAABB.max = glm::vec3(0.0f);
+			}
+
 			// Indices
 			cgltf_accessor* accessor = primitive->indices;
 			if (accessor != NULL) {
@@ -414,7 +433,7 @@ void ModelLoader::loadglTFNode(const std::string& filePath, cgltf_node* node, ui
 			}
 
 			// Primitive
-			primitives.push_back({ firstIndex, indexCount, vertexOffset, materialID });
+			primitives.push_back({ firstIndex, indexCount, vertexOffset, materialID, primitiveAABB, primitiveBoundingSphere });
 
 			vertices->insert(vertices->end(), primitiveVertices.begin(), primitiveVertices.end());
 			indices->insert(indices->end(), primitiveIndices.begin(), primitiveIndices.end());
@@ -431,6 +450,15 @@ void ModelLoader::loadglTFNode(const std::string& filePath, cgltf_node* node, ui
 
 		modelMesh.primitives = primitives;
 
+		for (const Primitive& modelPrimitive : primitives) {
+			modelMesh.aabb.min = glm::min(modelMesh.aabb.min, modelPrimitive.aabb.min);
+			modelMesh.aabb.max = glm::max(modelMesh.aabb.max, modelPrimitive.aabb.max);
+		}
+		modelMesh.boundingSphere.center = (modelMesh.aabb.min + modelMesh.aabb.max) * 0.5f;
+		for (const Primitive& modelPrimitive : primitives) {
+			modelMesh.boundingSphere.radius = std::max(modelMesh.boundingSphere.radius, glm::length(modelPrimitive.boundingSphere.center - modelMesh.boundingSphere.center) + modelPrimitive.boundingSphere.radius);
+		}
+
 		if (node->skin != NULL) {
 			cgltf_skin* skin = node->skin;
 
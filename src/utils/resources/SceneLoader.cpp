@@ -0,0 +1,382 @@
+#include "SceneLoader.h"
+#include "../../ecs/components/Camera.h"
+#include "../../ecs/components/Light.h"
+#include "../../ecs/components/Renderable.h"
+#include "../../ecs/components/Rigidbody.h"
+#include "../../ecs/components/Transform.h"
+#include <fstream>
+#include <unordered_map>
+
+extern ECS ecs;
+
+static Component sceneComponentId(SceneComponentType type) {
+	switch (type) {
+	case SceneComponentType::TRANSFORM:
+		return ecs.getComponentId<Transform>();
+	case SceneComponentType::CAMERA:
+		return ecs.getComponentId<Camera>();
+	case SceneComponentType::LIGHT:
+		return ecs.getComponentId<Light>();
+	case SceneComponentType::RENDERABLE:
+		return ecs.getComponentId<Renderable>();
+	case SceneComponentType::RIGIDBODY:
+		return ecs.getComponentId<Rigidbody>();
+	}
+
+	return MAX_COMPONENTS;
+}
+
+static glm::vec3 sceneVec3(const float* values) {
+	return glm::vec3(values[0], values[1], values[2]);
+}
+
+static void sceneStoreVec3(float* values, glm::vec3 vector) {
+	values[0] = vector.x;
+	values[1] = vector.y;
+	values[2] = vector.z;
+}
+
+template<typename R>
+static const R* sceneRecords(const std::string& filePath, const MappedFile& file, const SceneComponentColumn& column) {
+	if (column.recordSize != sizeof(R)) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" has a component type with a wrong record size (" + std::to_string(column.recordSize) + ").");
+	}
+
+	return reinterpret_cast<const R*>(file.data + column.recordsOffset);
+}
+
+template<typename R>
+static void appendSceneColumn(std::vector<SceneComponentColumn>& columns, std::vector<char>& payload, SceneComponentType type, const std::vector<uint32_t>& entities, const std::vector<R>& records) {
+	if (entities.empty()) {
+		return;
+	}
+
+	SceneComponentColumn column;
+	column.type = type;
+	column.recordSize = sizeof(R);
+	column.count = static_cast<uint32_t>(entities.size());
+	column.entitiesOffset = static_cast<uint32_t>(payload.size());
+	payload.insert(payload.end(), reinterpret_cast<const char*>(entities.data()), reinterpret_cast<const char*>(entities.data() + entities.size()));
+	column.recordsOffset = static_cast<uint32_t>(payload.size());
+	payload.insert(payload.end(), reinterpret_cast<const char*>(records.data()), reinterpret_cast<const char*>(records.data() + records.size()));
+	columns.push_back(column);
+}
+
+std::vector<Entity> SceneLoader::load(const std::string& filePath) {
+	MappedFile file;
+	file.map(filePath);
+
+	if (file.size < sizeof(SceneHeader)) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" is too small.");
+	}
+	const SceneHeader* header = reinterpret_cast<const SceneHeader*>(file.data);
+	if (header->magic != NEIGE_SCENE_MAGIC) {
+		NEIGE_ERROR("File \"" + filePath + "\" is not a scene.");
+	}
+	if (header->version != NEIGE_SCENE_VERSION) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" version " + std::to_string(header->version) + " is not supported.");
+	}
+
+	// Bounds
+	size_t columnsEnd = sizeof(SceneHeader) + static_cast<size_t>(header->componentTypeCount) * sizeof(SceneComponentColumn);
+	size_t stringsBegin = static_cast<size_t>(header->stringTableOffset) + (static_cast<size_t>(header->stringCount) + 1) * sizeof(uint32_t);
+	if (columnsEnd > file.size || stringsBegin > file.size) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" is truncated.");
+	}
+	if ((header->stringTableOffset % sizeof(uint32_t)) != 0) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" has a misaligned string table offset (" + std::to_string(header->stringTableOffset) + ").");
+	}
+	const SceneComponentColumn* columns = reinterpret_cast<const SceneComponentColumn*>(file.data + sizeof(SceneHeader));
+	for (uint32_t i = 0; i < header->componentTypeCount; i++) {
+		const SceneComponentColumn& column = columns[i];
+		if (column.entitiesOffset + static_cast<size_t>(column.count) * sizeof(uint32_t) > file.size || column.recordsOffset + static_cast<size_t>(column.count) * column.recordSize > file.size) {
+			NEIGE_ERROR("Scene \"" + filePath + "\" is truncated.");
+		}
+		if ((column.entitiesOffset % sizeof(uint32_t)) != 0 || (column.recordsOffset % sizeof(uint32_t)) != 0) {
+			NEIGE_ERROR("Scene \"" + filePath + "\" has a misaligned component type offset.");
+		}
+	}
+
+	const uint32_t* stringOffsets = reinterpret_cast<const uint32_t*>(file.data + header->stringTableOffset);
+	const char* stringData = file.data + stringsBegin;
+	size_t stringDataSize = file.size - stringsBegin;
+	auto sceneString = [&](uint32_t index) {
+		if (index >= header->stringCount || stringOffsets[index] > stringOffsets[index + 1] || stringOffsets[index + 1] > stringDataSize) {
+			NEIGE_ERROR("Scene \"" + filePath + "\" has a wrong string index (" + std::to_string(index) + ").");
+		}
+
+		return std::string(stringData + stringOffsets[index], stringOffsets[index + 1] - stringOffsets[index]);
+	};
+
+	// Component masks, a component type has one column and an entity appears once in it
+	std::vector<ComponentMask> masks(header->entityCount);
+	ComponentMask columnComponents;
+	for (uint32_t i = 0; i < header->componentTypeCount; i++) {
+		const SceneComponentColumn& column = columns[i];
+		Component component = sceneComponentId(column.type);
+		if (component == MAX_COMPONENTS) {
+			NEIGE_WARNING("Scene \"" + filePath + "\" has an unknown component type (" + std::to_string(static_cast<uint32_t>(column.type)) + "), it is ignored.");
+			continue;
+		}
+		if (columnComponents.test(component)) {
+			NEIGE_ERROR("Scene \"" + filePath + "\" has a component type stored twice (" + std::to_string(static_cast<uint32_t>(column.type)) + ").");
+		}
+		columnComponents.set(component);
+
+		const uint32_t* entityIndices = reinterpret_cast<const uint32_t*>(file.data + column.entitiesOffset);
+		for (uint32_t j = 0; j < column.count; j++) {
+			if (entityIndices[j] >= header->entityCount) {
+				NEIGE_ERROR("Scene \"" + filePath + "\" has a wrong entity index (" + std::to_string(entityIndices[j]) + ").");
+			}
+			if (masks[entityIndices[j]].test(component)) {
+				NEIGE_ERROR("Scene \"" + filePath + "\" has an entity index stored twice in a component type (" + std::to_string(entityIndices[j]) + ").");
+			}
+			masks[entityIndices[j]].set(component);
+		}
+	}
+
+	// Entities sharing a mask get their structural change at once, entity sets are checked once per mask
+	std::vector<Entity> entities = ecs.createEntities(header->entityCount);
+	std::unordered_map<ComponentMask, std::vector<Entity>> entitiesPerMask;
+	for (uint32_t i = 0; i < header->entityCount; i++) {
+		if (masks[i].any()) {
+			entitiesPerMask[masks[i]].push_back(entities[i]);
+		}
+	}
+	for (auto const& pair : entitiesPerMask) {
+		ecs.initializeComponents(pair.second, pair.first);
+	}
+
+	// Component columns
+	for (uint32_t i = 0; i < header->componentTypeCount; i++) {
+		const SceneComponentColumn& column = columns[i];
+		const uint32_t* entityIndices = reinterpret_cast<const uint32_t*>(file.data + column.entitiesOffset);
+
+		switch (column.type) {
+		case SceneComponentType::TRANSFORM: {
+			const SceneTransform* transforms = sceneRecords<SceneTransform>(filePath, file, column);
+			for (uint32_t j = 0; j < column.count; j++) {
+				const SceneTransform& record = transforms[j];
+				Transform transform;
+				transform.position = sceneVec3(record.position);
+				transform.rotation = glm::quat(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]);
+				transform.scale = sceneVec3(record.scale);
+				transform.parent = record.parent < header->entityCount ? entities[record.parent] : NO_ENTITY;
+				ecs.emplaceComponent(entities[entityIndices[j]], transform);
+			}
+			break;
+		}
+		case SceneComponentType::CAMERA: {
+			const SceneCamera* cameras = sceneRecords<SceneCamera>(filePath, file, column);
+			for (uint32_t j = 0; j < column.count; j++) {
+				const SceneCamera& record = cameras[j];
+				Camera camera;
+				camera.position = sceneVec3(record.position);
+				camera.to = sceneVec3(record.to);
+				camera.FOV = record.FOV;
+				camera.nearPlane = record.nearPlane;
+				camera.farPlane = record.farPlane;
+				camera.envmapPath = sceneString(record.envmapPath);
+				ecs.emplaceComponent(entities[entityIndices[j]], std::move(camera));
+			}
+			break;
+		}
+		case SceneComponentType::LIGHT: {
+			const SceneLight* lights = sceneRecords<SceneLight>(filePath, file, column);
+			for (uint32_t j = 0; j < column.count; j++) {
+				const SceneLight& record = lights[j];
+				Light light;
+				light.type = static_cast<LightType>(record.type);
+				light.position = sceneVec3(record.position);
+				light.direction = sceneVec3(record.direction);
+				light.color = sceneVec3(record.color);
+				light.cutoffs = glm::vec2(record.cutoffs[0], record.cutoffs[1]);
+				ecs.emplaceComponent(entities[entityIndices[j]], light);
+			}
+			break;
+		}
+		case SceneComponentType::RENDERABLE: {
+			const SceneRenderable* renderables = sceneRecords<SceneRenderable>(filePath, file, column);
+			for (uint32_t j = 0; j < column.count; j++) {
+				const SceneRenderable& record = renderables[j];
+				Renderable renderable;
+				renderable.modelPath = sceneString(record.modelPath);
+				renderable.vertexShaderPath = sceneString(record.vertexShaderPath);
+				renderable.fragmentShaderPath = sceneString(record.fragmentShaderPath);
+				renderable.tesselationControlShaderPath = sceneString(record.tesselationControlShaderPath);
+				renderable.tesselationEvaluationShaderPath = sceneString(record.tesselationEvaluationShaderPath);
+				renderable.geometryShaderPath = sceneString(record.geometryShaderPath);
+				renderable.topology = static_cast<Topology>(record.topology);
+				ecs.emplaceComponent(entities[entityIndices[j]], std::move(renderable));
+			}
+			break;
+		}
+		case SceneComponentType::RIGIDBODY: {
+			const SceneRigidbody* rigidbodies = sceneRecords<SceneRigidbody>(filePath, file, column);
+			for (uint32_t j = 0; j < column.count; j++) {
+				const SceneRigidbody& record = rigidbodies[j];
+				Rigidbody rigidbody;
+				rigidbody.velocity = sceneVec3(record.velocity);
+				rigidbody.acceleration = sceneVec3(record.acceleration);
+				rigidbody.affectedByGravity = record.affectedByGravity != 0;
+				ecs.emplaceComponent(entities[entityIndices[j]], rigidbody);
+			}
+			break;
+		}
+		}
+	}
+
+	NEIGE_INFO("Scene \"" + filePath + "\" loaded (" + std::to_string(header->entityCount) + " entities).");
+
+	file.unmap();
+
+	return entities;
+}
+
+void SceneLoader::save(const std::string& filePath) {
+	// Scene indices, in order of the component types
+	std::vector<Entity> sceneEntities;
+	std::unordered_map<Entity, uint32_t> sceneIndices;
+	auto gatherEntities = [&](const EntitySet& entitySet) {
+		for (Entity entity : entitySet) {
+			if (sceneIndices.emplace(entity, static_cast<uint32_t>(sceneEntities.size())).second) {
+				sceneEntities.push_back(entity);
+			}
+		}
+	};
+	gatherEntities(ecs.view<const Transform>().entities);
+	gatherEntities(ecs.view<const Camera>().entities);
+	gatherEntities(ecs.view<const Light>().entities);
+	gatherEntities(ecs.view<const Renderable>().entities);
+	gatherEntities(ecs.view<const Rigidbody>().entities);
+
+	// String table, index 0 is the empty string
+	std::vector<std::string> strings = { "" };
+	std::unordered_map<std::string, uint32_t> stringIndices = { { "", 0 } };
+	auto sceneString = [&](const std::string& string) {
+		auto stringIndex = stringIndices.emplace(string, static_cast<uint32_t>(strings.size()));
+		if (stringIndex.second) {
+			strings.push_back(string);
+		}
+
+		return stringIndex.first->second;
+	};
+
+	std::vector<SceneComponentColumn> columns;
+	std::vector<char> payload;
+	std::vector<uint32_t> entityIndices;
+
+	std::vector<SceneTransform> transforms;
+	for (Entity entity : ecs.view<const Transform>().entities) {
+		const Transform& transform = ecs.readComponent<Transform>(entity);
+		SceneTransform record;
+		sceneStoreVec3(record.position, transform.position);
+		record.rotation[0] = transform.rotation.w;
+		record.rotation[1] = transform.rotation.x;
+		record.rotation[2] = transform.rotation.y;
+		record.rotation[3] = transform.rotation.z;
+		sceneStoreVec3(record.scale, transform.scale);
+		auto parentIndex = sceneIndices.find(transform.parent);
+		record.parent = parentIndex != sceneIndices.end() ? parentIndex->second : NO_ENTITY;
+		entityIndices.push_back(sceneIndices[entity]);
+		transforms.push_back(record);
+	}
+	appendSceneColumn(columns, payload, SceneComponentType::TRANSFORM, entityIndices, transforms);
+	entityIndices.clear();
+
+	std::vector<SceneCamera> cameras;
+	for (Entity entity : ecs.view<const Camera>().entities) {
+		const Camera& camera = ecs.readComponent<Camera>(entity);
+		SceneCamera record;
+		sceneStoreVec3(record.position, camera.position);
+		sceneStoreVec3(record.to, camera.to);
+		record.FOV = camera.FOV;
+		record.nearPlane = camera.nearPlane;
+		record.farPlane = camera.farPlane;
+		record.envmapPath = sceneString(camera.envmapPath);
+		entityIndices.push_back(sceneIndices[entity]);
+		cameras.push_back(record);
+	}
+	appendSceneColumn(columns, payload, SceneComponentType::CAMERA, entityIndices, cameras);
+	entityIndices.clear();
+
+	std::vector<SceneLight> lights;
+	for (Entity entity : ecs.view<const Light>().entities) {
+		const Light& light = ecs.readComponent<Light>(entity);
+		SceneLight record;
+		record.type = static_cast<uint32_t>(light.type);
+		sceneStoreVec3(record.position, light.position);
+		sceneStoreVec3(record.direction, light.direction);
+		sceneStoreVec3(record.color, light.color);
+		record.cutoffs[0] = light.cutoffs.x;
+		record.cutoffs[1] = light.cutoffs.y;
+		entityIndices.push_back(sceneIndices[entity]);
+		lights.push_back(record);
+	}
+	appendSceneColumn(columns, payload, SceneComponentType::LIGHT, entityIndices, lights);
+	entityIndices.clear();
+
+	std::vector<SceneRenderable> renderables;
+	for (Entity entity : ecs.view<const Renderable>().entities) {
+		const Renderable& renderable = ecs.readComponent<Renderable>(entity);
+		SceneRenderable record;
+		record.modelPath = sceneString(renderable.modelPath);
+		record.vertexShaderPath = sceneString(renderable.vertexShaderPath);
+		record.fragmentShaderPath = sceneString(renderable.fragmentShaderPath);
+		record.tesselationControlShaderPath = sceneString(renderable.tesselationControlShaderPath);
+		record.tesselationEvaluationShaderPath = sceneString(renderable.tesselationEvaluationShaderPath);
+		record.geometryShaderPath = sceneString(renderable.geometryShaderPath);
+		record.topology = static_cast<uint32_t>(renderable.topology);
+		entityIndices.push_back(sceneIndices[entity]);
+		renderables.push_back(record);
+	}
+	appendSceneColumn(columns, payload, SceneComponentType::RENDERABLE, entityIndices, renderables);
+	entityIndices.clear();
+
+	std::vector<SceneRigidbody> rigidbodies;
+	for (Entity entity : ecs.view<const Rigidbody>().entities) {
+		const Rigidbody& rigidbody = ecs.readComponent<Rigidbody>(entity);
+		SceneRigidbody record;
+		sceneStoreVec3(record.velocity, rigidbody.velocity);
+		sceneStoreVec3(record.acceleration, rigidbody.acceleration);
+		record.affectedByGravity = rigidbody.affectedByGravity ? 1 : 0;
+		entityIndices.push_back(sceneIndices[entity]);
+		rigidbodies.push_back(record);
+	}
+	appendSceneColumn(columns, payload, SceneComponentType::RIGIDBODY, entityIndices, rigidbodies);
+	entityIndices.clear();
+
+	// Payload offsets are relative to the end of the component table
+	uint32_t payloadOffset = static_cast<uint32_t>(sizeof(SceneHeader) + columns.size() * sizeof(SceneComponentColumn));
+	for (SceneComponentColumn& column : columns) {
+		column.entitiesOffset += payloadOffset;
+		column.recordsOffset += payloadOffset;
+	}
+
+	SceneHeader header;
+	header.magic = NEIGE_SCENE_MAGIC;
+	header.version = NEIGE_SCENE_VERSION;
+	header.entityCount = static_cast<uint32_t>(sceneEntities.size());
+	header.componentTypeCount = static_cast<uint32_t>(columns.size());
+	header.stringCount = static_cast<uint32_t>(strings.size());
+	header.stringTableOffset = payloadOffset + static_cast<uint32_t>(payload.size());
+
+	std::vector<uint32_t> stringOffsets = { 0 };
+	for (const std::string& string : strings) {
+		stringOffsets.push_back(stringOffsets.back() + static_cast<uint32_t>(string.size()));
+	}
+
+	std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		NEIGE_ERROR("Scene \"" + filePath + "\" could not be opened for writing.");
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(SceneHeader));
+	file.write(reinterpret_cast<const char*>(columns.data()), columns.size() * sizeof(SceneComponentColumn));
+	file.write(payload.data(), payload.size());
+	file.write(reinterpret_cast<const char*>(stringOffsets.data()), stringOffsets.size() * sizeof(uint32_t));
+	for (const std::string& string : strings) {
+		file.write(string.data(), string.size());
+	}
+
+	NEIGE_INFO("Scene \"" + filePath + "\" saved (" + std::to_string(header.entityCount) + " entities).");
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include "../NeigeDefines.h"
+#include "../../ecs/ECS.h"
+#include "FileTools.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary scene
+// Header | component table | per component type: entity indices then packed records | string table
+// Offsets are in bytes from the start of the file and 4 bytes aligned
+#define NEIGE_SCENE_MAGIC 0x4E43534E
+#define NEIGE_SCENE_VERSION 1
+
+enum struct SceneComponentType : uint32_t {
+	TRANSFORM,
+	CAMERA,
+	LIGHT,
+	RENDERABLE,
+	RIGIDBODY
+};
+
+struct SceneHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entityCount;
+	uint32_t componentTypeCount;
+	uint32_t stringCount;
+	uint32_t stringTableOffset;
+};
+
+struct SceneComponentColumn {
+	SceneComponentType type;
+	uint32_t recordSize;
+	uint32_t count;
+	uint32_t entitiesOffset;
+	uint32_t recordsOffset;
+};
+
+// Records, strings are indices in the string table and entities are indices in the scene
+struct SceneTransform {
+	float position[3];
+	// w, x, y, z
+	float rotation[4];
+	float scale[3];
+	uint32_t parent;
+};
+
+struct SceneCamera {
+	float position[3];
+	float to[3];
+	float FOV;
+	float nearPlane;
+	float farPlane;
+	uint32_t envmapPath;
+};
+
+struct SceneLight {
+	uint32_t type;
+	float position[3];
+	float direction[3];
+	float color[3];
+	float cutoffs[2];
+};
+
+struct SceneRenderable {
+	uint32_t modelPath;
+	uint32_t vertexShaderPath;
+	uint32_t fragmentShaderPath;
+	uint32_t tesselationControlShaderPath;
+	uint32_t tesselationEvaluationShaderPath;
+	uint32_t geometryShaderPath;
+	uint32_t topology;
+};
+
+struct SceneRigidbody {
+	float velocity[3];
+	float acceleration[3];
+	uint32_t affectedByGravity;
+};
+
+struct SceneLoader {
+	// Components must be registered, returns the created entities in scene order
+	static std::vector<Entity> load(const std::string& filePath);
+	// Writes every entity with at least one of the scene components
+	static void save(const std::string& filePath);
+};
\ No newline at end of file
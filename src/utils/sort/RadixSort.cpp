@@ -0,0 +1,36 @@
+#include "RadixSort.h"
+#include <array>
+
+void RadixSort::sort(std::vector<uint64_t>* keys, std::vector<uint64_t>* scratch) {
+	if (keys->size() < 2) {
+		return;
+	}
+	scratch->resize(keys->size());
+
+	// Histograms of every digit in a single pass
+	std::array<std::array<uint32_t, 256>, sizeof(uint64_t)> counts = {};
+	for (uint64_t key : *keys) {
+		for (uint32_t digit = 0; digit < sizeof(uint64_t); digit++) {
+			counts[digit][(key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	for (uint32_t digit = 0; digit < sizeof(uint64_t); digit++) {
+		std::array<uint32_t, 256>& digitCounts = counts[digit];
+		if (digitCounts[(keys->front() >> (digit * 8)) & 0xFF] == keys->size()) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t& count : digitCounts) {
+			uint32_t bucketCount = count;
+			count = offset;
+			offset += bucketCount;
+		}
+
+		for (uint64_t key : *keys) {
+			(*scratch)[digitCounts[(key >> (digit * 8)) & 0xFF]++] = key;
+		}
+		keys->swap(*scratch);
+	}
+}
\ No newline at end of file
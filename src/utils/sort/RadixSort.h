@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct RadixSort {
+	// Byte digits, least significant first, the digits shared by every key are skipped
+	static void sort(std::vector<uint64_t>* keys, std::vector<uint64_t>* scratch);
+};
\ No newline at end of file
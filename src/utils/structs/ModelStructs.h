@@ -1,18 +1,21 @@
 #pragma once
 #include "vulkan/vulkan.hpp"
 #include "../../external/glm/glm/glm.hpp"
+#include "../../graphics/culling/Bounds.h"
 #include "../../graphics/pipelines/DescriptorSet.h"
 #include "../../graphics/pipelines/GraphicsPipeline.h"
 #include "../../graphics/resources/Buffer.h"
 #include <vector>
 #include <unordered_map>
 
-// Model primitive
+// Model primitive, bounds are in model space
 struct Primitive {
 	uint32_t firstIndex;
 	uint32_t indexCount;
 	int32_t vertexOffset;
 	uint64_t materialIndex;
+	AABB aabb;
+	BoundingSphere boundingSphere;
 };
 
 // Mesh bone
@@ -22,11 +25,13 @@ struct Bone {
 	std::vector<Bone> children;
 };
 
-// Model mesh
+// Model mesh, bounds are in model space and enclose every primitive
 struct Mesh {
 	uint32_t indexOffset;
 	int32_t vertexOffset;
 	std::vector<Primitive> primitives;
+	AABB aabb;
+	BoundingSphere boundingSphere;
 	Bone skeleton;
 	std::vector<Bone> boneList;
 	std::vector<Buffer> boneBuffers;
@@ -5,8 +5,18 @@
 
 #define MAX_FRAMES_IN_FLIGHT 2
 
-#define SHADOWMAP_WIDTH 2048
-#define SHADOWMAP_HEIGHT 2048
+// Shadow atlas, every shadowed light gets a power of two tile sized from its screen coverage
+#define SHADOW_ATLAS_MAX_SIZE 4096
+#define SHADOW_TILE_MAX_SIZE 2048
+#define SHADOW_TILE_MIN_SIZE 256
+
+// Shadow cascades, split between uniform and logarithmic slices up to a distance, casters smaller than a few texels of a cascade are not drawn in it
+#define SHADOW_CASCADE_DISTANCE 100.0f
+#define SHADOW_CASCADE_SPLIT_LAMBDA 0.75f
+#define SHADOW_CASCADE_MIN_CASTER_TEXELS 4.0f
+
+// Moving instances are dynamic shadow casters until they stayed still for this many frames, skinned ones always are
+#define SHADOW_DYNAMIC_SETTLE_FRAMES 30
 
 #define ENVMAP_WIDTH 2048
 #define ENVMAP_HEIGHT 2048
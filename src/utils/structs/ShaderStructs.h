@@ -5,11 +5,20 @@
 #include "../../external/glm/glm/glm.hpp"
 #include "../NeigeDefines.h"
 
-#define MAX_DIR_LIGHTS 10
-#define MAX_POINT_LIGHTS 10
-#define MAX_SPOT_LIGHTS 10
+#define MAX_SHADOW_MAPS 16
 #define MAX_BONES 256
 
+// Directional lights cast shadows through one shadow map per slice of the camera frustum
+#define SHADOW_CASCADE_COUNT 4
+
+// Light clusters, view-space froxels with exponential depth slices
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+// Point and spot lights reach the distance where their intensity falls under the cutoff, which is also the far plane of spot shadow maps
+#define LIGHT_INTENSITY_CUTOFF 0.01f
+
 enum struct ShaderType {
 	VERTEX,
 	FRAGMENT,
@@ -139,7 +148,7 @@ struct Vertex {
 				weightsAttribute.offset = offsetof(Vertex, weights);
 				inputAttributeDescriptions.push_back(weightsAttribute);
 			}
-			else if (inputVariables[i].name != "gl_VertexIndex") {
+			else if (inputVariables[i].name != "gl_VertexIndex" && inputVariables[i].name != "gl_InstanceIndex") {
 				NEIGE_WARNING("Vertex shader input variable \"" + inputVariables[i].name + "\" at location " + std::to_string(inputVariables[i].location) + " is undefined.");
 			}
 		}
@@ -148,8 +157,8 @@ struct Vertex {
 	}
 };
 
-// Object Uniform Buffer Object
-struct ObjectUniformBufferObject {
+// Object Storage Buffer Object, one per instance
+struct ObjectStorageBufferObject {
 	glm::mat4 model;
 };
 
@@ -160,24 +169,52 @@ struct CameraUniformBufferObject {
 	glm::vec3 position;
 };
 
+// Light Storage Buffer Object, directional lights first
+struct LightStorageBufferObject {
+	// xyz : position, w : range
+	glm::vec4 position;
+	// xyz : direction, w : type
+	glm::vec4 direction;
+	// xyz : color, w : shadow map index, -1 without shadow
+	glm::vec4 color;
+	// x : inner cutoff cosine, y : outer cutoff cosine
+	glm::vec4 cutoffs;
+};
+
+// Cluster Storage Buffer Object, indices of the lights touching a cluster
+struct ClusterStorageBufferObject {
+	uint32_t lightCount;
+	uint32_t lightIndices[MAX_LIGHTS_PER_CLUSTER];
+};
+
 // Lights Uniform Buffer Object
 struct LightingUniformBufferObject {
-	glm::vec4 numLights;
-	glm::vec4 dirLightsDirection[MAX_DIR_LIGHTS];
-	glm::vec4 dirLightsColor[MAX_DIR_LIGHTS];
-	glm::vec4 pointLightsPosition[MAX_POINT_LIGHTS];
-	glm::vec4 pointLightsColor[MAX_POINT_LIGHTS];
-	glm::vec4 spotLightsPosition[MAX_SPOT_LIGHTS];
-	glm::vec4 spotLightsDirection[MAX_SPOT_LIGHTS];
-	glm::vec4 spotLightsColor[MAX_SPOT_LIGHTS];
-	glm::vec4 spotLightsCutoffs[MAX_SPOT_LIGHTS];
+	glm::mat4 view;
+	glm::mat4 inverseProjection;
+	// x : near, y : far, z : slice scale, w : slice bias
+	glm::vec4 clusterDepth;
+	glm::vec4 screenSize;
+	// x : directional lights, y : all lights
+	glm::uvec4 lightCounts;
 };
 
 // Shadow Uniform Buffer Object
 struct ShadowUniformBufferObject {
-	glm::vec4 numLights;
-	glm::mat4 dirLightSpaces[MAX_DIR_LIGHTS];
-	glm::mat4 spotLightSpaces[MAX_SPOT_LIGHTS];
+	glm::mat4 lightSpaces[MAX_SHADOW_MAPS];
+	// xy : offset, zw : size, of the tile in the atlas
+	glm::vec4 atlasRects[MAX_SHADOW_MAPS];
+	// View depth where each cascade ends
+	glm::vec4 cascadeSplits;
+};
+
+// SSAO Uniform Buffer Object
+struct SSAOUniformBufferObject {
+	glm::mat4 projection;
+	glm::mat4 inverseProjection;
+	// From the view space of this frame to the clip space of the previous one
+	glm::mat4 reprojection;
+	// x : history weight, y : frame index
+	glm::vec4 temporal;
 };
 
 // Bone Uniform Buffer Object
@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+void ThreadPool::init(uint32_t threadCount) {
+	stopping = false;
+	for (uint32_t i = 0; i < threadCount; i++) {
+		threads.push_back(std::thread(&ThreadPool::work, this));
+	}
+}
+
+void ThreadPool::destroy() {
+	{
+		std::unique_lock<std::mutex> lock(tasksMutex);
+		stopping = true;
+	}
+	tasksCondition.notify_all();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+	tasks.clear();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	{
+		std::unique_lock<std::mutex> lock(tasksMutex);
+		tasks.push_back(std::move(task));
+	}
+	tasksCondition.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+	std::function<void()> task;
+	{
+		std::unique_lock<std::mutex> lock(tasksMutex);
+		if (tasks.empty()) {
+			return false;
+		}
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	task();
+
+	return true;
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& function) {
+	if (threads.empty() || count <= 1) {
+		for (uint32_t i = 0; i < count; i++) {
+			function(i);
+		}
+
+		return;
+	}
+
+	// Helpers may start after the loop is over, the state they share must outlive this call
+	struct ParallelForState {
+		std::atomic<uint32_t> next{ 0 };
+		std::atomic<uint32_t> done{ 0 };
+	};
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+
+	auto runIterations = [state, count, &function]() {
+		uint32_t i;
+		while ((i = state->next.fetch_add(1)) < count) {
+			function(i);
+			state->done.fetch_add(1);
+		}
+	};
+
+	uint32_t helperCount = std::min(static_cast<uint32_t>(threads.size()), count - 1);
+	for (uint32_t i = 0; i < helperCount; i++) {
+		submit(runIterations);
+	}
+	runIterations();
+
+	// Run other tasks while waiting so that nested parallel loops cannot deadlock
+	while (state->done.load() < count) {
+		if (!runPendingTask()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(tasksMutex);
+			tasksCondition.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (stopping) {
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "../NeigeLogging.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPool {
+	std::vector<std::thread> threads;
+	std::deque<std::function<void()>> tasks;
+	std::mutex tasksMutex;
+	std::condition_variable tasksCondition;
+	bool stopping = false;
+
+	void init(uint32_t threadCount);
+	void destroy();
+	void submit(std::function<void()> task);
+	bool runPendingTask();
+	void parallelFor(uint32_t count, const std::function<void(uint32_t)>& function);
+	void work();
+};